@@ -0,0 +1,150 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2017 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+//
+// hermes-emulator
+//
+// Runs a HermesEmulator on the loopback so hermesNB / hermesWB flowgraphs
+// (Interface "lo") can be run without radio hardware.
+//
+// Usage:  hermes-emulator [-a address] [-p port] [-m mac] [-t freq[,dBFS]]...
+//                         [-w vectors/s] [-d seconds] [-c ppm] [-v]
+//                         [-L loss] [-B rate,length] [-R rate,depth] [-D dup]
+//                         [-C corrupt] [-J jitter_us] [-s seed]
+//
+//   -t  add an RF carrier at freq Hz (default level -20 dBFS). Up to 8.
+//       With no -t, one carrier at 10.000 MHz.
+//   -d  run for this many seconds, then print statistics and exit.
+//       Default: until interrupted.
+//   -c  run the sample clock this many ppm fast (negative: slow).
+//
+// Fault injection on the Rx stream, rates are per frame (0..1):
+//   -L  random loss          -B  loss bursts of length frames
+//   -R  reorder, held back depth frames
+//   -D  duplicates           -C  corrupted sync byte
+//   -J  send jitter, uniform 0..jitter_us
+//   -s  generator seed (default 1). Same seed, same faults.
+//
+// Version:  October 2026
+//
+
+#include "HermesEmulator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include <string.h>
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int)
+{
+	stop_requested = 1;
+}
+
+static void usage()
+{
+	fprintf(stderr, "usage: hermes-emulator [-a address] [-p port] [-m mac] [-t freq[,dBFS]]...\n"
+			"                       [-w vectors/s] [-d seconds] [-c ppm] [-v]\n");
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	const char* address = EMULATOR_ADDRESS;
+	const char* mac = "00:1C:C0:A2:22:5E";
+	int port = 1024;
+	int vectorrate = 4;
+	double duration = 0.0;
+	double ppm = 0.0;
+	int verbose = 0;
+	double freq[EMULATOR_MAXCARRIERS], level[EMULATOR_MAXCARRIERS];
+	int ncarriers = 0;
+	int opt;
+
+	EmulatorFaults faults;
+	memset(&faults, 0, sizeof(faults));
+	faults.BurstLength = 8;
+	faults.ReorderDepth = 1;
+	faults.Seed = 1;
+
+	while ((opt = getopt(argc, argv, "a:p:m:t:w:d:c:vL:B:R:D:C:J:s:")) != -1)
+	{
+	  switch (opt)
+	  {
+	    case 'a': address = optarg; break;
+	    case 'p': port = atoi(optarg); break;
+	    case 'm': mac = optarg; break;
+	    case 'w': vectorrate = atoi(optarg); break;
+	    case 'd': duration = atof(optarg); break;
+	    case 'c': ppm = atof(optarg); break;
+	    case 'v': verbose = 1; break;
+	    case 'L': faults.LossRate = atof(optarg); break;
+	    case 'B': sscanf(optarg, "%lf,%d", &faults.BurstRate, &faults.BurstLength); break;
+	    case 'R': sscanf(optarg, "%lf,%d", &faults.ReorderRate, &faults.ReorderDepth); break;
+	    case 'D': faults.DuplicateRate = atof(optarg); break;
+	    case 'C': faults.CorruptRate = atof(optarg); break;
+	    case 'J': faults.JitterMax = atof(optarg) * 1e-6; break;
+	    case 's': faults.Seed = strtoull(optarg, NULL, 0); break;
+	    case 't':
+	      if (ncarriers == EMULATOR_MAXCARRIERS)
+	        usage();
+	      level[ncarriers] = -20.0;
+	      if (sscanf(optarg, "%lf,%lf", &freq[ncarriers], &level[ncarriers]) < 1)
+	        usage();
+	      ncarriers++;
+	      break;
+	    default:
+	      usage();
+	  }
+	}
+	if (vectorrate < 1)
+	  usage();
+
+	HermesEmulator emu(address, port, mac);
+	emu.WBVectorRate = vectorrate;
+	emu.ClockPpm = ppm;
+	emu.Verbose = verbose;
+	emu.Faults = faults;
+
+	if (ncarriers == 0)
+	  emu.AddCarrier(10.0e6, -20.0);
+	for (int i=0; i<ncarriers; i++)
+	  emu.AddCarrier(freq[i], level[i]);
+
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+
+	if (!emu.Start())
+	  return 1;
+
+	fprintf(stderr, "hermes-emulator: %s:%d MAC %s\n", address, emu.Port(), mac);
+
+	double elapsed = 0.0;
+	while (!stop_requested && (duration <= 0.0 || elapsed < duration))
+	{
+	  usleep(100000);
+	  elapsed += 0.1;
+	}
+
+	emu.Stop();
+	emu.PrintStats(stderr);
+	return 0;
+}
@@ -0,0 +1,257 @@
+#!/usr/bin/env python
+#
+# Copyright 2026 Tom McDermott, N5EG
+#
+# This is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3, or (at your option)
+# any later version.
+#
+# This software is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this software; see the file COPYING.  If not, write to
+# the Free Software Foundation, Inc., 51 Franklin Street,
+# Boston, MA 02110-1301, USA.
+#
+
+"""
+hpsdr_throughput - end to end flowgraph capacity test over the loopback.
+
+Runs hermesNB (and optionally hermesWB) with null sinks against a local
+hermes-emulator, sweeping the number of receivers and the sample rate.
+For each configuration it reports the sustained samples/s, CPU use per
+thread, LostRxBufCount, LostEthernetRx and Tx underruns (LostTxBufCount),
+then the largest configuration this host sustains without loss.
+
+Each configuration runs in a fresh child process with a fresh emulator,
+because the proxies and metis.cc keep global state.
+
+    hpsdr_throughput.py --receivers 1,2,4,8 --rates 48000,192000,384000
+    hpsdr_throughput.py --wb --duration 20 --json results.json
+    hpsdr_throughput.py --emulator-args "-L 0.001 -J 200"
+
+Version:  October 2026
+"""
+
+from __future__ import print_function
+
+import json
+import os
+import re
+import signal
+import subprocess
+import sys
+import time
+from optparse import OptionParser
+
+CHILD_FLAG = "--child"
+
+
+# ---------------------------------------------------------------- child
+
+def thread_cpu():
+    """{tid: (name, cpu seconds)} for every thread of this process."""
+    ticks = float(os.sysconf("SC_CLK_TCK"))
+    result = {}
+    for tid in os.listdir("/proc/self/task"):
+        try:
+            with open("/proc/self/task/%s/comm" % tid) as f:
+                name = f.read().strip()
+            with open("/proc/self/task/%s/stat" % tid) as f:
+                fields = f.read().rsplit(")", 1)[1].split()
+            result[tid] = (name, (int(fields[11]) + int(fields[12])) / ticks)
+        except (IOError, OSError):
+            pass                    # thread exited while we looked
+    return result
+
+
+def run_child(nrx, rate, duration, wb):
+    """Run one configuration, print one JSON line on stdout."""
+    from gnuradio import gr, blocks
+    import hpsdr
+
+    tb = gr.top_block()
+    nb = hpsdr.hermesNB(7074000, 7074000, 7074000, 7074000, 7074000,
+                        7074000, 7074000, 7074000, 7074000, 0,
+                        0, 0, 0, 0, rate, "lo", "0xF8", 0, 0, 0x20, 0x10,
+                        0, nrx, "*")
+    tb.connect(blocks.null_source(gr.sizeof_gr_complex), nb)
+    sinks = []
+    for rx in range(nrx):
+        sink = blocks.null_sink(gr.sizeof_gr_complex)
+        tb.connect((nb, rx), sink)
+        sinks.append(sink)
+
+    wbsink = None
+    if wb:
+        w = hpsdr.hermesWB(0, "lo", "0xF8", 0, 0, 0x20, 0x10, "*")
+        wbsink = blocks.null_sink(16384 * 4)
+        tb.connect(w, wbsink)
+
+    tb.start()
+    time.sleep(1.0)                 # let discovery and the Tx burst settle
+
+    cpu0 = thread_cpu()
+    items0 = [s.nitems_read(0) for s in sinks]
+    vec0 = wbsink.nitems_read(0) if wbsink else 0
+    t0 = time.time()
+
+    time.sleep(duration)
+
+    t1 = time.time()
+    items1 = [s.nitems_read(0) for s in sinks]
+    vec1 = wbsink.nitems_read(0) if wbsink else 0
+    cpu1 = thread_cpu()
+    latency = [nb.get_latency(hpsdr.LATENCY_ARRIVAL_TO_WORK, p) for p in (50.0, 99.0)]
+
+    tb.stop()
+    tb.wait()
+    st = nb.get_stats()             # final counters, kept after stop()
+
+    elapsed = t1 - t0
+    threads = []
+    for tid, (name, secs) in cpu1.items():
+        used = secs - cpu0.get(tid, (name, 0.0))[1]
+        if used / elapsed >= 0.01:
+            threads.append({"thread": name, "cpu": used / elapsed})
+    threads.sort(key=lambda t: -t["cpu"])
+
+    result = {
+        "samples_per_s": sum(b - a for a, b in zip(items0, items1)) / elapsed,
+        "wb_vectors_per_s": (vec1 - vec0) / elapsed,
+        "threads": threads,
+        "LostRxBufCount": st.lost_rx_buf,
+        "TotalRxBufCount": st.total_rx_buf,
+        "LostTxBufCount": st.lost_tx_buf,
+        "TotalTxBufCount": st.total_tx_buf,
+        "CorruptRxCount": st.corrupt_rx,
+        "LostEthernetRx": st.lost_ethernet_rx,
+        "RxRingHighWater": st.rx_ring_high_water,
+        "latency_p50_us": latency[0],
+        "latency_p99_us": latency[1],
+        "rx_jitter_us": st.rx_jitter_us,
+        "clock_drift_ppm": st.clock_drift_ppm,
+    }
+    if wb:
+        wst = w.get_stats()
+        result.update({"WBVectorsComplete": wst.wb_vectors_complete,
+                       "WBVectorsDropped": wst.wb_vectors_dropped,
+                       "WBLostRxBufCount": wst.lost_rx_buf})
+    sys.stdout.write(json.dumps(result) + "\n")
+    sys.stdout.flush()
+
+
+# ---------------------------------------------------------------- parent
+
+def counters(text, names):
+    """Pull 'Name = value' counters out of the emulator's stderr."""
+    found = {}
+    for name in names:
+        m = re.findall(r"\b%s = ([0-9.]+)" % name, text)
+        if m:
+            found[name] = float(m[-1]) if "." in m[-1] else int(m[-1])
+    return found
+
+
+def run_config(options, nrx, rate):
+    emu = subprocess.Popen([options.emulator] + options.emulator_args.split(),
+                           stderr=subprocess.PIPE, universal_newlines=True)
+    time.sleep(0.3)                 # emulator bound before discovery
+    if emu.poll() is not None:
+        sys.exit("hpsdr_throughput: %s did not start:\n%s"
+                 % (options.emulator, emu.stderr.read()))
+
+    cmd = [sys.executable, os.path.abspath(__file__), CHILD_FLAG,
+           str(nrx), str(rate), str(options.duration), "1" if options.wb else "0"]
+    child = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                             universal_newlines=True)
+    try:
+        out, err = child.communicate()
+    finally:
+        emu.send_signal(signal.SIGINT)
+        emu_err = emu.communicate()[1]
+
+    result = {"receivers": nrx, "rate": rate, "nominal": nrx * rate}
+    lines = [l for l in out.splitlines() if l.startswith("{")]
+    if child.returncode != 0 or not lines:
+        result["error"] = err.strip().splitlines()[-1:] or ["exit %d" % child.returncode]
+        return result
+
+    result.update(json.loads(lines[-1]))
+    result.update(counters(emu_err, ["EP6Sent", "LateFrames", "EP2RateRatio",
+                                     "EP2LateCount", "FaultDropped"]))
+
+    # Sustained: at least 99% of the nominal rate, and nothing dropped on
+    # the host side (the ring, or frames missing from the sequence beyond
+    # those the emulator dropped on purpose).
+    lost_eth = result.get("LostEthernetRx", 0) - result.get("FaultDropped", 0)
+    result["sustained"] = (result["samples_per_s"] >= 0.99 * result["nominal"]
+                           and result.get("LostRxBufCount", 0) == 0
+                           and lost_eth <= 0)
+    return result
+
+
+def print_result(r):
+    if "error" in r:
+        print("%2d rx %6d  FAILED: %s" % (r["receivers"], r["rate"], " ".join(r["error"])))
+        return
+    print("%2d rx %6d  %10.0f S/s (%5.1f%%)  LostRxBuf %6d  LostEth %6d  TxUnderrun %6d  %s"
+          % (r["receivers"], r["rate"], r["samples_per_s"],
+             100.0 * r["samples_per_s"] / r["nominal"],
+             r.get("LostRxBufCount", -1), r.get("LostEthernetRx", -1),
+             r.get("LostTxBufCount", -1), "ok" if r["sustained"] else "NOT SUSTAINED"))
+    print("        latency recvfrom to work p50 %.0f us  p99 %.0f us  jitter %.0f us  clock %+.1f ppm"
+          % (r["latency_p50_us"], r["latency_p99_us"], r["rx_jitter_us"], r["clock_drift_ppm"]))
+    for t in r["threads"]:
+        print("        %-16s %5.1f%% cpu" % (t["thread"], 100.0 * t["cpu"]))
+
+
+def main():
+    if len(sys.argv) > 1 and sys.argv[1] == CHILD_FLAG:
+        nrx, rate, duration, wb = sys.argv[2:6]
+        run_child(int(nrx), int(rate), float(duration), wb == "1")
+        return
+
+    parser = OptionParser(usage="%prog [options]")
+    parser.add_option("--receivers", default="1,2,3,4,5,6,7,8",
+                      help="receiver counts to sweep [default=%default]")
+    parser.add_option("--rates", default="48000,96000,192000,384000",
+                      help="sample rates to sweep [default=%default]")
+    parser.add_option("--duration", type="float", default=10.0,
+                      help="seconds measured per configuration [default=%default]")
+    parser.add_option("--wb", action="store_true", default=False,
+                      help="also run hermesWB")
+    parser.add_option("--emulator", default="hermes-emulator",
+                      help="emulator executable [default=%default]")
+    parser.add_option("--emulator-args", default="",
+                      help="extra hermes-emulator arguments, e.g. faults")
+    parser.add_option("--json", default=None,
+                      help="also write all results to this file")
+    (options, args) = parser.parse_args()
+
+    results = []
+    for nrx in [int(x) for x in options.receivers.split(",")]:
+        for rate in [int(x) for x in options.rates.split(",")]:
+            r = run_config(options, nrx, rate)
+            print_result(r)
+            results.append(r)
+
+    ok = [r for r in results if r.get("sustained")]
+    if ok:
+        best = max(ok, key=lambda r: (r["nominal"], r["receivers"]))
+        print("\nLargest sustained configuration: %d receivers at %d S/s (%d S/s total)"
+              % (best["receivers"], best["rate"], best["nominal"]))
+    else:
+        print("\nNo configuration was sustained")
+
+    if options.json:
+        with open(options.json, "w") as f:
+            json.dump({"host": os.uname()[1], "results": results}, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,29 @@
+INCLUDE(FindPkgConfig)
+PKG_CHECK_MODULES(PC_LIBURING liburing)
+
+FIND_PATH(
+    LIBURING_INCLUDE_DIRS
+    NAMES liburing.h
+    HINTS $ENV{LIBURING_DIR}/include
+          ${PC_LIBURING_INCLUDEDIR}
+          ${CMAKE_INSTALL_PREFIX}/include
+    PATHS /usr/local/include
+          /usr/include
+)
+
+FIND_LIBRARY(
+    LIBURING_LIBRARIES
+    NAMES uring
+    HINTS $ENV{LIBURING_DIR}/lib
+          ${PC_LIBURING_LIBDIR}
+          ${CMAKE_INSTALL_PREFIX}/lib
+          ${CMAKE_INSTALL_PREFIX}/lib64
+    PATHS /usr/local/lib
+          /usr/local/lib64
+          /usr/lib
+          /usr/lib64
+)
+
+INCLUDE(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(LIBURING DEFAULT_MSG LIBURING_LIBRARIES LIBURING_INCLUDE_DIRS)
+MARK_AS_ADVANCED(LIBURING_LIBRARIES LIBURING_INCLUDE_DIRS)
@@ -23,6 +23,7 @@
 #define INCLUDED_HPSDR_HERMESNB_H
 
 #include <hpsdr/api.h>
+#include <hpsdr/hermes_stats.h>
 #include <gnuradio/block.h>
 
 namespace gr {
@@ -53,7 +54,14 @@ namespace gr {
 			 unsigned char TxDr, int RxSmp, const char* Intfc, 
 			 const char * ClkS, int AlexRA, int AlexTA,
 			 int AlexHPF, int AlexLPF, int Verbose, int NumRx,
-			 const char* MACAddr);
+			 const char* MACAddr, float StatsPeriod = 1.0,
+			 int IOBackend = 0, int BusyPollUs = 0, int RxCore = -1,
+			 const char* RecordFile = "", const char* ReplayFile = "",
+			 float ReplaySpeed = 1.0, float ReplayStart = 0,
+			 const char* SigMFFile = "", int SigMFFormat = 0,
+			 int OutputType = 0, int SC16Shift = 8, int SC16Round = 1,
+			 float LevelPeriod = 0, int DCRemove = 0,
+			 const char* Decimation = "");
 
       void set_Receive0Frequency(float);	// callback
       void set_Receive1Frequency(float);	// callback
@@ -84,6 +92,17 @@ namespace gr {
 //
       void set_Verbose(int);			// callback
 
+      hermes_stats get_stats();		// live proxy counters, final values after stop()
+      double get_latency(int stage, double percentile);	// microseconds, stage is a hermes_latency_stage
+      void reset_latency();			// clear the latency histograms
+
+      hermes_telemetry get_telemetry();	// decoded status registers, final values after stop()
+      double get_forward_power();		// watts, Alex forward power
+      double get_reverse_power();		// watts, Alex reverse power
+      double get_swr();				// 0 with no forward power
+
+      hermes_level get_level(int rx);		// last level window of receiver rx, final values after stop()
+
       bool stop();				// override
       bool start();				// override
 
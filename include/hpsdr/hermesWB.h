@@ -23,6 +23,7 @@
 #define INCLUDED_HPSDR_HERMESWB_H
 
 #include <hpsdr/api.h>
+#include <hpsdr/hermes_stats.h>
 #include <gnuradio/block.h>
 
 namespace gr {
@@ -48,7 +49,12 @@ namespace gr {
        */
       static sptr make(int RxPre, const char* Intfc, const char * ClkS,
 			int AlexRA, int AlexTA, int AlexHPF, int AlexLPF,
-			const char* MACAddr);
+			const char* MACAddr, int GapPolicy = 0,
+			int FFTSize = 0, int FFTOverlap = 50, int FFTAverage = 1,
+			float StatsPeriod = 1.0, int IOBackend = 0,
+			int BusyPollUs = 0, int RxCore = -1, const char* RecordFile = "",
+			const char* ReplayFile = "", float ReplaySpeed = 1.0,
+			float ReplayStart = 0, int OutputType = 0);
 
       void set_RxPreamp(int);			// callback
       void set_ClockSource(const char *);	// callback
@@ -56,6 +62,11 @@ namespace gr {
       void set_AlexTxAntenna(int);		// callback
       void set_AlexRxHPF(int);			// callback
       void set_AlexTxLPF(int);			// callback
+      void set_GapPolicy(int);			// callback, 0 = drop, 1 = zero-fill and tag
+
+      hermes_stats get_stats();		// live proxy counters, final values after stop()
+      double get_latency(int stage, double percentile);	// microseconds, stage is a hermes_latency_stage
+      void reset_latency();			// clear the latency histograms
 
       bool stop();				// override
       bool start();				// override
@@ -0,0 +1,139 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Thomas C. McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_HPSDR_HERMES_STATS_H
+#define INCLUDED_HPSDR_HERMES_STATS_H
+
+#include <hpsdr/api.h>
+
+namespace gr {
+  namespace hpsdr {
+
+    /*!
+     * \brief Snapshot of the Hermes proxy counters
+     * \ingroup hpsdr
+     *
+     * Returned by hermesNB::get_stats() and hermesWB::get_stats(). The
+     * counters run from the start of the flowgraph and are read while the
+     * receive thread is updating them, so each one is current but they
+     * are not sampled at exactly the same instant.
+     */
+    struct HPSDR_API hermes_stats
+    {
+      unsigned long lost_rx_buf;	//!< Rx buffers thrown away because the ring was full
+      unsigned long total_rx_buf;	//!< Rx buffers received from Hermes
+      unsigned long lost_tx_buf;	//!< Tx frame times with no Tx data ready (underruns)
+      unsigned long total_tx_buf;	//!< Tx frame times
+      unsigned long corrupt_rx;		//!< Rx frames with bad sync bytes
+      unsigned long lost_ethernet_rx;	//!< Rx frames missing from the Ethernet sequence
+
+      unsigned rx_ring_size;		//!< Rx ring slots
+      unsigned rx_ring_fill;		//!< Rx ring slots waiting for the work thread
+      unsigned rx_ring_high_water;	//!< largest rx_ring_fill seen
+      unsigned tx_queue_size;		//!< Tx queue buffers (USB frames)
+      unsigned tx_queue_fill;		//!< Tx buffers waiting to be sent
+
+      unsigned long wb_vectors_complete;	//!< hermesWB: vectors with all 32 frames
+      unsigned long wb_vectors_filled;	//!< hermesWB: incomplete vectors zero-filled
+      unsigned long wb_vectors_dropped;	//!< hermesWB: incomplete vectors thrown away
+      unsigned long wb_late_frames;	//!< hermesWB: frames too late for their vector
+
+      double rx_jitter_us;		//!< RFC 3550 inter-arrival jitter, EP6 (NB) or EP4 (WB)
+      double rx_interval_mean_us;	//!< mean inter-arrival time per frame
+      double rx_interval_std_us;	//!< its standard deviation
+      double rx_interval_max_us;	//!< longest inter-arrival time
+      double clock_drift_ppm;		//!< hermesNB: radio sample clock against the host clock
+      double effective_sample_rate;	//!< hermesNB: the sample rate as the host sees it, 0 until measured
+      int kernel_timestamps;		//!< 1 if arrival times are SO_TIMESTAMPNS kernel time stamps
+      int io_backend;			//!< network I/O in use: 0 sockets, 1 io_uring, 2 AF_XDP, 3 replay
+      unsigned long busy_poll_hits;	//!< BusyPollUs: frames found while spinning
+      unsigned long busy_poll_misses;	//!< BusyPollUs: spins that ran out and blocked
+      double busy_poll_hit_ratio;	//!< hits / (hits + misses), 0 with busy poll off
+      unsigned long record_frames;	//!< RecordFile: frames written to the capture file
+      unsigned long record_dropped;	//!< RecordFile: frames lost, writer behind or disk full
+    };
+
+    /*!
+     * \brief Hermes status registers, decoded
+     * \ingroup hpsdr
+     *
+     * Returned by hermesNB::get_telemetry(). The receive thread only
+     * latches the raw C1..C4 bytes of status banks 0x00, 0x08, 0x10 and
+     * 0x18; the telemetry thread decodes them about once a second, so the
+     * values lag the radio by up to that long. The power figures use the
+     * Alex bridge scaling, AIN squared over 145000.
+     */
+    struct HPSDR_API hermes_telemetry
+    {
+      int valid;			//!< 1 once a status frame has been received
+      int adc_overload;			//!< ADC overload bit of the last bank 0x00 frame
+      unsigned long adc_overload_frames;	//!< frames with the overload bit set
+      int hermes_version;		//!< FPGA code version
+      unsigned ain1;			//!< Alex/Apollo forward power
+      unsigned ain2;			//!< Alex/Apollo reverse power
+      unsigned ain3;			//!< Penelope/Hermes AIN3
+      unsigned ain4;			//!< Penelope/Hermes AIN4
+      unsigned ain5;			//!< exciter power
+      unsigned ain6;			//!< Hermes 13.8 V supply
+      double forward_power;		//!< watts, from ain1
+      double reverse_power;		//!< watts, from ain2
+      double swr;			//!< 0 with no forward power, 99.9 if not computable
+    };
+
+    /*!
+     * \brief Signal level of one hermesNB receiver
+     * \ingroup hpsdr
+     *
+     * Returned by hermesNB::get_level() and sent on its "level" port.
+     * The receive thread measures it while it unpacks the samples, over
+     * windows of LevelPeriod seconds; the figures are those of the last
+     * complete window. Full scale is a complex tone of amplitude 1.0
+     * (2^23 - 1 in the 24 bit samples).
+     */
+    struct HPSDR_API hermes_level
+    {
+      unsigned long windows;		//!< windows measured, 0 until the first one ends
+      unsigned long samples;		//!< samples in the last window
+      double power_dbfs;		//!< mean I^2 + Q^2 of the outputs, dBFS
+      double peak_dbfs;			//!< largest I^2 + Q^2 of the outputs, dBFS
+      double dc_i;			//!< mean I of the input, fraction of full scale
+      double dc_q;			//!< mean Q of the input, fraction of full scale
+    };
+
+    /*!
+     * \brief Stages of the receive path timed by get_latency()
+     * \ingroup hpsdr
+     *
+     * A ring slot is stamped when its Ethernet frame leaves recvfrom() in
+     * the metis receive thread (for hermesWB, the first frame of the
+     * vector), and again when the proxy commits it to the ring.
+     */
+    enum hermes_latency_stage {
+      LATENCY_SOCKET_TO_UNPACK = 0,	//!< recvfrom() returns -> proxy starts unpacking
+      LATENCY_UNPACK_TO_COMMIT,		//!< proxy starts unpacking -> slot committed to the ring
+      LATENCY_COMMIT_TO_WORK,		//!< slot committed -> emitted by general_work()
+      LATENCY_ARRIVAL_TO_WORK,		//!< recvfrom() returns -> emitted by general_work()
+      LATENCY_STAGES
+    };
+
+  } // namespace hpsdr
+} // namespace gr
+
+#endif /* INCLUDED_HPSDR_HERMES_STATS_H */
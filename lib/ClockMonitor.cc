@@ -0,0 +1,126 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// ClockMonitor.cc
+//
+// Version:  October 2026
+
+#include "ClockMonitor.h"
+#include <math.h>
+
+
+ClockMonitor::ClockMonitor()
+{
+	Restart(0.0);
+};
+
+void ClockMonitor::Restart(double FramePeriod)
+{
+	Period = FramePeriod;
+	Started = false;
+	Settled = false;
+	LastSeq = 0;
+	FirstNs = LastNs = 0;
+	Frame = 0.0;
+
+	FitN = FitMeanX = FitMeanY = FitCxx = FitCxy = 0.0;
+	IntN = IntMean = IntM2 = 0.0;
+	Jit = 0.0;
+
+	JitterOut.store(0.0, std::memory_order_relaxed);
+	MeanOut.store(0.0, std::memory_order_relaxed);
+	StdOut.store(0.0, std::memory_order_relaxed);
+	MaxOut.store(0.0, std::memory_order_relaxed);
+	PpmOut.store(0.0, std::memory_order_relaxed);
+	PpmValid.store(false, std::memory_order_relaxed);
+};
+
+void ClockMonitor::Add(unsigned Seq, uint64_t ArrivalNs)
+{
+	if (!Started)
+	{
+	  Started = true;
+	  LastSeq = Seq;
+	  FirstNs = LastNs = ArrivalNs;
+	  return;
+	}
+
+	int step = (int)(Seq - LastSeq);
+	double dt = (double)(int64_t)(ArrivalNs - LastNs) * 1e-9;
+
+	if (step <= 0 && step > -1000)		// duplicate or reordered, the gap was already seen
+	  return;
+
+	if (step <= 0 || dt < 0.0 || dt > 1.0)	// stream restarted, or stalled
+	{
+	  Restart(Period);
+	  Add(Seq, ArrivalNs);
+	  return;
+	}
+
+	LastSeq = Seq;
+	LastNs = ArrivalNs;
+
+	if (!Settled)
+	{
+	  if ((double)(ArrivalNs - FirstNs) * 1e-9 < CLOCKSETTLESECONDS)
+	    return;
+	  Settled = true;			// measure from this frame
+	  FirstNs = ArrivalNs;
+	}
+	else
+	{
+	  Frame += step;
+
+	  double per = dt / step;		// inter-arrival per frame, Welford
+	  IntN += 1.0;
+	  double d = per - IntMean;
+	  IntMean += d / IntN;
+	  IntM2 += d * (per - IntMean);
+
+	  double expected = ((Period > 0.0) ? Period : IntMean) * step;
+	  Jit += (fabs(dt - expected) - Jit) / 16.0;	// RFC 3550
+
+	  JitterOut.store(Jit, std::memory_order_relaxed);
+	  MeanOut.store(IntMean, std::memory_order_relaxed);
+	  StdOut.store((IntN > 1.0) ? sqrt(IntM2 / (IntN - 1.0)) : 0.0, std::memory_order_relaxed);
+	  if (dt > MaxOut.load(std::memory_order_relaxed))
+	    MaxOut.store(dt, std::memory_order_relaxed);
+	}
+
+	// Least squares fit of arrival time against frame number, in the
+	// running mean / co-moment form so hours of frames lose no precision.
+
+	double x = Frame;
+	double y = (double)(ArrivalNs - FirstNs) * 1e-9;
+	FitN += 1.0;
+	double dx = x - FitMeanX;
+	FitMeanX += dx / FitN;
+	FitMeanY += (y - FitMeanY) / FitN;
+	FitCxx += dx * (x - FitMeanX);
+	FitCxy += dx * (y - FitMeanY);
+
+	if (Period > 0.0 && y >= CLOCKFITSECONDS && FitCxx > 0.0)
+	{
+	  double slope = FitCxy / FitCxx;		// host seconds per radio frame
+	  PpmOut.store((Period / slope - 1.0) * 1e6, std::memory_order_relaxed);
+	  PpmValid.store(true, std::memory_order_relaxed);
+	}
+};
@@ -0,0 +1,98 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// ClockMonitor.h
+//
+// Inter-arrival jitter and sample clock drift for one receive endpoint.
+//
+// Hermes sends EP6 frames at exactly the rate its sample clock produces
+// them, so the arrival times of the frames, plotted against their sequence
+// numbers, are a straight line whose slope is the radio's frame period as
+// measured by the host clock. A least squares fit of that line gives the
+// drift in ppm; network and host scheduling jitter only scatter the points
+// about it. Lost frames leave gaps in the sequence numbers but do not bend
+// the line.
+//
+// Jitter is the RFC 3550 estimator: the smoothed absolute difference
+// between each inter-arrival time and the nominal frame period times the
+// sequence step. For an endpoint without a nominal period (EP4 sends
+// wideband vectors in bursts) the mean inter-arrival time stands in for it
+// and there is no drift estimate.
+//
+// The first CLOCKSETTLESECONDS of frames after a (re)start are skipped:
+// Hermes keeps sending at its old rate until the new control registers
+// reach it.
+//
+// Add() is called by the metis Rx thread only. The results are published
+// through atomics for any thread to read.
+//
+// Version:  October 2026
+
+#include <atomic>
+#include <stdint.h>
+
+#ifndef ClockMonitor_H
+#define ClockMonitor_H
+
+#define CLOCKSETTLESECONDS 1.0		// frames ignored after a (re)start
+#define CLOCKFITSECONDS	2.0		// span of arrivals before the drift is reported
+
+class ClockMonitor
+{
+
+private:
+
+	double Period;			// nominal seconds per frame, 0 if not paced
+	bool Started;			// first frame seen
+	bool Settled;			// CLOCKSETTLESECONDS have passed since
+	unsigned LastSeq;
+	uint64_t FirstNs, LastNs;	// arrival times, ns
+	double Frame;			// frames since the first, following sequence wrap
+
+	double FitN, FitMeanX, FitMeanY, FitCxx, FitCxy;	// running least squares
+	double IntN, IntMean, IntM2;	// running inter-arrival mean and variance
+	double Jit;			// RFC 3550 jitter, seconds
+
+	std::atomic<double> JitterOut;	// seconds
+	std::atomic<double> MeanOut;	// mean inter-arrival per frame, seconds
+	std::atomic<double> StdOut;	// its standard deviation, seconds
+	std::atomic<double> MaxOut;	// longest inter-arrival, seconds
+	std::atomic<double> PpmOut;	// radio clock relative to host clock, ppm
+	std::atomic<bool> PpmValid;
+
+public:
+
+	ClockMonitor();
+
+	void Restart(double FramePeriod);		// forget everything, new nominal period
+	void Add(unsigned Seq, uint64_t ArrivalNs);	// one frame, Rx thread only
+
+	double Jitter()		{ return JitterOut.load(std::memory_order_relaxed); }
+	double MeanInterval()	{ return MeanOut.load(std::memory_order_relaxed); }
+	double StdInterval()	{ return StdOut.load(std::memory_order_relaxed); }
+	double MaxInterval()	{ return MaxOut.load(std::memory_order_relaxed); }
+	bool DriftValid()	{ return PpmValid.load(std::memory_order_relaxed); }
+	double DriftPpm()	{ return PpmOut.load(std::memory_order_relaxed); }
+
+	double FramePeriod()	{ return Period; }
+
+};
+
+#endif  // #ifndef ClockMonitor_H
@@ -0,0 +1,80 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// HermesCapture.h
+//
+// Raw frame capture file, written by HermesRecorder.
+//
+//   offset 0				CaptureHeader, padded to CAPTUREHEADER bytes
+//   CAPTUREHEADER + n * CAPTURERECORD	CaptureRecord n, n = 0 .. Records-1
+//   IndexOffset				IndexEntries CaptureIndex entries
+//
+// Records are fixed size, so record n is found without reading the ones
+// before it. The index holds the wire time of every CAPTUREINDEXEVERY'th
+// record, for seeking by time; it is written when the recording closes.
+// A file whose recording did not close (IndexOffset 0) still reads: its
+// Records count is brought up to date every index interval, and the
+// records past it are valid wherever Length is non zero.
+//
+// All fields are host byte order.
+//
+// Version:  October 2026
+
+#ifndef HermesCapture_H
+#define HermesCapture_H
+
+#include <stdint.h>
+
+#define CAPTUREMAGIC		"HPSDRCAP"
+#define CAPTUREVERSION		1
+#define CAPTUREHEADER		4096	// bytes before the first record
+#define CAPTUREFRAME		1032	// Metis frame: 8 byte header + 2 USB frames
+#define CAPTURERECORD		1056	// sizeof(CaptureRecord)
+#define CAPTUREINDEXEVERY	4096	// records between index entries
+
+struct CaptureHeader
+{
+	char Magic[8];			// CAPTUREMAGIC, no terminator
+	uint32_t Version;		// CAPTUREVERSION
+	uint32_t RecordSize;		// CAPTURERECORD
+	uint64_t Records;		// records written
+	uint64_t IndexOffset;		// file offset of the index, 0 until closed
+	uint64_t IndexEntries;
+	uint64_t StartNs;		// CLOCK_REALTIME when recording started
+	uint64_t Dropped;		// frames lost because the writer fell behind
+	char Interface[32];		// where the frames came from
+};
+
+struct CaptureRecord
+{
+	uint64_t ArrivalNs;		// CLOCK_MONOTONIC when metis received the frame
+	uint64_t WireNs;		// CLOCK_REALTIME arrival, the kernel time stamp if there was one
+	uint32_t Length;		// bytes of Frame used, 0 for an unwritten record
+	uint32_t Reserved;
+	unsigned char Frame[CAPTUREFRAME];	// the Metis frame as received: EF FE 01 EP seq ...
+};
+
+struct CaptureIndex
+{
+	uint64_t WireNs;		// WireNs of Record
+	uint64_t Record;
+};
+
+#endif  // #ifndef HermesCapture_H
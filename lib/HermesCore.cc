@@ -0,0 +1,739 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2017 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+//
+// Hermes Core
+//
+// The parts of the Hermes proxies that do not depend on which stream
+// (EP6 narrowband or EP4 wideband) is being decoded:
+//
+//  * Discovery and selection of the Hermes/Metis board by MAC address.
+//  * Control register encoding (BuildControlRegs) and the initial
+//    register load (UpdateHermes).
+//  * The Tx frame queue and SendTxIQ.
+//  * The Rx buffer ring handed from the metis Rx thread to gnuradio.
+//  * Ethernet sequence number tracking and the diagnostic counters.
+//
+// Previously each of these was duplicated in HermesProxy.cc and
+// HermesProxyW.cc.
+//
+// Version:  October 2026	-- Split out of HermesProxy / HermesProxyW
+//	     October 2026	-- Capture replay (HermesReplay) skips the MAC address match
+//
+
+#include <gnuradio/io_signature.h>
+#include "HermesCore.h"
+#include "metis.h"
+#include "HermesTrace.h"
+#include <stdio.h>
+#include <cstring>
+#include <new>
+
+
+HermesCore::HermesCore(int RxPre, const char* Intfc, const char * ClkS,
+			 int AlexRA, int AlexTA, int AlexHPF, int AlexLPF,
+			 int Verb, const char* MACAddr,
+			 unsigned NumRxB, unsigned RxBSize)	// constructor
+{
+	strcpy(interface, Intfc);	// Ethernet interface to use (defaults to eth0)
+
+	unsigned int cs;		// Convert ClockSource strings to unsigned, then intitalize
+	sscanf(ClkS, "%x", &cs);
+	ClockSource = (cs & 0xFC);
+
+//	Initialize the Alex control registers.
+
+	AlexRxAnt = AlexRA;		// Select Alex Receive Antenna or from T/R relay
+	AlexTxAnt = AlexTA;		// Select Alex Tx Antenna
+	AlexRxHPF = AlexHPF;		// Select Alex Receive High Pass Filter
+	AlexTxLPF = AlexLPF;		// Select Alex Transmit Low Pass Filter
+
+	Verbose = Verb;			// Turn Verbose mode on/off
+
+	int m = 0;
+	for (; m<17 && MACAddr[m] != 0; m++)
+	  mactarget[m] = toupper(MACAddr[m]);	// Copy the requested MAC target address
+	mactarget[m] = 0;			// (never read past the end of a short "*")
+
+	Receive0Frequency = 0;
+	Receive1Frequency = 0;
+	Receive2Frequency = 0;
+	Receive3Frequency = 0;
+	Receive4Frequency = 0;
+	Receive5Frequency = 0;
+	Receive6Frequency = 0;
+	Receive7Frequency = 0;
+
+	TransmitFrequency = 0;		// initialize frequencies
+	NumReceivers = 1;		// proxies override these before
+	RxSampleRate = 48000;		// calling AttachHermes()
+
+	TxDrive = 0;		// default to (almost) off
+	PTTMode = PTTOff;
+	RxPreamp = (bool)RxPre;
+	PTTOffMutesTx = 0;   // PTT Off mutes the transmitter
+	PTTOnMutesRx = 0;	// PTT On mutes receiver
+
+	ADCdither = false;
+	ADCrandom = false;
+	RxAtten = 0;		// Hermes V2.0
+	Duplex = true;		// Allows TxF to program separately from RxF
+
+	for (int i=0; i<4; i++)
+	  StatusLatch[i] = 0;	// nothing received yet
+	StatusFrames = 0;
+	ADCOverloadFrames = 0;
+
+	TxStop = false;
+
+	RxWriteCounter = 0;	// These control the Rx buffers to Gnuradio
+	RxReadCounter = 0;	//
+	RxHighWater = 0;	//
+
+	TxWriteCounter = 0;	//
+ 	TxReadCounter = 0;	// These control the Tx buffers to Hermes
+	TxControlCycler = 0;	//
+	TxFrameIdleCount = 0;	//
+	memset(SentRegs, 0, sizeof(SentRegs));
+
+	LostRxBufCount = 0;	//
+	TotalRxBufCount = 0;	//
+	LostTxBufCount = 0;	//
+	TotalTxBufCount = 0;	// diagnostics
+	CorruptRxCount = 0;	//
+	LostEthernetRx = 0;	//
+	CurrentEthSeqNum = 0;	//
+
+	TxHoldOff = false;	// initialize transmit hold off flag
+
+	metis_entry = 0;
+
+	NumRxBufs = NumRxB;
+	RxBufSize = RxBSize;
+
+	try
+	{
+	    // allocate the receiver buffers
+	    RxIQBuf = new IQBuf_t[NumRxBufs];
+	    for(unsigned i=0; i<NumRxBufs; i++)
+		RxIQBuf[i] = new float[RxBufSize];
+	    RxSlotArrival = new uint64_t[NumRxBufs]();
+	    RxSlotCommit = new uint64_t[NumRxBufs]();
+
+	    // allocate the transmit buffers
+	    for(int i=0; i<NUMTXBUFS; i++)
+		TxBuf[i] = new unsigned char[TXBUFSIZE];
+	}
+	catch(std::bad_alloc& ba)
+	{
+	   fprintf(stderr, "\nFATAL: unable to allocate memory for buffers.\n %s\n", ba.what());
+	   throw;
+	}
+};
+
+HermesCore::~HermesCore()
+{
+	fprintf(stderr, "\nLostRxBufCount = %lu  TotalRxBufCount = %lu"
+		"  LostTxBufCount = %lu  TotalTxBufCount = %lu"
+		"  CorruptRxCount = %lu  LostEthernetRx = %lu\n",
+	        LostRxBufCount.load(), TotalRxBufCount.load(), LostTxBufCount.load(),
+		TotalTxBufCount.load(), CorruptRxCount.load(), LostEthernetRx.load());
+
+	metis_receive_stream_control(RxStream_Off, metis_entry);	// stop Hermes data stream
+
+	metis_stop_receive_thread();	// stop receive_thread & close socket
+
+	for(int i=0; i<NUMTXBUFS; i++)
+		delete [] TxBuf[i];
+
+	for(unsigned i=0; i<NumRxBufs; i++)
+		delete [] RxIQBuf[i];
+	delete [] RxIQBuf;
+	delete [] RxSlotArrival;
+	delete [] RxSlotCommit;
+}
+
+
+// Called by the proxy constructors once their own register values
+// (sample rate, number of receivers, frequencies...) are set up.
+
+void HermesCore::AttachHermes()
+{
+	metis_discover((const char *)(interface));
+
+//
+// If there is no specified MAC address (i.e. wildcard, or anything less than 17
+// characters, then just grab the first Hermes/Metis that
+// responds to discovery. If there is a specific MAC address specified, then wait
+// until it appears in the Metis cards table, and set the metis table index to match.
+// The string is HH:HH:HH:HH:HH:HH\0 formated, where HH is a 2-digital Hexidecimal number
+// uppercase, example:    04:7F:3D:0F:28:5A
+//
+
+	metis_entry = 0;
+	if (strlen(mactarget) != 17 ||			// Not a fully-qualified MAC address, default to first MAC found
+	    metis_backend() == METIS_BACKEND_REPLAY)	// or replaying a capture, the recorded card stands in
+	{
+	  while (metis_found() == 0)
+		;					// wait until Hermes responds with first discovered MAC
+	}
+	else						// Search the table for the entry matching requested MAC address
+	{
+	  bool found = false;
+	  while(!found)					// Search for MAC address in the metis_table until the cows come home
+	    for(int i=0; i<metis_found(); i++)
+	      {
+		if (strcmp(mactarget, metis_mac_address(i)) == 0)	// Exact match found
+		{
+		  metis_entry = i;					// Select entry in metis_table
+	          found = true;
+		  break;
+		}
+	      }
+	}
+
+	metis_receive_stream_control(RxStream_Off, metis_entry);	// turn off Hermes -> PC streams
+
+	UpdateHermes();					// send specific control registers
+							// and initialize 1st Tx buffer
+							// before allowing scheduler to Start
+};
+
+
+void HermesCore::Stop()	// stop ethernet I/O
+{
+	metis_receive_stream_control(RxStream_Off, metis_entry);	// stop Hermes Rx data stream
+	TxStop = true;					// stop Tx data to Hermes
+};
+
+void HermesCore::PrintRawBuf(RawBuf_t inbuf)	// for debugging
+{
+
+	fprintf(stderr, "Addr: %p    Dump of Raw Buffer\n", inbuf);
+	for(int row=0; row<4; row++)
+	{
+	    int addr = row * 16;
+	    fprintf(stderr, "%04X:  ", addr);
+	    for(int column=0; column<8; column++)
+	    	fprintf(stderr, "%02X:", inbuf[row*16+column]);
+	    fprintf(stderr, "...");
+	    for(int column=8; column<16; column++)
+	    	fprintf(stderr, "%02X:", inbuf[row*16+column]);
+	    fprintf(stderr, "\n");
+	}
+
+	fprintf(stderr, "\n");
+
+};
+
+
+// Look for lost receive packets based on skips in the HPSDR ethernet header
+// sequence number. Returns the sequence number of this frame.
+
+unsigned int HermesCore::TrackRxSequence(const unsigned char * inbuf)
+{
+	unsigned int SequenceNum = (unsigned char)(inbuf[4]) << 24;
+	SequenceNum += (unsigned char)(inbuf[5]) << 16;
+	SequenceNum += (unsigned char)(inbuf[6]) << 8;
+	SequenceNum += (unsigned char)(inbuf[7]);
+
+	if(SequenceNum > CurrentEthSeqNum + 1)
+	{
+	    HPSDR_TRACE2(rx_gap, CurrentEthSeqNum + 1, SequenceNum);
+	    Count(LostEthernetRx, SequenceNum - CurrentEthSeqNum);
+	    CurrentEthSeqNum = SequenceNum;
+	}
+	else
+	{
+	  if(SequenceNum == CurrentEthSeqNum + 1)
+	    CurrentEthSeqNum++;
+	}
+
+	return SequenceNum;
+};
+
+
+// ********** Rx buffer ring between the metis Rx thread and Gnuradio ****************
+//
+// The write counter is only advanced by the Rx thread and the read counter
+// only by the gnuradio work thread. The release/acquire pairs make sure the
+// buffer contents are visible before the counter that publishes them.
+
+IQBuf_t HermesCore::RxWriteSlot()	// next writable Rx buffer, NULL if full
+{
+	unsigned w = RxWriteCounter.load(std::memory_order_relaxed);
+	if (((w+1) & (NumRxBufs - 1)) == RxReadCounter.load(std::memory_order_acquire))
+	  return NULL;
+
+	return RxIQBuf[w];
+};
+
+void HermesCore::RxCommit(uint64_t Arrival, uint64_t Unpack)	// publish the write slot to the reader
+{
+	unsigned w = RxWriteCounter.load(std::memory_order_relaxed);
+
+	uint64_t now = MonotonicNs();
+	Latency[gr::hpsdr::LATENCY_UNPACK_TO_COMMIT].Add(now - Unpack);
+	RxSlotArrival[w] = Arrival;
+	RxSlotCommit[w] = now;
+
+	RxWriteCounter.store((w+1) & (NumRxBufs - 1), std::memory_order_release);
+
+	unsigned fill = (w + 1 - RxReadCounter.load(std::memory_order_relaxed)) & (NumRxBufs - 1);
+	if (fill > RxHighWater.load(std::memory_order_relaxed))
+	  RxHighWater.store(fill, std::memory_order_relaxed);
+
+	HPSDR_TRACE3(rx_commit, w, fill, Arrival);
+};
+
+IQBuf_t HermesCore::RxReadSlot()	// oldest unread Rx buffer, NULL if empty
+{
+	unsigned r = RxReadCounter.load(std::memory_order_relaxed);
+	if (r == RxWriteCounter.load(std::memory_order_acquire))
+	  return NULL;
+
+	return RxIQBuf[r];
+};
+
+void HermesCore::RxRelease()		// give the read slot back to the writer
+{
+	unsigned r = RxReadCounter.load(std::memory_order_relaxed);
+
+	uint64_t now = MonotonicNs();		// the work thread has just emitted the slot
+	Latency[gr::hpsdr::LATENCY_COMMIT_TO_WORK].Add(now - RxSlotCommit[r]);
+	Latency[gr::hpsdr::LATENCY_ARRIVAL_TO_WORK].Add(now - RxSlotArrival[r]);
+
+	RxReadCounter.store((r+1) & (NumRxBufs - 1), std::memory_order_release);
+};
+
+// Start of the proxy's work on one Ethernet frame. Arrival is when the
+// metis thread got it from the socket, 0 if nobody stamped it (then the
+// frame counts as arriving now).
+
+uint64_t HermesCore::RxUnpackStart(uint64_t & Arrival)
+{
+	uint64_t now = MonotonicNs();
+	if (Arrival == 0 || Arrival > now)
+	  Arrival = now;
+	Latency[gr::hpsdr::LATENCY_SOCKET_TO_UNPACK].Add(now - Arrival);
+	return now;
+};
+
+// Arrival time of every Rx frame for the jitter and drift monitor. WireNs
+// is the kernel receive time stamp when the socket provides one.
+
+void HermesCore::TimeRxFrame(unsigned Seq, uint64_t WireNs)
+{
+	double period = RxFramePeriod();
+	if (period != RxClock.FramePeriod())	// sample rate or receiver count changed
+	  RxClock.Restart(period);
+
+	RxClock.Add(Seq, WireNs);
+};
+
+double HermesCore::RxFramePeriod()
+{
+	return 0.0;
+};
+
+int HermesCore::RxBufFillCount()		// how many RxBuffers are filled?
+{
+	unsigned w = RxWriteCounter.load(std::memory_order_acquire);
+	unsigned r = RxReadCounter.load(std::memory_order_acquire);
+	return (int)((w - r) & (NumRxBufs - 1));
+};
+
+int HermesCore::RxBufFree()		// ring holds NumRxBufs - 1
+{
+	return (int)NumRxBufs - 1 - RxBufFillCount();
+};
+
+int HermesCore::TxBufFillCount()		// how many TxBuffers are waiting?
+{
+	unsigned w = TxWriteCounter.load(std::memory_order_acquire);
+	unsigned r = TxReadCounter.load(std::memory_order_acquire);
+	return (int)((w - r) & (NUMTXBUFS - 1));
+};
+
+void HermesCore::GetStats(gr::hpsdr::hermes_stats & st)	// live copy of the counters
+{
+	st.lost_rx_buf = LostRxBufCount.load(std::memory_order_relaxed);
+	st.total_rx_buf = TotalRxBufCount.load(std::memory_order_relaxed);
+	st.lost_tx_buf = LostTxBufCount.load(std::memory_order_relaxed);
+	st.total_tx_buf = TotalTxBufCount.load(std::memory_order_relaxed);
+	st.corrupt_rx = CorruptRxCount.load(std::memory_order_relaxed);
+	st.lost_ethernet_rx = LostEthernetRx.load(std::memory_order_relaxed);
+
+	st.rx_ring_size = NumRxBufs;
+	st.rx_ring_fill = RxBufFillCount();
+	st.rx_ring_high_water = RxHighWater.load(std::memory_order_relaxed);
+	st.tx_queue_size = NUMTXBUFS;
+	st.tx_queue_fill = TxBufFillCount();
+
+	st.wb_vectors_complete = 0;
+	st.wb_vectors_filled = 0;
+	st.wb_vectors_dropped = 0;
+	st.wb_late_frames = 0;
+
+	st.rx_jitter_us = RxClock.Jitter() * 1e6;
+	st.rx_interval_mean_us = RxClock.MeanInterval() * 1e6;
+	st.rx_interval_std_us = RxClock.StdInterval() * 1e6;
+	st.rx_interval_max_us = RxClock.MaxInterval() * 1e6;
+	st.clock_drift_ppm = RxClock.DriftPpm();
+	st.effective_sample_rate = RxClock.DriftValid() ?
+			RxSampleRate * (1.0 + RxClock.DriftPpm() * 1e-6) : 0.0;
+	st.kernel_timestamps = metis_kernel_timestamps();
+	st.io_backend = metis_backend();
+	metis_poll_counts(&st.busy_poll_hits, &st.busy_poll_misses);
+	st.busy_poll_hit_ratio = (st.busy_poll_hits + st.busy_poll_misses) ?
+			(double)st.busy_poll_hits / (st.busy_poll_hits + st.busy_poll_misses) : 0.0;
+	metis_record_counts(&st.record_frames, &st.record_dropped);
+};
+
+
+// ************  Routines to send data from gnuradio to the transmitter ***************
+
+void HermesCore::UpdateHermes()	// send a set of control registers to hardware with naught Tx data
+{
+
+	// Repurposed to send the initial registers to Hermes before starting the stream.
+	// Ought to rename this as InitializeHermes or something similar.
+
+	unsigned char buffer[512];	// dummy up a USB HPSDR buffer;
+	for(int i=0; i<512; i++)
+		buffer[i] = 0;
+
+	int length = 512;		// metis_write ignores this value
+	unsigned char ep = 0x02;	// all Hermes data is sent to end point 2
+
+	// metis_write needs to be called twice to make one ethernet write to the hardware
+	// Set these registers before starting the receive stream
+
+	BuildControlRegs(0, buffer);
+	metis_write(ep, buffer, length);
+	BuildControlRegs(2, buffer);
+	metis_write(ep, buffer, length);
+
+	BuildControlRegs(0, buffer);
+	metis_write(ep, buffer, length);
+	BuildControlRegs(4, buffer);
+	metis_write(ep, buffer, length);
+
+	BuildControlRegs(0, buffer);
+	metis_write(ep, buffer, length);
+	BuildControlRegs(6, buffer);
+	metis_write(ep, buffer, length);
+
+	// Initialize the first TxBuffer (currently empty) with a valid control frame (on startup only)
+
+	BuildControlRegs(0, buffer);
+	RawBuf_t initial = TxBuf[0];
+	for(int i=0; i<512; i++)
+		initial[i] = buffer[i];
+
+	return;
+}
+
+
+void HermesCore::BuildNextControlRegs(RawBuf_t outbuf)
+{
+	TxControlCycler += 2;		// advance to next register bank, modulo
+	if (TxControlCycler > 0x14)	// 11 register banks (0..10). Note: Bank 10
+	  TxControlCycler = 0;		//    (Hermes attenuator) requires firmware V2.0
+
+	BuildControlRegs(TxControlCycler, outbuf);	// First 8 bytes are the control registers.
+};
+
+
+void HermesCore::BuildControlRegs(unsigned RegNum, RawBuf_t outbuf)
+{
+	// create the sync + control register values to send to Hermes
+	// base on RegNum and the various parameter values.
+	// RegNum must be even.
+
+	unsigned char Speed = 0;	// Rx sample rate
+	unsigned char RxCtrl = 0;	// Rx controls
+	unsigned char Ctrl4 = 0;	// Rx register C4 control
+
+	outbuf[0] = outbuf[1] = outbuf[2] = 0x7f;	// HPSDR USB sync
+
+	outbuf[3] = RegNum;		// C0 Control Register (Bank Sel + PTT)
+	if (PTTMode == PTTOn)
+	  outbuf[3] |= 0x01;				// set MOX bit
+
+	switch(RegNum)
+	{
+	  case 0:
+	    Speed = ClockSource;	// Set clock Source from user input
+	    if(RxSampleRate == 384000)
+		Speed |= 0x03;
+	    if(RxSampleRate == 192000)
+		Speed |= 0x02;
+	    if(RxSampleRate == 96000)
+		Speed |= 0x01;
+	    if(RxSampleRate == 48000)
+		Speed |= 0x00;
+
+	    RxCtrl = 0x00;
+	    if(RxPreamp)
+		RxCtrl |= 0x04;
+	    if(ADCdither)
+		RxCtrl |= 0x08;
+	    if(ADCrandom)
+		RxCtrl |= 0x10;
+
+
+	    Ctrl4 |= ((NumReceivers-1) << 3) & 0x38;	// Number of receivers
+							// V1.58 of protocol_1 spec allows
+							// setting up to 8 receivers, but
+							// I can't find which register to set the
+							// Rx Frequency of the 8th receiver.
+							// Hermes sends corrupted USB frames if
+							// NumReceivers > 4.   Theoretically
+							// Red Pitaya is OK to 6 (to be tested by
+							// someone else).
+
+
+	    if(Duplex)
+		Ctrl4 |= 0x04;
+
+	    outbuf[4] = Speed;				// C1
+	    outbuf[5] = 0x00;				// C2
+	    outbuf[6] = RxCtrl | AlexRxAnt;		// C3
+	    outbuf[7] = Ctrl4 | AlexTxAnt;		// C4 - #Rx, Duplex
+          break;
+
+	  case 2:					// Tx NCO freq (and Rx1 NCO for special case)
+	    outbuf[4] = ((unsigned char)(TransmitFrequency >> 24)) & 0xff;	// c1 RxFreq MSB
+	    outbuf[5] = ((unsigned char)(TransmitFrequency >> 16)) & 0xff;	// c2
+	    outbuf[6] = ((unsigned char)(TransmitFrequency >> 8)) & 0xff;	// c3
+	    outbuf[7] = ((unsigned char)(TransmitFrequency)) & 0xff;		// c4 RxFreq LSB
+          break;
+
+	  case 4:					// Rx1 NCO freq (out port 0)
+	    outbuf[4] = ((unsigned char)(Receive0Frequency >> 24)) & 0xff;	// c1 RxFreq MSB
+	    outbuf[5] = ((unsigned char)(Receive0Frequency >> 16)) & 0xff;	// c2
+	    outbuf[6] = ((unsigned char)(Receive0Frequency >> 8)) & 0xff;	// c3
+	    outbuf[7] = ((unsigned char)(Receive0Frequency)) & 0xff;	// c4 RxFreq LSB
+	  break;
+
+	  case 6:					// Rx2 NCO freq (out port 1)
+	    outbuf[4] = ((unsigned char)(Receive1Frequency >> 24)) & 0xff; // c1 RxFreq MSB
+	    outbuf[5] = ((unsigned char)(Receive1Frequency >> 16)) & 0xff; // c2
+	    outbuf[6] = ((unsigned char)(Receive1Frequency >> 8)) & 0xff;	 // c3
+	    outbuf[7] = ((unsigned char)(Receive1Frequency)) & 0xff;	 // c4 RxFreq LSB
+	  break;
+
+	  case 8:					// Rx3 NCO freq (out port 2)
+	    outbuf[4] = ((unsigned char)(Receive2Frequency >> 24)) & 0xff; // c1 RxFreq MSB
+	    outbuf[5] = ((unsigned char)(Receive2Frequency >> 16)) & 0xff; // c2
+	    outbuf[6] = ((unsigned char)(Receive2Frequency >> 8)) & 0xff;	 // c3
+	    outbuf[7] = ((unsigned char)(Receive2Frequency)) & 0xff;	 // c4 RxFreq LSB
+	  break;
+
+	  case 10:					// Rx4 NCO freq (out port 3)
+	    outbuf[4] = ((unsigned char)(Receive3Frequency >> 24)) & 0xff; // c1 RxFreq MSB
+	    outbuf[5] = ((unsigned char)(Receive3Frequency >> 16)) & 0xff; // c2
+	    outbuf[6] = ((unsigned char)(Receive3Frequency >> 8)) & 0xff;	 // c3
+	    outbuf[7] = ((unsigned char)(Receive3Frequency)) & 0xff;	 // c4 RxFreq LSB
+	  break;
+
+	  case 12:					// Rx5 NCO freq (out port 4)
+	    outbuf[4] = ((unsigned char)(Receive4Frequency >> 24)) & 0xff; // c1 RxFreq MSB
+	    outbuf[5] = ((unsigned char)(Receive4Frequency >> 16)) & 0xff; // c2
+	    outbuf[6] = ((unsigned char)(Receive4Frequency >> 8)) & 0xff;	 // c3
+	    outbuf[7] = ((unsigned char)(Receive4Frequency)) & 0xff;	 // c4 RxFreq LSB
+	  break;
+
+	  case 14:					// Rx6 NCO freq (out port 5)
+	    outbuf[4] = ((unsigned char)(Receive5Frequency >> 24)) & 0xff; // c1 RxFreq MSB
+	    outbuf[5] = ((unsigned char)(Receive5Frequency >> 16)) & 0xff; // c2
+	    outbuf[6] = ((unsigned char)(Receive5Frequency >> 8)) & 0xff;	 // c3
+	    outbuf[7] = ((unsigned char)(Receive5Frequency)) & 0xff;	 // c4 RxFreq LSB
+	  break;
+
+	  case 16:					// Rx7 NCO freq (out port 6)
+	    outbuf[4] = ((unsigned char)(Receive6Frequency >> 24)) & 0xff; // c1 RxFreq MSB
+	    outbuf[5] = ((unsigned char)(Receive6Frequency >> 16)) & 0xff; // c2
+	    outbuf[6] = ((unsigned char)(Receive6Frequency >> 8)) & 0xff;	 // c3
+	    outbuf[7] = ((unsigned char)(Receive6Frequency)) & 0xff;	 // c4 RxFreq LSB
+	  break;
+
+
+	//	Note:  While Ver 1.58 of the HPSDR USB protocol doucment specifies up to 8 receivers,
+	//	It only defines 7 receive frequency control register addresses. So we are currently
+	//	limited to 7 receivers implemented.
+
+
+	  case 18:					// drive level & filt select (if Alex)
+	    if (PTTOffMutesTx & (PTTMode == PTTOff))
+		outbuf[4] = 0;				// (almost) kill Tx when PTTOff and PTTControlsTx
+	    else
+		outbuf[4] = TxDrive;			// c1
+
+
+	    unsigned char RxHPF, TxLPF;
+
+	    RxHPF = AlexRxHPF;
+	    if (AlexRxHPF == 0)				// if Rx autotrack
+	    {
+		if (Receive0Frequency < 1500000)
+		  RxHPF = 0x20;				// bypass
+		else if (Receive0Frequency < 6500000)
+	          RxHPF = 0x10;				// 1.5 MHz HPF
+		else if (Receive0Frequency < 9500000)
+		  RxHPF = 0x08;				// 6.5 MHz HPF
+		else if (Receive0Frequency < 13000000)
+		  RxHPF = 0x04;				// 9.5 mHz HPF
+		else if (Receive0Frequency < 20000000)
+		  RxHPF = 0x01;				// 13 Mhz HPF
+		else if (Receive0Frequency < 50000000)
+		  RxHPF = 0x02;				// 20 MHz HPF
+		else RxHPF = 0x40;			// 6M BPF + LNA
+	    }
+
+	    TxLPF = AlexTxLPF;
+	    if (AlexTxLPF == 0)				// if Tx autotrack
+	    {
+		if (TransmitFrequency > 30000000)
+		  TxLPF = 0x10;				// 6m LPF
+		else if (TransmitFrequency > 19000000)
+		  TxLPF = 0x20;				// 10/12m LPF
+		else if (TransmitFrequency > 14900000)
+		  TxLPF = 0x40;				// 15/17m LPF
+		else if (TransmitFrequency > 9900000)
+		  TxLPF = 0x01;				// 30/20m LPF
+		else if (TransmitFrequency > 4900000)
+		  TxLPF = 0x02;				// 60/40m LPF
+		else if (TransmitFrequency > 3400000)
+		  TxLPF = 0x04;				// 80m LPF
+		else TxLPF = 0x08;			// 160m LPF
+	    }
+
+	    outbuf[5] = 0x40;				// c2 - Alex Manual filter control enabled
+	    outbuf[6] = RxHPF & 0x7f;			// c3 - Alex HPF filter selection
+	    outbuf[7] = TxLPF & 0x7f;			// c4 - Alex LPF filter selection
+	  break;
+
+	  case 20:					// Hermes input attenuator setting
+	    outbuf[4] = 0;				//
+	    outbuf[5] = 0x17;				// Not implemented yet, should not be called by
+	    outbuf[6] = 0;				// TxControlCycler yet.
+	    outbuf[7] = RxAtten;			// 0..31 db attenuator setting (same function as preamp)
+	  break;
+
+	  case 22:
+	    outbuf[4] = 0;				// Register not documented, but zeroed by
+	    outbuf[5] = 0;				// PowerSDR...
+	    outbuf[6] = 0;				//
+	    outbuf[7] = 0;				//
+	  break;
+
+	  default:
+	    fprintf(stderr, "Invalid Hermes/Metis register selection: %d\n", RegNum);
+	    break;
+	};
+
+	if (HPSDR_TRACE_ENABLED && RegNum <= 22)
+	{
+	  uint32_t regs = ((uint32_t)outbuf[4] << 24) | ((uint32_t)outbuf[5] << 16)
+			| ((uint32_t)outbuf[6] << 8) | (uint32_t)outbuf[7];
+	  if (regs != SentRegs[RegNum / 2])
+	  {
+	    SentRegs[RegNum / 2] = regs;
+	    HPSDR_TRACE2(control_change, RegNum, regs);
+	  }
+	}
+};
+
+
+RawBuf_t HermesCore::GetNextTxBuf()		// get a TXBuf if available
+{
+	  unsigned w = (TxWriteCounter.load(std::memory_order_relaxed) + 1) & (NUMTXBUFS - 1);
+	  if (w == TxReadCounter.load(std::memory_order_acquire))
+	    return NULL;
+
+	  TxWriteCounter.store(w, std::memory_order_release); // get next writeable buffer
+
+	  return TxBuf[w];
+};
+
+
+// SendTxIQ() is called on a periodic basis to send Tx Ethernet frames to the
+// Hermes/Metis hardware. It sends 2 USB frames in one Ethernet Frame.
+
+
+void HermesCore::SendTxIQ()
+{
+
+	if(TxStop)				// Kill Tx frames if stopped
+		return;
+
+	unsigned char ep = 0x2;			// Tx data goes to end point 2
+
+	// Time to send one Tx Eth frame (2 x USB frames).
+	// If there are at least two buffers in the queue, send then free them.
+
+	unsigned r = TxReadCounter.load(std::memory_order_relaxed);
+	unsigned queued = (TxWriteCounter.load(std::memory_order_acquire) - r) & (NUMTXBUFS - 1);
+
+	bool bufempty = (queued == 0);
+	bool bufone = (queued == 1);
+	bool bufburst = (queued >= (TXINITIALBURST * 2));
+
+	Count(TotalTxBufCount);
+
+	if(TxHoldOff)	    	// Hold back initial burst of Tx Eth frames
+	{
+	  if (!bufburst)	// Not enough frames to send a burst
+	    return;
+	  			// Have enough frames to send the burst
+	  TxHoldOff = false;	// clear the holdoff flag
+
+	  for (int i=0; i<(TXINITIALBURST * 2); i++)	// 2 USB frames per Ethernet frame
+ 	  {
+	    metis_write(ep, TxBuf[r], 512);	// write one USB frame to metis
+	    r = (r+1) & (NUMTXBUFS - 1);
+	  }
+	  TxReadCounter.store(r, std::memory_order_release);	// and free them
+
+	  return;
+	}
+
+ 	// We're out of bursting mode and into one-at-a-time mode
+
+	if ( bufempty | bufone )    // zero or one buffer ready
+	{
+	  Count(LostTxBufCount);	// Not necessarily a lost buffer for hermesWB
+	  return;
+	}
+	else	// two or more buffers ready
+	{
+	  metis_write(ep, TxBuf[r], 512);		// write one USB frame to metis
+	  r = (r+1) & (NUMTXBUFS - 1);
+
+	  metis_write(ep, TxBuf[r], 512);		// write next USB frame to metis
+	  r = (r+1) & (NUMTXBUFS - 1);
+
+	  TxReadCounter.store(r, std::memory_order_release);	// and free them
+	};
+
+	return;
+};
@@ -0,0 +1,228 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2017 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// HermesCore.h
+//
+// Device and protocol core shared by the narrowband (HermesProxy) and
+// wideband (HermesProxyW) proxies. Holds everything that does not depend
+// on the received stream format: the control registers and their
+// encoding, the Tx frame queue, the Rx buffer ring, Ethernet sequence
+// tracking and the diagnostic counters.
+//
+// The proxies derive from HermesCore and supply the stream decoder
+// (EP6 24-bit multi-receiver for NB, EP4 16-bit raw ADC for WB) and
+// their own Tx scheduling.
+//
+// Version:  October 2026	-- Split out of HermesProxy / HermesProxyW
+//	     October 2026	-- Counters are relaxed atomics, readable live via GetStats()
+//	     October 2026	-- Rx ring slots are time stamped, latency histograms per stage
+//	     October 2026	-- Rx frame jitter and sample clock drift (ClockMonitor)
+//	     October 2026	-- Status registers latched for the telemetry thread
+//	     October 2026	-- USDT tracepoints (HermesTrace.h)
+//	     October 2026	-- Capture replay: any card will do, RxBufFree() for pacing
+
+
+#include <gnuradio/io_signature.h>
+#include <hpsdr/hermes_stats.h>
+#include "LatencyHistogram.h"
+#include "ClockMonitor.h"
+#include <atomic>
+
+#ifndef HermesCore_H
+#define HermesCore_H
+
+#define NUMRXIQBUFS	128		// number of receiver IQ buffers in circular queue.
+					// Must be integral power of 2 (2,4,8,16,32,64, etc.)
+
+#define RXBUFSIZE	256		// number of floats in one RxIQBuf, #complexes is half
+					// Must be integral power of 2 (2,4,8,16,32,64, etc.)
+
+#define NUMTXBUFS	128		// number of transmit buffers in circular queue
+					// Must be integral power of 2
+
+#define TXBUFSIZE	512		// number of bytes in one TxBuf
+
+
+#define TXINITIALBURST	  4		// Number of Ethernet frames to holdoff before bursting
+					// to fill hardware TXFIFO
+
+#define MAXRECEIVERS      8		// Maximum number of receivers defined by protocol specification
+
+
+typedef float* IQBuf_t;			// IQ buffer type (IQ samples as floats)
+typedef unsigned char* RawBuf_t;	// Raw transmit buffer type
+
+// Diagnostic counters. Each one has a single writer (normally the metis Rx
+// thread) and may be read at any time by any thread, so relaxed ordering is
+// all they need.
+
+typedef std::atomic<unsigned long> Counter_t;
+
+static inline void Count(Counter_t& c, unsigned long n = 1)
+{
+	c.fetch_add(n, std::memory_order_relaxed);
+}
+
+enum {  PTTOff,				// PTT disabled
+	PTTVox,				// PTT vox mode (examines TxFrame to decide whether to Tx)
+	PTTOn };			// PTT force Tx on
+
+class HermesCore
+{
+
+protected:
+
+	// Rx buffer ring. Single producer (metis Rx thread), single consumer
+	// (gnuradio work thread). The writer owns RxIQBuf[RxWriteCounter] until it
+	// commits it, the reader owns RxIQBuf[RxReadCounter] until it releases it.
+	// The ring geometry is chosen by the proxy: NB uses NUMRXIQBUFS buffers of
+	// RXBUFSIZE floats, WB one buffer per 16384 sample vector.
+
+	IQBuf_t* RxIQBuf;		// ReceiveIQ buffers
+	unsigned NumRxBufs;		// number of Rx buffers, integral power of 2
+	unsigned RxBufSize;		// number of floats in one Rx buffer
+	std::atomic<unsigned> RxWriteCounter;	// Next Rx buffer to write to
+	std::atomic<unsigned> RxReadCounter;	// Next Rx buffer to read from
+	std::atomic<unsigned> RxHighWater;	// Most Rx buffers ever waiting for the reader
+	uint64_t* RxSlotArrival;	// MonotonicNs() the slot's frame left recvfrom()
+	uint64_t* RxSlotCommit;		// MonotonicNs() the slot was committed
+	bool TxHoldOff;			// Transmit buffer holdoff flag
+
+	RawBuf_t TxBuf[NUMTXBUFS]; 	// Transmit buffers
+	std::atomic<unsigned> TxWriteCounter;	// Which Tx buffer to write to (work thread)
+	std::atomic<unsigned> TxReadCounter;	// Which Tx buffer to read from (Rx thread)
+	unsigned TxControlCycler;	// Which Tx control register set to send
+	unsigned TxFrameIdleCount;	// How long we've gone since sending a TxFrame
+	uint32_t SentRegs[12];		// C1..C4 last built per bank, for the control_change tracepoint
+
+	Counter_t LostRxBufCount;	// Lost-buffer counter for packets we actually got
+	Counter_t TotalRxBufCount;	// Total buffer count (may roll over)
+	Counter_t LostTxBufCount;	//
+	Counter_t TotalTxBufCount;	//
+	Counter_t CorruptRxCount;	//
+	Counter_t LostEthernetRx;	//
+	unsigned long CurrentEthSeqNum;	// Diagnostic
+
+	void AttachHermes();		// discover Hermes, select metis_entry, send initial registers
+	unsigned int TrackRxSequence(const unsigned char *);	// update LostEthernetRx, return seq num
+	void BuildNextControlRegs(RawBuf_t);	// advance TxControlCycler and fill in its registers
+
+	IQBuf_t RxWriteSlot();		// next writable Rx buffer, NULL if ring is full
+	void RxCommit(uint64_t Arrival, uint64_t Unpack);	// hand the RxWriteSlot() buffer to the reader
+	uint64_t RxUnpackStart(uint64_t & Arrival);	// time the socket stage, return the unpack start
+
+	ClockMonitor RxClock;		// jitter and drift of this proxy's Rx endpoint
+	virtual double RxFramePeriod();	// nominal seconds per Rx Ethernet frame, 0 if not paced
+
+public:
+
+	unsigned Receive0Frequency;	// 1st rcvr. Corresponds to out0 in gnuradio
+	unsigned Receive1Frequency;	// 2nd rcvr. Corresponds to out1 in gnuradio
+	unsigned Receive2Frequency;	// 3rd rcvr. Corresponds to out2 in gnuradio
+	unsigned Receive3Frequency;	// 4th rcvr. Corresponds to out3 in gnuradio
+	unsigned Receive4Frequency;	// 5th rcvr. Corresponds to out4 in gnuradio
+	unsigned Receive5Frequency;	// 6th rcvr. Corresponds to out5 in gnuradio
+	unsigned Receive6Frequency;	// 7th rcvr. Corresponds to out6 in gnuradio
+	unsigned Receive7Frequency;	// 8th rcvr. Corresponds to out7 in gnuradio
+
+	unsigned TransmitFrequency;
+	int NumReceivers;
+	int RxSampleRate;
+
+	unsigned char TxDrive;
+	unsigned char RxAtten;		// not yet used (requires Hermes firmware V2.0)
+
+	unsigned int ClockSource;	// upper 6-bits of clock control register
+
+	unsigned char AlexRxAnt;	// Select Alex Receive Antenna or from T/R relay
+	unsigned char AlexTxAnt;	// Select Alex Tx Antenna
+	unsigned char AlexRxHPF;	// Select Alex Receive High Pass Filter
+	unsigned char AlexTxLPF;	// Select Alex Transmit Low Pass Filter
+
+	int PTTMode;
+	bool RxPreamp;
+	bool ADCdither;
+	bool ADCrandom;
+	bool Duplex;
+
+	// Status registers as received, C1..C4 packed high byte first, one per
+	// bank 0x00, 0x08, 0x10, 0x18. Latched by the Rx thread, decoded by the
+	// telemetry thread (HermesTelemetry).
+	std::atomic<uint32_t> StatusLatch[4];
+	Counter_t StatusFrames;		// frames latched
+	Counter_t ADCOverloadFrames;	// bank 0x00 frames with the ADC overload bit
+	int Verbose;
+
+	bool TxStop;
+	bool PTTOffMutesTx;		// PTT Off mutes the transmitter
+	bool PTTOnMutesRx;		// PTT On receiver
+	char interface[16];
+
+	char mactarget[18];		// Requested target's MAC address as string
+					// "HH:HH:HH:HH:HH:HH" HH is hexadecimal string.
+	unsigned int metis_entry;	// Index into Metis_card MAC table
+
+
+	HermesCore(int RxPre, const char* Intfc, const char * ClkS,
+			int AlexRA, int AlexTA, int AlexHPF, int AlexLPF,
+			int Verbose, const char* MACAddr,
+			unsigned NumRxB = NUMRXIQBUFS,
+			unsigned RxBSize = RXBUFSIZE);	// constructor
+
+	virtual ~HermesCore();		// destructor
+
+	void Stop();			// stop ethernet I/O
+
+	void SendTxIQ();		// send an IQ buffer to Hermes transmit hardware
+	void BuildControlRegs(unsigned, RawBuf_t);	// fill in the 8 byte sync+control registers from RegNum
+	RawBuf_t GetNextTxBuf();	// get an empty Tx Buffer
+
+	void UpdateHermes();		// update control registers in Hermes without any Tx data
+
+	virtual void ReceiveRxIQ(unsigned char *, uint64_t Arrival) = 0;	// receive an Ethernet frame from
+							// metis.cc thread, Arrival = MonotonicNs() or 0
+	void TimeRxFrame(unsigned Seq, uint64_t WireNs);	// metis.cc thread, before ReceiveRxIQ()
+
+	inline void LatchStatus(const unsigned char* C)	// C0..C4 of a received USB frame, Rx thread
+	{
+	  if ((C[0] & 0xe0) != 0)	// not a bank we decode
+	    return;
+	  StatusLatch[(C[0] >> 3) & 3].store(((uint32_t)C[1] << 24) | ((uint32_t)C[2] << 16)
+				| ((uint32_t)C[3] << 8) | (uint32_t)C[4], std::memory_order_relaxed);
+	  Count(StatusFrames);
+	  if ((C[0] & 0xf8) == 0x00 && (C[1] & 0x01))
+	    Count(ADCOverloadFrames);
+	}
+
+	IQBuf_t RxReadSlot();		// oldest unread Rx buffer, NULL if ring is empty
+	void RxRelease();		// hand the RxReadSlot() buffer back to the writer
+	int RxBufFillCount();		// how many RxBuffers are filled?
+	int RxBufFree();		// how many can the Rx thread still fill?
+	int TxBufFillCount();		// how many TxBuffers are waiting to be sent?
+
+	virtual void GetStats(gr::hpsdr::hermes_stats &);	// live copy of the counters
+
+	LatencyHistogram Latency[gr::hpsdr::LATENCY_STAGES];	// by hermes_latency_stage
+
+	void PrintRawBuf(RawBuf_t);	// for debugging
+
+};
+
+#endif  // #ifndef HermesCore_H
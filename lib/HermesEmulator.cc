@@ -0,0 +1,662 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2017 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// HermesEmulator.cc
+//
+// Local Hermes protocol 1 emulator. See HermesEmulator.h.
+//
+// Version:  October 2026
+//	     October 2026 - fault injection
+//	     October 2026 - sample clock error (ClockPpm)
+
+#include "HermesEmulator.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+#define WBVECTORFRAMES	32		// EP4 frames per 16384 sample vector
+#define ADCRATE		122.88e6	// Hermes ADC sample rate
+#define TXRATE		48000.0		// EP2 Tx samples per second, any Rx rate
+#define TXFRAMESAMPLES	126		// Tx samples per EP2 frame (2 x 63)
+
+static const int RowCount[EMULATOR_MAXRECEIVERS] =	// NB rows per USB frame vs #receivers
+	{ 63, 36, 25, 19, 15, 13, 11, 10 };
+
+static double now_s()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+HermesEmulator::HermesEmulator(const char* Addr, int Port, const char* MACAddr)
+{
+	strncpy(Address, Addr, sizeof(Address));
+	Address[sizeof(Address)-1] = 0;
+	BindPort = Port;
+
+	unsigned int m[6] = {0, 0, 0, 0, 0, 0};
+	sscanf(MACAddr, "%x:%x:%x:%x:%x:%x", &m[0], &m[1], &m[2], &m[3], &m[4], &m[5]);
+	for (int i=0; i<6; i++)
+	  MAC[i] = (unsigned char)m[i];
+
+	sock = -1;
+	HostKnown = false;
+	Running = false;
+	NBOn = WBOn = false;
+
+	NumReceivers = 1;
+	RxSampleRate = 48000;
+	for (int i=0; i<EMULATOR_MAXRECEIVERS; i++)
+	  RxFrequency[i] = 0;
+	TxFrequency = 0;
+	StepsDirty = true;
+
+	NumCarriers = 0;
+	for (int c=0; c<EMULATOR_MAXCARRIERS; c++)
+	{
+	  WBPhase[c] = 0.0;
+	  for (int rx=0; rx<EMULATOR_MAXRECEIVERS; rx++)
+	  {
+	    NBRe[rx][c] = 1.0;
+	    NBIm[rx][c] = 0.0;
+	  }
+	}
+
+	EP6Seq = EP4Seq = 0;
+	EP2Seq = -1;
+	StatusCycler = 0;
+	NextEP6 = NextWB = EP6Grid = WBGrid = 0.0;
+	NBStartTime = LastEP2Time = 0.0;
+	EP2WhileNB = 0;
+
+	memset(&Stats, 0, sizeof(Stats));
+	memset(&Faults, 0, sizeof(Faults));
+	Faults.BurstLength = 8;
+	Faults.ReorderDepth = 1;
+	Faults.Seed = 1;
+	RandState = 1;
+	BurstRemaining = 0;
+	HeldLen = 0;
+	HeldCountdown = 0;
+
+	WBVectorRate = 4;
+	ClockPpm = 0.0;
+	FirmwareVersion = 32;
+	Verbose = 0;
+}
+
+HermesEmulator::~HermesEmulator()
+{
+	Stop();
+}
+
+bool HermesEmulator::AddCarrier(double FreqHz, double dBFS)
+{
+	if (NumCarriers >= EMULATOR_MAXCARRIERS)
+	  return false;
+
+	CarrierFreq[NumCarriers] = FreqHz;
+	CarrierAmpl[NumCarriers] = pow(10.0, dBFS / 20.0);
+	NumCarriers++;
+	StepsDirty = true;
+	return true;
+}
+
+bool HermesEmulator::Start()
+{
+	struct sockaddr_in name;
+
+	sock = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (sock < 0)
+	{
+	  perror("HermesEmulator: socket");
+	  return false;
+	}
+
+	memset(&name, 0, sizeof(name));
+	name.sin_family = AF_INET;
+	name.sin_port = htons(BindPort);
+	name.sin_addr.s_addr = inet_addr(Address);
+	if (bind(sock, (struct sockaddr*)&name, sizeof(name)) < 0)
+	{
+	  fprintf(stderr, "HermesEmulator: cannot bind %s:%d: %s\n", Address, BindPort, strerror(errno));
+	  close(sock);
+	  sock = -1;
+	  return false;
+	}
+
+	socklen_t len = sizeof(name);
+	getsockname(sock, (struct sockaddr*)&name, &len);
+	BindPort = ntohs(name.sin_port);
+
+	int bufsize = 4 * 1024 * 1024;		// ride out scheduling hiccups at 384 ksps x 8
+	setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &bufsize, sizeof(bufsize));
+	setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+
+	RandState = Faults.Seed ? Faults.Seed : 1;	// xorshift state must not be 0
+	BurstRemaining = 0;
+	HeldLen = 0;
+
+	Running = true;
+	int rc = pthread_create(&Thread, NULL, ThreadEntry, this);
+	if (rc != 0)
+	{
+	  fprintf(stderr, "HermesEmulator: pthread_create failed: rc=%d\n", rc);
+	  Running = false;
+	  close(sock);
+	  sock = -1;
+	  return false;
+	}
+
+	if (Verbose)
+	  fprintf(stderr, "HermesEmulator: listening on %s:%d\n", Address, BindPort);
+	return true;
+}
+
+void HermesEmulator::Stop()
+{
+	if (!Running)
+	  return;
+
+	Running = false;
+	pthread_join(Thread, NULL);
+	close(sock);
+	sock = -1;
+
+	if (EP2WhileNB > 0 && LastEP2Time > NBStartTime)
+	  Stats.EP2RateRatio = EP2WhileNB / ((LastEP2Time - NBStartTime) * TXRATE / TXFRAMESAMPLES);
+}
+
+int HermesEmulator::Port()
+{
+	return BindPort;
+}
+
+int HermesEmulator::Receivers()
+{
+	return NumReceivers;
+}
+
+int HermesEmulator::SampleRate()
+{
+	return RxSampleRate;
+}
+
+unsigned HermesEmulator::Frequency(int rx)
+{
+	return (rx >= 0 && rx < EMULATOR_MAXRECEIVERS) ? RxFrequency[rx] : 0;
+}
+
+void HermesEmulator::PrintStats(FILE* f)
+{
+	fprintf(f, "HermesEmulator: Discovery = %lu  Start = %lu  Stop = %lu\n",
+		Stats.DiscoveryCount, Stats.StartCount, Stats.StopCount);
+	fprintf(f, "HermesEmulator: EP6Sent = %lu  EP4Sent = %lu  LateFrames = %lu\n",
+		Stats.EP6Sent, Stats.EP4Sent, Stats.LateFrames);
+	fprintf(f, "HermesEmulator: EP2Received = %lu  EP2SequenceGaps = %lu  EP2BadSync = %lu"
+		"  EP2LateCount = %lu  EP2MaxGap = %.3f ms  EP2RateRatio = %.4f\n",
+		Stats.EP2Received, Stats.EP2SequenceGaps, Stats.EP2BadSync,
+		Stats.EP2LateCount, Stats.EP2MaxGap * 1e3, Stats.EP2RateRatio);
+	fprintf(f, "HermesEmulator: FaultDropped = %lu  FaultBursts = %lu  FaultReordered = %lu"
+		"  FaultDuplicated = %lu  FaultCorrupted = %lu\n",
+		Stats.FaultDropped, Stats.FaultBursts, Stats.FaultReordered,
+		Stats.FaultDuplicated, Stats.FaultCorrupted);
+}
+
+
+void* HermesEmulator::ThreadEntry(void* arg)
+{
+	((HermesEmulator*)arg)->Loop();
+	return NULL;
+}
+
+void HermesEmulator::Loop()
+{
+	unsigned char buffer[2048];
+	struct sockaddr_in from;
+	socklen_t fromlen;
+
+	while (Running)
+	{
+	  // Sleep until the next Rx frame is due or a packet arrives, at
+	  // most 50 ms so Stop() is noticed.
+
+	  double now = now_s();
+	  double due = now + 0.05;
+	  if (NBOn && NextEP6 < due) due = NextEP6;
+	  if (WBOn && NextWB < due) due = NextWB;
+
+	  struct pollfd pfd;
+	  pfd.fd = sock;
+	  pfd.events = POLLIN;
+	  struct timespec timeout;
+	  double wait = (due > now) ? due - now : 0.0;
+	  timeout.tv_sec = (time_t)wait;
+	  timeout.tv_nsec = (long)((wait - timeout.tv_sec) * 1e9);
+
+	  if (ppoll(&pfd, 1, &timeout, NULL) > 0)
+	  {
+	    int n;
+	    fromlen = sizeof(from);
+	    while ((n = recvfrom(sock, buffer, sizeof(buffer), MSG_DONTWAIT,
+				 (struct sockaddr*)&from, &fromlen)) > 0)
+	    {
+	      HandlePacket(buffer, n, &from);
+	      fromlen = sizeof(from);
+	    }
+	  }
+
+	  now = now_s();
+
+	  if (NBOn)
+	  {
+	    double period = RowCount[NumReceivers-1] * 2.0 / (RxSampleRate * (1.0 + ClockPpm * 1e-6));
+	    while (NBOn && now >= NextEP6)
+	    {
+	      SendEP6();
+	      EP6Grid += period;
+	      if (now - EP6Grid > 0.1)		// fell far behind, don't burst to catch up
+	      {
+	        Stats.LateFrames++;
+	        EP6Grid = now;
+	      }
+	      NextEP6 = EP6Grid + Jitter();
+	    }
+	  }
+
+	  if (WBOn && now >= NextWB)
+	  {
+	    SendWBVector();
+	    WBGrid += 1.0 / WBVectorRate;
+	    if (now - WBGrid > 0.1)
+	      WBGrid = now;
+	    NextWB = WBGrid + Jitter();
+	  }
+	}
+}
+
+
+void HermesEmulator::HandlePacket(unsigned char* buf, int len, struct sockaddr_in* from)
+{
+	if (len < 4 || buf[0] != 0xEF || buf[1] != 0xFE)
+	  return;
+
+	switch (buf[2])
+	{
+	  case 0x01:					// data, EP2 from the host
+	    if (len == 1032 && buf[3] == 0x02)
+	      HandleEP2(buf, now_s());
+	    break;
+
+	  case 0x02:					// discovery
+	  {
+	    unsigned char reply[60];
+	    memset(reply, 0, sizeof(reply));
+	    reply[0] = 0xEF;
+	    reply[1] = 0xFE;
+	    reply[2] = 0x02;				// not streaming
+	    memcpy(&reply[3], MAC, 6);
+	    reply[9] = FirmwareVersion;
+	    reply[10] = 0x01;				// board type: Hermes
+	    sendto(sock, reply, sizeof(reply), 0, (struct sockaddr*)from, sizeof(*from));
+	    Stats.DiscoveryCount++;
+	    break;
+	  }
+
+	  case 0x04:					// start / stop
+	  {
+	    bool nb = (buf[3] & 0x01) != 0;
+	    bool wb = (buf[3] & 0x02) != 0;
+	    double now = now_s();
+
+	    HostAddr = *from;
+	    HostKnown = true;
+
+	    if (nb && !NBOn)
+	    {
+	      EP6Seq = 0;
+	      NextEP6 = EP6Grid = now;
+	      NBStartTime = now;
+	      LastEP2Time = 0.0;
+	      EP2WhileNB = 0;
+	    }
+	    if (wb && !WBOn)
+	    {
+	      EP4Seq = 0;
+	      NextWB = WBGrid = now;
+	    }
+	    NBOn = nb;
+	    WBOn = wb;
+
+	    if (nb || wb)
+	      Stats.StartCount++;
+	    else
+	    {
+	      Stats.StopCount++;
+	      EP2Seq = -1;				// host restarts its Tx sequence on stop
+	      HeldLen = 0;				// a held back frame is never sent
+	    }
+	    if (Verbose)
+	      fprintf(stderr, "HermesEmulator: stream NB %s  WB %s\n", nb ? "on" : "off", wb ? "on" : "off");
+	    break;
+	  }
+
+	  default:
+	    break;
+	}
+}
+
+void HermesEmulator::HandleEP2(unsigned char* buf, double now)
+{
+	Stats.EP2Received++;
+
+	long seq = ((long)buf[4] << 24) | ((long)buf[5] << 16) | ((long)buf[6] << 8) | (long)buf[7];
+	if (EP2Seq >= 0 && seq != EP2Seq + 1)
+	  Stats.EP2SequenceGaps += (seq > EP2Seq) ? seq - EP2Seq - 1 : 1;
+	EP2Seq = seq;
+
+	// Cadence: the host should send one EP2 frame per 126 Tx samples at 48 ksps
+
+	if (NBOn)
+	{
+	  if (LastEP2Time > 0.0)
+	  {
+	    double gap = now - LastEP2Time;
+	    if (gap > Stats.EP2MaxGap)
+	      Stats.EP2MaxGap = gap;
+	    if (gap > 4.0 * TXFRAMESAMPLES / TXRATE)
+	      Stats.EP2LateCount++;
+	  }
+	  LastEP2Time = now;
+	  EP2WhileNB++;
+	}
+
+	for (int usb=8; usb<=520; usb+=512)
+	{
+	  if (buf[usb] != 0x7f || buf[usb+1] != 0x7f || buf[usb+2] != 0x7f)
+	    Stats.EP2BadSync++;
+	  else
+	    DecodeControlRegs(&buf[usb]);
+	}
+}
+
+void HermesEmulator::DecodeControlRegs(const unsigned char* usb)
+{
+	unsigned char c0 = usb[3] & 0xfe;		// register bank, MOX masked off
+	unsigned freq = ((unsigned)usb[4] << 24) | ((unsigned)usb[5] << 16) |
+			((unsigned)usb[6] << 8) | (unsigned)usb[7];
+
+	switch (c0)
+	{
+	  case 0x00:
+	  {
+	    static const int Rates[4] = { 48000, 96000, 192000, 384000 };
+	    int rate = Rates[usb[4] & 0x03];
+	    int nrx = ((usb[7] >> 3) & 0x07) + 1;
+	    if (rate != RxSampleRate || nrx != NumReceivers)
+	    {
+	      RxSampleRate = rate;
+	      NumReceivers = nrx;
+	      StepsDirty = true;
+	    }
+	    break;
+	  }
+
+	  case 0x02:
+	    TxFrequency = freq;
+	    break;
+
+	  case 0x04: case 0x06: case 0x08: case 0x0a:	// Rx1 .. Rx7 NCO
+	  case 0x0c: case 0x0e: case 0x10:
+	    if (RxFrequency[(c0 - 0x04) / 2] != freq)
+	    {
+	      RxFrequency[(c0 - 0x04) / 2] = freq;
+	      StepsDirty = true;
+	    }
+	    break;
+
+	  case 0x24:					// Rx8 NCO
+	    if (RxFrequency[7] != freq)
+	    {
+	      RxFrequency[7] = freq;
+	      StepsDirty = true;
+	    }
+	    break;
+
+	  default:					// drive, filters, attenuator: not emulated
+	    break;
+	}
+}
+
+void HermesEmulator::ComputeSteps()
+{
+	// Each receiver hears carrier c at (CarrierFreq - NCO). Carriers outside
+	// 90% of the receiver bandwidth are removed, as the decimation filter would.
+
+	for (int rx=0; rx<EMULATOR_MAXRECEIVERS; rx++)
+	  for (int c=0; c<NumCarriers; c++)
+	  {
+	    double offset = CarrierFreq[c] - (double)RxFrequency[rx];
+	    double w = 2.0 * M_PI * offset / RxSampleRate;
+	    NBStepRe[rx][c] = cos(w);
+	    NBStepIm[rx][c] = sin(w);
+	    NBAmpl[rx][c] = (fabs(offset) < 0.45 * RxSampleRate) ? CarrierAmpl[c] : 0.0;
+	  }
+	StepsDirty = false;
+}
+
+
+void HermesEmulator::SendEP6()
+{
+	unsigned char frame[1032];
+
+	if (StepsDirty)
+	  ComputeSteps();
+
+	frame[0] = 0xEF;
+	frame[1] = 0xFE;
+	frame[2] = 0x01;
+	frame[3] = 0x06;
+	frame[4] = (EP6Seq >> 24) & 0xff;
+	frame[5] = (EP6Seq >> 16) & 0xff;
+	frame[6] = (EP6Seq >> 8) & 0xff;
+	frame[7] = EP6Seq & 0xff;
+	EP6Seq++;
+
+	int nrx = NumReceivers;
+	int rows = RowCount[nrx-1];
+
+	for (int usb=8; usb<=520; usb+=512)
+	{
+	  unsigned char* p = &frame[usb];
+	  p[0] = p[1] = p[2] = 0x7f;
+	  p[3] = (StatusCycler << 3);			// status bank, no PTT/dash/dot
+	  p[4] = p[5] = p[6] = 0;
+	  p[7] = (StatusCycler == 0) ? FirmwareVersion : 0;
+	  StatusCycler = (StatusCycler + 1) & 0x03;
+	  p += 8;
+
+	  for (int row=0; row<rows; row++)
+	  {
+	    for (int rx=0; rx<nrx; rx++)
+	    {
+	      double I = 0.0, Q = 0.0;
+	      for (int c=0; c<NumCarriers; c++)
+	      {
+	        I += NBAmpl[rx][c] * NBRe[rx][c];
+	        Q += NBAmpl[rx][c] * NBIm[rx][c];
+	        double re = NBRe[rx][c] * NBStepRe[rx][c] - NBIm[rx][c] * NBStepIm[rx][c];
+	        NBIm[rx][c] = NBRe[rx][c] * NBStepIm[rx][c] + NBIm[rx][c] * NBStepRe[rx][c];
+	        NBRe[rx][c] = re;
+	      }
+	      if (I > 1.0) I = 1.0; else if (I < -1.0) I = -1.0;
+	      if (Q > 1.0) Q = 1.0; else if (Q < -1.0) Q = -1.0;
+	      int i24 = (int)lrint(I * 8388607.0);
+	      int q24 = (int)lrint(Q * 8388607.0);
+	      *p++ = (i24 >> 16) & 0xff;  *p++ = (i24 >> 8) & 0xff;  *p++ = i24 & 0xff;
+	      *p++ = (q24 >> 16) & 0xff;  *p++ = (q24 >> 8) & 0xff;  *p++ = q24 & 0xff;
+	    }
+	    *p++ = 0;					// mic
+	    *p++ = 0;
+	  }
+	  while (p < &frame[usb+512])			// unused tail of the USB frame
+	    *p++ = 0;
+	}
+
+	// keep the phasors on the unit circle
+
+	for (int rx=0; rx<nrx; rx++)
+	  for (int c=0; c<NumCarriers; c++)
+	  {
+	    double mag = sqrt(NBRe[rx][c] * NBRe[rx][c] + NBIm[rx][c] * NBIm[rx][c]);
+	    NBRe[rx][c] /= mag;
+	    NBIm[rx][c] /= mag;
+	  }
+
+	SendFrame(frame, sizeof(frame));
+	Stats.EP6Sent++;
+}
+
+void HermesEmulator::SendWBVector()
+{
+	// One 16384 sample snapshot of the ADC, as 32 EP4 frames of 2 x 256
+	// 16-bit little-endian samples. Vectors are not time contiguous, like
+	// the hardware, so each one continues from an arbitrary phase.
+
+	unsigned char frame[1032];
+
+	frame[0] = 0xEF;
+	frame[1] = 0xFE;
+	frame[2] = 0x01;
+	frame[3] = 0x04;
+
+	for (int f=0; f<WBVECTORFRAMES; f++)
+	{
+	  frame[4] = (EP4Seq >> 24) & 0xff;
+	  frame[5] = (EP4Seq >> 16) & 0xff;
+	  frame[6] = (EP4Seq >> 8) & 0xff;
+	  frame[7] = EP4Seq & 0xff;
+	  EP4Seq++;
+
+	  for (int i=0; i<512; i++)
+	  {
+	    double x = 0.0;
+	    for (int c=0; c<NumCarriers; c++)
+	    {
+	      x += CarrierAmpl[c] * cos(WBPhase[c]);
+	      WBPhase[c] += 2.0 * M_PI * CarrierFreq[c] / ADCRATE;
+	    }
+	    if (x > 1.0) x = 1.0; else if (x < -1.0) x = -1.0;
+	    int s = (int)lrint(x * 32767.0);
+	    frame[8 + 2*i] = s & 0xff;
+	    frame[9 + 2*i] = (s >> 8) & 0xff;
+	  }
+	  SendFrame(frame, sizeof(frame));
+	  Stats.EP4Sent++;
+	}
+
+	for (int c=0; c<NumCarriers; c++)
+	  WBPhase[c] = fmod(WBPhase[c], 2.0 * M_PI);
+}
+
+double HermesEmulator::Uniform()
+{
+	RandState ^= RandState >> 12;
+	RandState ^= RandState << 25;
+	RandState ^= RandState >> 27;
+	return (double)((RandState * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double HermesEmulator::Jitter()
+{
+	return (Faults.JitterMax > 0.0) ? Uniform() * Faults.JitterMax : 0.0;
+}
+
+void HermesEmulator::SendFrame(unsigned char* buf, int len)
+{
+	// Rx data frames pass through the fault injector. Faults only draw
+	// from the generator when enabled, so the same settings and seed give
+	// the same faults on the same frames every run.
+
+	if (!HostKnown)
+	  return;
+
+	if (BurstRemaining > 0)
+	{
+	  BurstRemaining--;
+	  Stats.FaultDropped++;
+	  return;
+	}
+	if (Faults.BurstRate > 0.0 && Uniform() < Faults.BurstRate)
+	{
+	  BurstRemaining = Faults.BurstLength - 1;
+	  Stats.FaultBursts++;
+	  Stats.FaultDropped++;
+	  return;
+	}
+	if (Faults.LossRate > 0.0 && Uniform() < Faults.LossRate)
+	{
+	  Stats.FaultDropped++;
+	  return;
+	}
+
+	if (Faults.CorruptRate > 0.0 && Uniform() < Faults.CorruptRate)
+	{
+	  buf[8] = 0x00;				// first sync byte of the first USB frame
+	  Stats.FaultCorrupted++;
+	}
+
+	if (HeldLen == 0 && Faults.ReorderRate > 0.0 && Uniform() < Faults.ReorderRate)
+	{
+	  memcpy(Held, buf, len);
+	  HeldLen = len;
+	  HeldCountdown = (Faults.ReorderDepth < 1) ? 1 : Faults.ReorderDepth;
+	  Stats.FaultReordered++;
+	  return;
+	}
+
+	Transmit(buf, len);
+	if (Faults.DuplicateRate > 0.0 && Uniform() < Faults.DuplicateRate)
+	{
+	  Transmit(buf, len);
+	  Stats.FaultDuplicated++;
+	}
+
+	if (HeldLen != 0 && --HeldCountdown == 0)
+	{
+	  Transmit(Held, HeldLen);
+	  HeldLen = 0;
+	}
+}
+
+void HermesEmulator::Transmit(const unsigned char* buf, int len)
+{
+	sendto(sock, buf, len, 0, (struct sockaddr*)&HostAddr, sizeof(HostAddr));
+}
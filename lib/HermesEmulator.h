@@ -0,0 +1,193 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2017 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// HermesEmulator.h
+//
+// Local stand-in for a Hermes board, speaking HPSDR protocol 1 over UDP
+// on a loopback address. Lets metis.cc, HermesProxy and HermesProxyW be
+// run, tested and benchmarked without radio hardware.
+//
+// The emulator answers discovery (0x02), honours start/stop (0x04) for
+// the narrowband (EP6) and wideband (EP4) streams, and decodes the control
+// registers in every EP2 frame it receives. EP6 frames carry 1..8
+// receivers at 48..384 ksps, paced in real time, with each receiver
+// hearing the configured RF carriers relative to its programmed NCO
+// frequency. EP4 frames carry 16384 sample raw ADC vectors of the same
+// carriers at 122.88 Msps, a few vectors per second like the hardware.
+// EP2 sequence numbers and inter-arrival times are checked against the
+// 48 ksps Tx cadence.
+//
+// Faults can be injected into the Rx stream (EP6 and EP4): random and
+// burst loss, reordering, duplicates, corrupted sync bytes and
+// inter-arrival jitter. All draws come from one generator seeded by
+// Faults.Seed at Start(), so a run is repeatable frame for frame.
+//
+// metis.cc sends discovery to EMULATOR_ADDRESS when the interface is the
+// loopback ("lo"), so a flowgraph with Intfc "lo" talks to the emulator.
+// Binding 127.0.0.2 works out of the box on Linux.
+//
+// Version:  October 2026
+//	     October 2026 - fault injection
+
+#ifndef HermesEmulator_H
+#define HermesEmulator_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include "metis.h"
+
+#define EMULATOR_MAXCARRIERS	8	// RF carriers in the emulated antenna signal
+#define EMULATOR_MAXRECEIVERS	8	// protocol 1 maximum
+
+struct EmulatorStats
+{
+	unsigned long DiscoveryCount;	// discovery requests answered
+	unsigned long StartCount;	// start/stop packets with a stream on
+	unsigned long StopCount;	// start/stop packets with all streams off
+	unsigned long EP6Sent;		// narrowband Ethernet frames sent
+	unsigned long EP4Sent;		// wideband Ethernet frames sent
+	unsigned long LateFrames;	// times the Rx schedule slipped > 100 ms
+
+	unsigned long EP2Received;	// Tx Ethernet frames received
+	unsigned long EP2SequenceGaps;	// Tx frames missing by sequence number
+	unsigned long EP2BadSync;	// Tx USB frames without 7f 7f 7f sync
+	unsigned long EP2LateCount;	// Tx inter-arrival > 4 x nominal while NB streaming
+	double EP2MaxGap;		// longest Tx inter-arrival while NB streaming, seconds
+	double EP2RateRatio;		// Tx frames received / expected while NB streaming
+
+	unsigned long FaultDropped;	// Rx frames dropped (random + burst)
+	unsigned long FaultBursts;	// loss bursts started
+	unsigned long FaultReordered;	// Rx frames held back and sent late
+	unsigned long FaultDuplicated;	// Rx frames sent twice
+	unsigned long FaultCorrupted;	// Rx frames sent with a bad sync byte
+};
+
+struct EmulatorFaults			// all rates are per Rx frame, 0..1
+{
+	double LossRate;		// drop one frame
+	double BurstRate;		// start a loss burst
+	int BurstLength;		// frames lost per burst
+	double ReorderRate;		// hold a frame back ...
+	int ReorderDepth;		// ... until this many later frames have gone
+	double DuplicateRate;		// send a frame twice
+	double CorruptRate;		// zero the first sync byte of a frame
+	double JitterMax;		// extra send delay, uniform 0..JitterMax seconds
+	unsigned long long Seed;	// generator seed, same seed = same faults
+};
+
+class HermesEmulator
+{
+
+private:
+
+	int sock;			// UDP socket bound to Address:Port
+	char Address[16];
+	int BindPort;
+	unsigned char MAC[6];
+	struct sockaddr_in HostAddr;	// where to send Rx frames (learned from start)
+	bool HostKnown;
+
+	pthread_t Thread;
+	volatile bool Running;
+	volatile bool NBOn;		// EP6 streaming
+	volatile bool WBOn;		// EP4 streaming
+
+	// Decoded from EP2 control registers
+
+	int NumReceivers;
+	int RxSampleRate;
+	unsigned RxFrequency[EMULATOR_MAXRECEIVERS];
+	unsigned TxFrequency;
+	bool StepsDirty;		// NCO or rate changed, recompute NB phasors
+
+	// Signal generators: one phasor per (receiver, carrier) for NB,
+	// one phase per carrier for WB.
+
+	double CarrierFreq[EMULATOR_MAXCARRIERS];	// Hz
+	double CarrierAmpl[EMULATOR_MAXCARRIERS];	// 0..1 of full scale
+	int NumCarriers;
+	double NBRe[EMULATOR_MAXRECEIVERS][EMULATOR_MAXCARRIERS];
+	double NBIm[EMULATOR_MAXRECEIVERS][EMULATOR_MAXCARRIERS];
+	double NBStepRe[EMULATOR_MAXRECEIVERS][EMULATOR_MAXCARRIERS];
+	double NBStepIm[EMULATOR_MAXRECEIVERS][EMULATOR_MAXCARRIERS];
+	double NBAmpl[EMULATOR_MAXRECEIVERS][EMULATOR_MAXCARRIERS];	// 0 if outside the passband
+	double WBPhase[EMULATOR_MAXCARRIERS];
+
+	unsigned EP6Seq;		// Rx sequence numbers, EP6 and EP4 count separately
+	unsigned EP4Seq;
+	long EP2Seq;			// last Tx sequence number, -1 before the first
+	unsigned StatusCycler;		// which status register bank to send next
+
+	double NextEP6;			// when the next EP6 frame is due (incl. jitter)
+	double NextWB;			// when the next EP4 vector is due (incl. jitter)
+	double EP6Grid;			// nominal EP6 schedule, jitter never accumulates
+	double WBGrid;			// nominal EP4 schedule
+	double NBStartTime;		// when NB streaming started
+	double LastEP2Time;		// arrival of the previous EP2 frame
+	unsigned long EP2WhileNB;	// EP2 frames received while NB streaming
+
+	unsigned long long RandState;	// xorshift64* state
+	int BurstRemaining;		// frames still to drop in the current burst
+	unsigned char Held[1032];	// frame held back for reordering
+	int HeldLen;			// 0 if none
+	int HeldCountdown;		// frames to send before the held one
+
+	double Uniform();		// next draw, 0 <= x < 1
+	double Jitter();		// next extra send delay
+	void Transmit(const unsigned char*, int);
+
+	static void* ThreadEntry(void*);
+	void Loop();
+	void HandlePacket(unsigned char*, int, struct sockaddr_in*);
+	void HandleEP2(unsigned char*, double);
+	void DecodeControlRegs(const unsigned char*);
+	void ComputeSteps();
+	void SendEP6();
+	void SendWBVector();
+	void SendFrame(unsigned char*, int);
+
+public:
+
+	EmulatorStats Stats;		// updated by the emulator thread, read after Stop()
+	EmulatorFaults Faults;		// set before Start(), all off by default
+	int WBVectorRate;		// wideband vectors per second (default 4)
+	double ClockPpm;		// sample clock error against the host clock (default 0)
+	unsigned char FirmwareVersion;	// reported in status and discovery (default 32)
+	int Verbose;
+
+	HermesEmulator(const char* Addr = EMULATOR_ADDRESS, int Port = 1024,
+			const char* MACAddr = "00:1C:C0:A2:22:5E");	// constructor
+	~HermesEmulator();		// destructor, stops the thread
+
+	bool AddCarrier(double FreqHz, double dBFS);	// add an RF tone, false if full
+	bool Start();			// bind the socket and start the thread, false on error
+	void Stop();			// stop the thread and close the socket
+
+	int Port();			// bound port, useful when constructed with Port 0
+	int Receivers();		// as last programmed by the host
+	int SampleRate();		// as last programmed by the host
+	unsigned Frequency(int rx);	// Rx NCO frequency as last programmed by the host
+
+	void PrintStats(FILE*);
+
+};
+
+#endif  // #ifndef HermesEmulator_H
@@ -0,0 +1,112 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2017 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+//
+// Hermes Kernels
+//
+// Sample conversion kernels for the Rx hot path.
+//
+// The wideband EP4 stream is 16-bit little-endian 2's complement, which on a
+// little-endian host is already an int16_t array. VOLK's
+// volk_16i_s32f_convert_32f then does the whole frame with SSE/AVX/NEON and
+// handles the unaligned input (the samples start 8 bytes into the Ethernet
+// frame). Big-endian hosts and builds without VOLK use the generic loop.
+// CopyADC16 passes the samples through as int16_t: a plain copy on a
+// little-endian host.
+//
+// DeinterleaveIQ is the narrowband general_work() copy, split out so
+// bench-hpsdr can time it; DeinterleaveIQ16/32 are its integer versions
+// for the sc16 and sc32 outputs.
+//
+// Version:  October 2026
+//
+
+#include "HermesKernels.h"
+#include <stdint.h>
+#include <complex>
+#include <string.h>
+
+#ifdef HAVE_VOLK
+#include <volk/volk.h>
+#endif
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define HOST_IS_LITTLE_ENDIAN 1
+#endif
+
+
+void ConvertADC16_generic(const unsigned char* in, float* out, int nsamples)
+{
+	for (int j = 0; j<nsamples; j++)
+	{
+	  // assemble without branching: the int16_t cast does the 2's complement
+	  int16_t I = (int16_t)(((unsigned)in[j*2+1] << 8) | (unsigned)in[j*2]);
+	  out[j] = (float)I / 32767.0f;
+	}
+};
+
+void ConvertADC16(const unsigned char* in, float* out, int nsamples)
+{
+#if defined(HAVE_VOLK) && defined(HOST_IS_LITTLE_ENDIAN)
+	volk_16i_s32f_convert_32f(out, (const int16_t*)in, 32767.0f, nsamples);
+#else
+	ConvertADC16_generic(in, out, nsamples);
+#endif
+};
+
+void CopyADC16(const unsigned char* in, int16_t* out, int nsamples)
+{
+#if defined(HOST_IS_LITTLE_ENDIAN)
+	memcpy(out, in, nsamples * sizeof(int16_t));
+#else
+	for (int j = 0; j<nsamples; j++)
+	  out[j] = (int16_t)(((unsigned)in[j*2+1] << 8) | (unsigned)in[j*2]);
+#endif
+};
+
+void DeinterleaveIQ(const float* in, void* const* out, int nrx, int nsamples)
+{
+	for (int index=0; index<nsamples; index++)
+	    for (int receiver=0; receiver < nrx; receiver++)
+	    {
+	        ((std::complex<float> *)out[receiver])[index] = std::complex<float>(in[0], in[1]);
+	        in += 2;
+	    }
+};
+
+void DeinterleaveIQ16(const int16_t* in, void* const* out, int nrx, int nsamples)
+{
+	for (int index=0; index<nsamples; index++)
+	    for (int receiver=0; receiver < nrx; receiver++)
+	    {
+	        memcpy((int16_t *)out[receiver] + 2*index, in, 2 * sizeof(int16_t));	// I,Q as one move
+	        in += 2;
+	    }
+};
+
+void DeinterleaveIQ32(const int32_t* in, void* const* out, int nrx, int nsamples)
+{
+	for (int index=0; index<nsamples; index++)
+	    for (int receiver=0; receiver < nrx; receiver++)
+	    {
+	        memcpy((int32_t *)out[receiver] + 2*index, in, 2 * sizeof(int32_t));	// I,Q as one move
+	        in += 2;
+	    }
+};
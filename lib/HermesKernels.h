@@ -0,0 +1,56 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2017 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// HermesKernels.h
+//
+// Sample conversion kernels used on the Rx hot path. Each kernel has a
+// portable _generic version; the plain name picks the fastest version
+// available on this host (VOLK when built with it).
+//
+// Version:  October 2026
+
+#ifndef HermesKernels_H
+#define HermesKernels_H
+
+#include <stdint.h>
+
+// EP4 wideband: 16-bit little-endian 2's complement ADC samples --> float
+// (-1.0 ... +1.0). in need not be aligned.
+
+void ConvertADC16_generic(const unsigned char* in, float* out, int nsamples);
+void ConvertADC16(const unsigned char* in, float* out, int nsamples);
+
+// The same samples unconverted, as host order int16_t (hermesWB short output).
+
+void CopyADC16(const unsigned char* in, int16_t* out, int nsamples);
+
+// NB ring slot --> gnuradio output ports. in holds nsamples rows of
+// nrx interleaved I,Q pairs; out[rx] is the gr_complex output of
+// receiver rx.
+
+void DeinterleaveIQ(const float* in, void* const* out, int nrx, int nsamples);
+
+// The same for integer slots (NBOutputSC16, NBOutputSC32): out[rx] holds
+// I,Q pairs of int16 or int32.
+
+void DeinterleaveIQ16(const int16_t* in, void* const* out, int nrx, int nsamples);
+void DeinterleaveIQ32(const int32_t* in, void* const* out, int nrx, int nsamples);
+
+#endif  // #ifndef HermesKernels_H
@@ -0,0 +1,212 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// HermesLog.cc
+//
+// Version:  October 2026
+
+#include "HermesLog.h"
+#include <gnuradio/logger.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <stdio.h>
+
+
+// Messages, by hermes_log_type. A and B are passed to every format.
+
+static const char* Format[LOG_TYPES] = {
+	"Metis Receive Thread: bytes_read = %d  (>1048)",
+	"Metis: bytes_read = %d (!= 1032)",
+	"unexpected EP %d length=%d",
+	"unexpected data packet when in discovery mode",
+	"unexpected discovery response when not in discovery mode",
+	"unexpected packet type: 0x%02X",
+	"received bad header bytes on data port %02X,%02X" };
+
+
+// The ring. Multiple producers, one consumer (the drain thread). Slot
+// Ring[pos % LOGRINGSIZE] is free for lap pos / LOGRINGSIZE when its Seq
+// is 2*lap and holds a message for that lap when Seq is 2*lap+1, so the
+// zero initialised ring starts out empty.
+
+struct LogEntry
+{
+	std::atomic<unsigned> Seq;
+	int Type;
+	int A, B;
+};
+
+static LogEntry Ring[LOGRINGSIZE];
+static std::atomic<unsigned> Head(0);		// next slot to claim, producers
+static unsigned Tail = 0;			// next slot to read, drain thread
+
+static std::atomic<unsigned> Posted[LOG_TYPES];	// posts this window, per type
+static std::atomic<int> LastA[LOG_TYPES], LastB[LOG_TYPES];	// arguments of the last suppressed post
+static std::atomic<unsigned long> Lost(0);	// posts dropped because the ring was full
+
+static std::mutex Lock;				// guards Running and Thread
+static std::condition_variable Wake;
+static std::thread Thread;
+static bool Running = false;
+
+static gr::logger_ptr Logger, DebugLogger;
+
+
+void HermesLog::Post(hermes_log_type Type, int A, int B)
+{
+	if (Posted[Type].fetch_add(1, std::memory_order_relaxed) >= LOGBURST)
+	{
+	  LastA[Type].store(A, std::memory_order_relaxed);	// suppressed, counted only
+	  LastB[Type].store(B, std::memory_order_relaxed);
+	  return;
+	}
+
+	unsigned pos = Head.load(std::memory_order_relaxed);
+	for (;;)
+	{
+	  LogEntry & e = Ring[pos & (LOGRINGSIZE - 1)];
+	  unsigned empty = 2 * (pos / LOGRINGSIZE);
+	  int diff = (int)(e.Seq.load(std::memory_order_acquire) - empty);
+
+	  if (diff == 0)		// free for this lap, try to claim it
+	  {
+	    if (Head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+	    {
+	      e.Type = Type;
+	      e.A = A;
+	      e.B = B;
+	      e.Seq.store(empty + 1, std::memory_order_release);
+	      return;
+	    }
+	  }
+	  else if (diff < 0)		// still holds last lap's message, ring is full
+	  {
+	    Lost.fetch_add(1, std::memory_order_relaxed);
+	    return;
+	  }
+	  else				// another producer claimed it
+	    pos = Head.load(std::memory_order_relaxed);
+	}
+};
+
+
+static void Emit(const char* Line)
+{
+	GR_LOG_WARN(Logger, Line);
+}
+
+static void Drain()			// drain thread only
+{
+	char line[160];
+
+	for (;;)
+	{
+	  LogEntry & e = Ring[Tail & (LOGRINGSIZE - 1)];
+	  unsigned full = 2 * (Tail / LOGRINGSIZE) + 1;
+	  if (e.Seq.load(std::memory_order_acquire) != full)
+	    return;			// empty
+
+	  snprintf(line, sizeof(line), Format[e.Type], e.A, e.B);
+	  e.Seq.store(full + 1, std::memory_order_release);	// free for the next lap
+	  Tail++;
+	  Emit(line);
+	}
+}
+
+static void Summarise()			// end of a window, drain thread only
+{
+	char line[200];
+	int n;
+
+	for (int t=0; t<LOG_TYPES; t++)
+	{
+	  unsigned posted = Posted[t].exchange(0, std::memory_order_relaxed);
+	  if (posted <= LOGBURST)
+	    continue;
+
+	  n = snprintf(line, sizeof(line), Format[t], LastA[t].load(std::memory_order_relaxed),
+			LastB[t].load(std::memory_order_relaxed));
+	  if (n >= 0 && n < (int)sizeof(line))
+	    snprintf(line + n, sizeof(line) - n, " (repeated %u times)", posted - LOGBURST);
+	  Emit(line);
+	}
+
+	unsigned long lost = Lost.exchange(0, std::memory_order_relaxed);
+	if (lost != 0)
+	{
+	  snprintf(line, sizeof(line), "HermesLog: %lu messages lost, log ring full", lost);
+	  Emit(line);
+	}
+}
+
+static void Run()
+{
+	typedef std::chrono::steady_clock clock;
+
+	clock::time_point window = clock::now() +
+		std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(LOGWINDOWSECONDS));
+
+	std::unique_lock<std::mutex> lk(Lock);
+	while (Running)
+	{
+	  Wake.wait_for(lk, std::chrono::milliseconds(LOGPOLLMS), [] { return !Running; });
+
+	  lk.unlock();			// posting never takes the lock, but Stop() does
+	  Drain();
+	  if (clock::now() >= window)
+	  {
+	    Summarise();
+	    window = clock::now() +
+		std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(LOGWINDOWSECONDS));
+	  }
+	  lk.lock();
+	}
+
+	Drain();			// whatever arrived before Stop()
+	Summarise();
+}
+
+
+void HermesLog::Start()
+{
+	std::lock_guard<std::mutex> lk(Lock);
+	if (Running)
+	  return;
+
+	if (!Logger)
+	  gr::configure_default_loggers(Logger, DebugLogger, "hpsdr");
+
+	Running = true;
+	Thread = std::thread(Run);
+};
+
+void HermesLog::Stop()
+{
+	{
+	  std::lock_guard<std::mutex> lk(Lock);
+	  Running = false;
+	}
+	Wake.notify_all();
+	if (Thread.joinable())
+	  Thread.join();
+};
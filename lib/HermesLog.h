@@ -0,0 +1,67 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// HermesLog.h
+//
+// Warnings from the receive and transmit paths, without terminal I/O on
+// those threads. Post() stores the message type and up to two integer
+// arguments in a lock free ring; a background thread drains the ring
+// every LOGPOLLMS, formats the messages and hands them to the GNU Radio
+// logger.
+//
+// Each message type may post LOGBURST messages per LOGWINDOWSECONDS. The
+// rest are only counted, and at the end of the window the drain thread
+// logs the last of them once with "(repeated N times)". A misconfigured
+// network then costs the Rx thread a few atomic operations per packet
+// instead of a write to stderr.
+//
+// Version:  October 2026
+
+#ifndef HermesLog_H
+#define HermesLog_H
+
+#define LOGRINGSIZE	256		// messages in flight, integral power of 2
+#define LOGBURST	3		// messages per type per window before suppression
+#define LOGWINDOWSECONDS 5.0		// suppression window
+#define LOGPOLLMS	100		// drain thread poll period
+
+enum hermes_log_type {
+	LOG_RX_OVERSIZE,		// datagram longer than a Metis frame
+	LOG_RX_LENGTH,			// EP6 frame not 1032 bytes
+	LOG_RX_ENDPOINT,		// data frame for an endpoint we do not handle
+	LOG_RX_DATA_DISCOVERING,	// data frame while discovering
+	LOG_RX_DISCOVERY_REPLY,		// discovery reply while not discovering
+	LOG_RX_PACKET_TYPE,		// unknown Metis packet type
+	LOG_RX_HEADER,			// no EF FE header
+	LOG_TYPES
+};
+
+class HermesLog
+{
+
+public:
+
+	static void Post(hermes_log_type Type, int A = 0, int B = 0);	// any thread, lock free
+	static void Start();		// start the drain thread, if not running
+	static void Stop();		// drain, log pending repeat counts, stop the thread
+
+};
+
+#endif  // #ifndef HermesLog_H
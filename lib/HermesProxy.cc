@@ -48,13 +48,28 @@
 //	     but do not know of any hardware that yet supports 8. The
 //	     constructor is getting unwieldy, but XML contrains what can
 //	     be passed from GRC to the constructor to simple types.
+//	     * October 2026 - control registers, Tx queue, Rx ring and
+//	     statistics moved to HermesCore, shared with HermesProxyW.
+//	     * October 2026 - Tx schedule vectors for 8 receivers (the
+//	     scheduler indexed past the table when NumRx was 8).
+//	     * October 2026 - the Rx thread only latches the status
+//	     registers; power, SWR and Verbose printing moved to the
+//	     telemetry thread (HermesTelemetry).
+//	     * October 2026 - USDT tracepoints (HermesTrace.h).
+//	     * October 2026 - OutputType: the Rx ring can hold sc16 or sc32
+//	     samples, half or the same bytes as floats, unpacked straight
+//	     from the 24 bit samples.
+//	     * October 2026 - LevelPeriod: power, peak and DC of each receiver
+//	     summed in the unpack loop, with optional DC removal.
 //
 
 #include <gnuradio/io_signature.h>
 #include "HermesProxy.h"
 #include "metis.h"
+#include "HermesTrace.h"
 #include <stdio.h>
 #include <cstring>
+#include <math.h>
 
 #include <algorithm>
 #include <list>
@@ -64,7 +79,7 @@
 // These involve non-integer ratios, so the queue events are spread relatively
 //   evenly while fitting in the exact number of events.
 
-std::vector<int> * schedulevector[20];
+std::vector<int> * schedulevector[24];
 
 //  Three receivers - 25 Tx queue events per set of 63, 126, 252, 504  received frames
 std::vector<int> L3_48 = {  0, 3, 5, 8, 10, 13, 15, 18, 20, 23, 25, 28, 30,
@@ -104,6 +119,12 @@ std::vector<int> L7_96 = { 12, 24, 34, 46, 58, 68, 80, 90, 102, 114, 124  }; //
 std::vector<int> L7_192 = { 24, 48, 68, 92, 116, 136, 160, 180, 204, 228, 248  };  // 11 frames per 252
 std::vector<int> L7_384 = { 48, 96, 136, 184, 232, 272, 320, 360, 408, 456, 496  };  // 11 frames per 504
 
+//  Eight receivers - 10 Tx queue events per set of 63, 126, 252, 504  received frames
+std::vector<int> L8_48 = { 6, 13, 19, 25, 31, 38, 44, 50, 57, 62  }; // 10 frames per 63
+std::vector<int> L8_96 = { 12, 26, 38, 50, 62, 76, 88, 100, 114, 124  }; // 10 frames per 126
+std::vector<int> L8_192 = { 24, 52, 76, 100, 124, 152, 176, 200, 228, 248  };  // 10 frames per 252
+std::vector<int> L8_384 = { 48, 104, 152, 200, 248, 304, 352, 400, 456, 496  };  // 10 frames per 504
+
 
 
 
@@ -115,6 +136,7 @@ HermesProxy::HermesProxy(int RxFreq0, int RxFreq1, int RxFreq2, int RxFreq3,
 			 const char * ClkS, int AlexRA, int AlexTA,
 			 int AlexHPF, int AlexLPF, int Verb, int NumRx,
 			 const char* MACAddr)	// constructor
+	: HermesCore(RxPre, Intfc, ClkS, AlexRA, AlexTA, AlexHPF, AlexLPF, Verb, MACAddr)
 {
 
 	schedulevector[0] = &L3_48;		// Build the array of schedule vector pointers
@@ -137,49 +159,15 @@ HermesProxy::HermesProxy(int RxFreq0, int RxFreq1, int RxFreq2, int RxFreq3,
 	schedulevector[17] = &L7_96;
 	schedulevector[18] = &L7_192;
 	schedulevector[19] = &L7_384;
-
-
-	//pthread_mutex_init (&mutexRPG, NULL);
-	//pthread_mutex_init (&mutexGPT, NULL);
-	//
-	// Notes in case needed...
-	//
-	//  pthread_mutex_lock(&mutex) - acquire a lock on the specified mutex variable. If the
-	// mutex is already locked by another thread, this call will block the calling thread
-	// until the mutex is unlocked.
-
-	//  pthread_mutex_unlock(&mutex) - unlock a mutex variable. An error is returned if mutex
-	// is already unlocked or owned by another thread.
-
-	//  pthread_mutex_trylock(&mutex) - attempt to lock a mutex or will return error code if
-	// busy. Useful for preventing deadlock conditions. RETURN VALUES
-	// On success, pthread_mutex_trylock() returns 0. On error, one of the following
-	// values is returned:
-	//	EBUSY    The mutex is already locked.
-	//	EINVAL   mutex is not an initialized mutex.
-	//	EFAULT   mutex is an invalid pointer.
+	schedulevector[20] = &L8_48;
+	schedulevector[21] = &L8_96;
+	schedulevector[22] = &L8_192;
+	schedulevector[23] = &L8_384;
 
 
 	RxSampleRate = RxSmp;
-	strcpy(interface, Intfc);	// Ethernet interface to use (defaults to eth0)
 	NumReceivers = NumRx;
 
-	unsigned int cs;		// Convert ClockSource strings to unsigned, then intitalize
-	sscanf(ClkS, "%x", &cs);
-	ClockSource = (cs & 0xFC);
-
-//	Initialize the Alex control registers.
-
-	AlexRxAnt = AlexRA;		// Select Alex Receive Antenna or from T/R relay
-	AlexTxAnt = AlexTA;		// Select Alex Tx Antenna
-	AlexRxHPF = AlexHPF;		// Select Alex Receive High Pass Filter
-	AlexTxLPF = AlexLPF;		// Select Alex Transmit Low Pass Filter
-
-	Verbose = Verb;			// Turn Verbose mode on/off
-
-        for (int i=0; i<18; i++)
-	  mactarget[i] = toupper(MACAddr[i]);	// Copy the requested MAC target address
-
 	Receive0Frequency = (unsigned)RxFreq0;
 	Receive1Frequency = (unsigned)RxFreq1; 
 	Receive2Frequency = (unsigned)RxFreq2; 	
@@ -192,57 +180,19 @@ HermesProxy::HermesProxy(int RxFreq0, int RxFreq1, int RxFreq2, int RxFreq3,
 	TransmitFrequency = (unsigned)TxFreq;		// initialize frequencies
 	TxDrive = TxDr;		// default to (almost) off
 	PTTMode = PTTModeSel;
-	RxPreamp = (bool)RxPre;
 	PTTOffMutesTx = (bool)PTTTxMute;   // PTT Off mutes the transmitter
 	PTTOnMutesRx = (bool)PTTRxMute;	// PTT On mutes receiver
 
-	ADCdither = false;
-	ADCrandom = false;
-	RxAtten = 0;		// Hermes V2.0
-	Duplex = true;		// Allows TxF to program separately from RxF
-
-	TxStop = false;
-
-	RxWriteCounter = 0;	//
-	RxReadCounter = 0;	// These control the Rx buffers to Gnuradio
-	RxWriteFill = 0;	//
-
-	TxWriteCounter = 0;	//
- 	TxReadCounter = 0;	// These control the Tx buffers to Hermes
-	TxControlCycler = 0;	//
-	TxFrameIdleCount = 0;	//
-
-	LostRxBufCount = 0;	//
-	TotalRxBufCount = 0;	//
-	LostTxBufCount = 0;	//
-	TotalTxBufCount = 0;	// diagnostics
-	CorruptRxCount = 0;	//
-	LostEthernetRx = 0;	//
-	CurrentEthSeqNum = 0;	//
-
-	
-	TxHoldOff = 0;		// initialize transmit hold off counter
-
-
-	try
-	{
-	    // allocate the receiver buffers
-	    for(int i=0; i<NUMRXIQBUFS; i++)
-		RxIQBuf[i] = new float[RXBUFSIZE];
-
-	    // allocate the transmit buffers
-	    for(int i=0; i<NUMTXBUFS; i++)
-		TxBuf[i] = new unsigned char[TXBUFSIZE];
-	}
-	catch(std::bad_alloc& ba)
-	{
-	   fprintf(stderr, "\nFATAL: unable to allocate memory for buffers.\n %s\n", ba.what());
-	   throw;
-	}
-
-
-	metis_discover((const char *)(interface));
-
+	OutputType = NBOutputFC32;
+	SC16Shift = 8;			// top 16 of the 24 bits
+	SC16Round = true;
+	LevelPeriod = 0.0;
+	DCRemove = false;
+	memset(Level, 0, sizeof(Level));
+	memset(DC, 0, sizeof(DC));
+	for (int rx=0; rx<MAXRECEIVERS; rx++)
+	  LevelOut[rx] = gr::hpsdr::hermes_level();
+	LevelSeq = 0;
 
 	USBRowCount[0] = 63;  // Number of Rows of samples per Rx Input 
 	USBRowCount[1] = 36;  // USB frame based on number of receivers 1..8
@@ -253,70 +203,15 @@ HermesProxy::HermesProxy(int RxFreq0, int RxFreq1, int RxFreq2, int RxFreq3,
 	USBRowCount[6] = 11;
 	USBRowCount[7] = 10;  // Eight receivers
 
-
-//
-// If there is no specified MAC address (i.e. wildcard, or anything less than 17 
-// characters, then just grab the first Hermes/Metis that
-// responds to discovery. If there is a specific MAC address specified, then wait
-// until it appears in the Metis cards table, and set the metis table index to match.
-// The string is HH:HH:HH:HH:HH:HH\0 formated, where HH is a 2-digital Hexidecimal number
-// uppercase, example:    04:7F:3D:0F:28:5A
-//
-
-	metis_entry = 0;
-	if (strlen(mactarget) != 17)			// Not a fully-qualified MAC address, default to first MAC found
-	{
-	  while (metis_found() == 0)
-		;					// wait until Hermes responds with first discovered MAC
-	}
-	else						// Search the table for the entry matching requested MAC address
-	{
-	  bool found = false;
-	  while(!found)					// Search for MAC address in the metis_table until the cows come home
-	    for(int i=0; i<metis_found(); i++)
-	      {
-		if (strcmp(mactarget, metis_mac_address(i)) == 0)	// Exact match found
-		{
-		  metis_entry = i;					// Select entry in metis_table
-	          found = true;
-		  break;
-		}
-	      }
-	}
-
-	metis_receive_stream_control(RxStream_Off, metis_entry);	// turn off Hermes -> PC streams
-
-	UpdateHermes();					// send specific control registers
-							// and initialize 1st Tx buffer
-							// before allowing scheduler to Start
+	AttachHermes();			// discover Hermes, send initial control registers
 };
 
 HermesProxy::~HermesProxy()
 {
-	fprintf(stderr, "\nLostRxBufCount = %lu  TotalRxBufCount = %lu"
-		"  LostTxBufCount = %lu  TotalTxBufCount = %lu"
-		"  CorruptRxCount = %lu  LostEthernetRx = %lu\n",
-	        LostRxBufCount, TotalRxBufCount, LostTxBufCount,
-		TotalTxBufCount, CorruptRxCount, LostEthernetRx);
-
-	metis_receive_stream_control(RxStream_Off, metis_entry);	// stop Hermes data stream
-	
-	metis_stop_receive_thread();	// stop receive_thread & close socket
-
-	for(int i=0; i<NUMTXBUFS; i++)
-		delete [] TxBuf[i];
-
-	for(int i=0; i<NUMRXIQBUFS; i++)
-		delete [] RxIQBuf[i];
+	// statistics, stream shutdown and buffers are handled by ~HermesCore()
 }
 
 
-void HermesProxy::Stop()	// stop ethernet I/O
-{
-	metis_receive_stream_control(RxStream_Off, metis_entry);	// stop Hermes Rx data stream
-	TxStop = true;					// stop Tx data to Hermes
-};
-
 void HermesProxy::Start()	// start rx stream
 {
 	TxStop = false;					// allow Tx data to Hermes
@@ -324,53 +219,17 @@ void HermesProxy::Start()	// start rx stream
 	TxHoldOff = true;				// Hold off buffers before bursting Tx
 };
 
-void HermesProxy::PrintRawBuf(RawBuf_t inbuf)	// for debugging
-{
-
-	fprintf(stderr, "Addr: %p    Dump of Raw Buffer\n", inbuf);
-	for(int row=0; row<4; row++)
-	{
-	    int addr = row * 16;
-	    fprintf(stderr, "%04X:  ", addr);
-	    for(int column=0; column<8; column++)
-	    	fprintf(stderr, "%02X:", inbuf[row*16+column]);
-	    fprintf(stderr, "...");
-	    for(int column=8; column<16; column++)
-	    	fprintf(stderr, "%02X:", inbuf[row*16+column]);
-	    fprintf(stderr, "\n");
-	}
-
-	fprintf(stderr, "\n");
-
-};
-
 // ********** Routines to receive data from Hermes/Metis and give to Gnuradio ****************
 
-void HermesProxy::ReceiveRxIQ(unsigned char * inbuf)	// called by metis Rx thread.
+void HermesProxy::ReceiveRxIQ(unsigned char * inbuf, uint64_t Arrival)	// called by metis Rx thread.
 {
 
+	uint64_t Unpack = RxUnpackStart(Arrival);	// latency: socket to here, here to RxCommit()
+
 	// look for lost receive packets based on skips in the HPSDR ethernet header
 	// sequence number.
 
-
-//PrintRawBuf(inbuf);	// include Ethernet header
-
-	unsigned int SequenceNum = (unsigned char)(inbuf[4]) << 24;
-	SequenceNum += (unsigned char)(inbuf[5]) << 16;
-	SequenceNum += (unsigned char)(inbuf[6]) << 8;
-	SequenceNum += (unsigned char)(inbuf[7]);
-
-	if(SequenceNum > CurrentEthSeqNum + 1)
-	{
-	    LostEthernetRx += (SequenceNum - CurrentEthSeqNum);
-	    CurrentEthSeqNum = SequenceNum;
-	}
-	else
-	{
-	  if(SequenceNum == CurrentEthSeqNum + 1)
-	    CurrentEthSeqNum++;
-	}
-	
+	TrackRxSequence(inbuf);
 
 	// Metis Rx thread gives us collection of samples including the Ethernet header
 	// plus 2 x HPSDR USB frames.
@@ -392,9 +251,8 @@ void HermesProxy::ReceiveRxIQ(unsigned char * inbuf)	// called by metis Rx threa
 	// Each input Ethernet frame contains a different number of I + Q samples as 2's
 	// complement depending on the number of receivers.
 	//
- 	//    RxWriteCounter - the current Rx buffer we are writing to
-	//    RxWriteFill    - #floats we have written to the current Rx buffer (0..255)
-	//    RxReadCounter  - the Rx buffer that gnuradio can read
+ 	//    RxWriteSlot()  - the current Rx buffer we are writing to
+	//    RxCommit()     - hands it to gnuradio, which picks it up with RxReadSlot()
 	//
 
 
@@ -402,9 +260,9 @@ void HermesProxy::ReceiveRxIQ(unsigned char * inbuf)	// called by metis Rx threa
 
 	IQBuf_t outbuf;			// RxWrite output buffer selector
 	
-	TotalRxBufCount++;
+	Count(TotalRxBufCount);
 
-	ScheduleTxFrame(TotalRxBufCount); // Schedule a Tx ethernet frame to Hermes if ready.
+	ScheduleTxFrame(TotalRxBufCount.load(std::memory_order_relaxed)); // Schedule a Tx ethernet frame to Hermes if ready.
 
 	// Need to check for both 1st and 2nd USB frames for the status registers.
 	// Some status come in only in the first, and some only in the second.
@@ -417,87 +275,19 @@ void HermesProxy::ReceiveRxIQ(unsigned char * inbuf)	// called by metis Rx threa
 		unsigned char s0 = inbuf[0+USBFrameOffset];	// sync register 0
 		unsigned char s1 = inbuf[1+USBFrameOffset];	// sync register 0
 		unsigned char s2 = inbuf[2+USBFrameOffset];	// sync register 0
-		unsigned char c0 = inbuf[3+USBFrameOffset];	// control register 0
-		unsigned char c1 = inbuf[4+USBFrameOffset];	// control register 1
-		unsigned char c2 = inbuf[5+USBFrameOffset];	// control register 2
-		unsigned char c3 = inbuf[6+USBFrameOffset];	// control register 3
-		unsigned char c4 = inbuf[7+USBFrameOffset];	// control register 4
 
 		if(s0 == 0x7f && s1 == 0x7f && s2 == 0x7f)
 		{
-			if((c0 & 0xf8) == 0x00) // Overflow and Version
-			{
-//			  fprintf(stderr, "Reg:0x00   c0:0x%x c1:0x%x c2:0x%x c3:0x%u c4:0x%x\n", c0, c1, c2, c3, c4);
-
-			  if(c1 & 0x01)
-			    ADCoverload = true;
-			  else
-			    ADCoverload = false;
-
-			  HermesVersion = c4;
-			}
-
-			if((c0 & 0xf8) == 0x08)  //AIN5 and AIN1
-			{
-//			  fprintf(stderr, "Reg:0x08   c0:0x%x c1:0x%x c2:0x%x c3:0x%u c4:0x%x\n", c0, c1, c2, c3, c4);
-			  AIN5 = (unsigned int)c1 * 256 + (unsigned int)c2;
-			  AIN1 = (unsigned int)c3 * 256 + (unsigned int)c4;
-			}
-
-			if((c0 & 0xf8) == 0x10)  //AIN2 and AIN3
-			{
-//			  fprintf(stderr, "Reg:0x10   c0:0x%x c1:0x%x c2:0x%x c3:0x%u c4:0x%x\n", c0, c1, c2, c3, c4);
-			  AIN2 = (unsigned int)c1 * 256 + (unsigned int)c2;
-			  AIN3 = (unsigned int)c3 * 256 + (unsigned int)c4;
-
-			}
-
-			if((c0 & 0xf8) == 0x18)  //AIN4 and AIN6
-			{
-//			  fprintf(stderr, "Reg:0x18   c0:0x%x c1:0x%x c2:0x%x c3:0x%u c4:0x%x\n", c0, c1, c2, c3, c4);
-			  AIN4 = (unsigned int)c1 * 256 + (unsigned int)c2;
-			  AIN6 = (unsigned int)c3 * 256 + (unsigned int)c4;
-			}
-
-			if (Verbose)
-			{
-			  SlowCount++;
-			  if ((SlowCount & 0x1ff) == 0x1ff)
-			  {
-				float FwdPwr = (float)AIN1 * (float)AIN1 / 145000.0;
-				float RevPwr = (float)AIN2 * (float)AIN2 / 145000.0;
-
-				// calculate SWR
-				double SWR =  0.0;
-				try
-				{
-					SWR = (1+sqrt(RevPwr/FwdPwr))/(1-sqrt(RevPwr/FwdPwr));
-					if(false == std::isnormal(SWR))
-					{
-						throw 0;
-					}
-				}
-				catch(int& e)
-				{
-					// there was an anomaly in the SWR calculation, make it obvious ...
-					SWR =  99.9;
-				}
-
-				fprintf(stderr, "AlexFwdPwr = %4.1f  AlexRevPwr = %4.1f   ", FwdPwr, RevPwr);
-				// report SWR if forward power is non-zero
-				if(static_cast<int>(FwdPwr) != 0)
-				{
-					fprintf(stderr, "SWR = %.2f:1   ", SWR);
-				}
-				fprintf(stderr, "ADCOver: %u  HermesVersion: %d (dec)  %X (hex)\n", ADCoverload, HermesVersion, HermesVersion);
-				//fprintf(stderr, "AIN1:%u  AIN2:%u  AIN3:%u  AIN4:%u  AIN5:%u  AIN6:%u\n", AIN1, AIN2, AIN3, AIN4, AIN5, AIN6);  
-				}
-			}
+			// Status banks 0x00 (ADC overload, version), 0x08 (AIN5, AIN1),
+			// 0x10 (AIN2, AIN3) and 0x18 (AIN4, AIN6) are only latched here.
+			// The telemetry thread decodes them and does the Verbose printing.
+
+			LatchStatus(inbuf+3+USBFrameOffset);	// control registers C0..C4
 		} //endif sync is valid
 		
 		else
 		{
-			CorruptRxCount++;
+			Count(CorruptRxCount);
 //			fprintf(stderr, "HermesProxy: EP6 received from Hermes failed sync header check.\n");
 //			int delta = inbuf - inbufptr;
 //			fprintf(stderr, "USBFrameOffset: %i  inbufptr: %p  delta: %i \n", USBFrameOffset, inbufptr, delta);
@@ -575,12 +365,30 @@ void HermesProxy::ReceiveRxIQ(unsigned char * inbuf)	// called by metis Rx threa
 	{
 	    inbufindex = inbuf + USBFrameOffset;  // inbuf already pointing past Ethernet frame header
 
-	    if ((outbuf = GetNextRxBuf()) == NULL)
-	        return;				// all buffers full. Throw away data
+	    if ((outbuf = RxWriteSlot()) == NULL)
+	    {
+	        Count(LostRxBufCount);		// all buffers full. Throw away data
+	        HPSDR_TRACE1(rx_drop, LostRxBufCount.load(std::memory_order_relaxed));
+	        return;
+	    }
 
 	    outindex = 0;
 
 	    // one USB frame
+	    if (LevelPeriod > 0.0)		// the same, measuring as it goes
+	    {
+	      if (OutputType == NBOutputSC16)
+	        UnpackLevel<NBOutputSC16>(inbufindex, outbuf);
+	      else if (OutputType == NBOutputSC32)
+	        UnpackLevel<NBOutputSC32>(inbufindex, outbuf);
+	      else
+	        UnpackLevel<NBOutputFC32>(inbufindex, outbuf);
+	    }
+	    else if (OutputType == NBOutputSC16)
+	      UnpackSC16(inbufindex, (int16_t*)outbuf);
+	    else if (OutputType == NBOutputSC32)
+	      UnpackSC32(inbufindex, (int32_t*)outbuf);
+	    else
 	    for (int row=0; row < USBRowCount[NumReceivers - 1]; row++)
 	    {
 	        for (int receiver=0; receiver < NumReceivers; receiver++)
@@ -592,11 +400,24 @@ void HermesProxy::ReceiveRxIQ(unsigned char * inbuf)	// called by metis Rx threa
 	        };
 	        inbufindex +=2;			// skip microphone samples in the row
 	    };
+
+	    RxCommit(Arrival, Unpack);		// hand the buffer to gnuradio
 	};
 
 	return;			// normal return;
 };
 
+// Hermes paces EP6 with its sample clock: each Ethernet frame carries two
+// USB frames of USBRowCount samples per receiver.
+
+double HermesProxy::RxFramePeriod()
+{
+	if (RxSampleRate <= 0 || NumReceivers < 1 || NumReceivers > MAXRECEIVERS)
+	  return 0.0;
+
+	return 2.0 * USBRowCount[NumReceivers - 1] / RxSampleRate;
+};
+
 // Unpack an unsigned 2's complement sample into a floating point number
 // maximum value of +1.0 and minimum of -1.0
 float HermesProxy::Unpack2C(const unsigned char* inptr)
@@ -617,53 +438,183 @@ float HermesProxy::Unpack2C(const unsigned char* inptr)
 	return (float)F/8388607.0;
 };
 
-//
-// July 2017 change...
-// Previously, this checked the fill level of the current buffer.
-// New code always needs a new output buffer when called - simplify logic to just check
-// to see if one is available and return it, else return NULL if none available (and
-// increment lost Rx buffer counter).
-//
+// Integer versions of the USB frame loop above, same slot layout. The 24
+// bit samples are sign extended by shifting them to the top of an int32.
 
+static inline int32_t Sample24(const unsigned char* p)
+{
+	return (int32_t)(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8)) >> 8;
+}
 
-// New version
-IQBuf_t HermesProxy::GetNextRxBuf() // get next Writeable Rx buffer
+void HermesProxy::UnpackSC16(const unsigned char* inbufindex, int16_t* out)
 {
-  if (((RxWriteCounter+1) & (NUMRXIQBUFS - 1)) == RxReadCounter)
-  {
-    LostRxBufCount++;	// No Rx Buffers available. Throw away the data
-    return NULL;
-  }
-  else
-  {
-    ++RxWriteCounter &= (NUMRXIQBUFS - 1); // get next writeable buffer
-    return RxIQBuf[RxWriteCounter];
-  }
+	int rows = USBRowCount[NumReceivers - 1];
+	if ((PTTOnMutesRx) & (PTTMode == PTTOn))	// receiver is muted
+	{
+	  memset(out, 0, rows * NumReceivers * 2 * sizeof(int16_t));
+	  return;
+	}
+
+	int shift = (SC16Shift < 0) ? 0 : (SC16Shift > 8) ? 8 : SC16Shift;
+	int32_t half = (SC16Round && shift > 0) ? (1 << (shift - 1)) : 0;
+
+	for (int row=0; row < rows; row++)
+	{
+	    for (int n=0; n < 2 * NumReceivers; n++)	// I, Q of each receiver
+	    {
+		int32_t v = (Sample24(inbufindex) + half) >> shift;
+		*out++ = (int16_t)(v > 32767 ? 32767 : v < -32768 ? -32768 : v);
+		inbufindex += 3;
+	    };
+	    inbufindex +=2;			// skip microphone samples in the row
+	};
+};
+
+void HermesProxy::UnpackSC32(const unsigned char* inbufindex, int32_t* out)
+{
+	int rows = USBRowCount[NumReceivers - 1];
+	bool mute = (PTTOnMutesRx) & (PTTMode == PTTOn);
+
+	for (int row=0; row < rows; row++)
+	{
+	    for (int n=0; n < 2 * NumReceivers; n++)	// I, Q of each receiver
+	    {
+		*out++ = mute ? 0 : Sample24(inbufindex);
+		inbufindex += 3;
+	    };
+	    inbufindex +=2;			// skip microphone samples in the row
+	};
 };
 
+// Any of the above plus the receiver levels, in the one pass over the
+// frame. Sums of a USB frame are kept in integers (63 rows of 2^48 at
+// most) and added to the window in double. With DCRemove, each
+// receiver's mean I and Q of the last window are subtracted first.
 
-IQBuf_t HermesProxy::GetRxIQ()	// next Readable Rx buffer, called by HermesNB to pickup any RxIQ
+template <int Type>
+void HermesProxy::UnpackLevel(const unsigned char* inbufindex, void* outbuf)
 {
+	int rows = USBRowCount[NumReceivers - 1];
+	int nrx = NumReceivers;
+
+	if ((PTTOnMutesRx) & (PTTMode == PTTOn))	// receiver is muted: no samples, no level
+	{
+	  size_t bytes = (Type == NBOutputSC16) ? 2 * sizeof(int16_t) : 2 * sizeof(float);
+	  memset(outbuf, 0, rows * nrx * bytes);
+	  return;
+	}
 
-	//int status = pthread_mutex_trylock(&mutexRPG);	// Don't block gnuradio scheduler
-	//  if(status != 0)
-	//    return NULL;		// return 'no buffers' if can't acquire the mutex
+	int shift = (SC16Shift < 0) ? 0 : (SC16Shift > 8) ? 8 : SC16Shift;
+	int32_t half = (SC16Round && shift > 0) ? (1 << (shift - 1)) : 0;
 
-	if(RxReadCounter == RxWriteCounter)
+	int64_t si[MAXRECEIVERS], sq[MAXRECEIVERS], sp[MAXRECEIVERS], pk[MAXRECEIVERS];
+	for (int rx=0; rx < nrx; rx++)
+	  si[rx] = sq[rx] = sp[rx] = pk[rx] = 0;
+
+	float* outf = (float*)outbuf;
+	int16_t* out16 = (int16_t*)outbuf;
+	int32_t* out32 = (int32_t*)outbuf;
+
+	for (int row=0; row < rows; row++)
 	{
-	  //pthread_mutex_unlock(&mutexRPG);
-	  return NULL;				// empty - no buffers to return
+	    for (int rx=0; rx < nrx; rx++)
+	    {
+		int32_t I = Sample24(inbufindex) - DC[rx][0];
+		int32_t Q = Sample24(inbufindex + 3) - DC[rx][1];
+		inbufindex += 6;
 
+		int64_t p = (int64_t)I * I + (int64_t)Q * Q;
+		si[rx] += I;
+		sq[rx] += Q;
+		sp[rx] += p;
+		pk[rx] = std::max(pk[rx], p);
+
+		if (Type == NBOutputSC16)
+		{
+		  int32_t i = (I + half) >> shift, q = (Q + half) >> shift;
+		  *out16++ = (int16_t)(i > 32767 ? 32767 : i < -32768 ? -32768 : i);
+		  *out16++ = (int16_t)(q > 32767 ? 32767 : q < -32768 ? -32768 : q);
+		}
+		else if (Type == NBOutputSC32)
+		{
+		  *out32++ = I;
+		  *out32++ = Q;
+		}
+		else
+		{
+		  *outf++ = (float)(I / 8388607.0);	// as Unpack2C()
+		  *outf++ = (float)(Q / 8388607.0);
+		}
+	    };
+	    inbufindex +=2;			// skip microphone samples in the row
+	};
+
+	for (int rx=0; rx < nrx; rx++)
+	{
+	  LevelSums & l = Level[rx];
+	  l.SumI += si[rx];
+	  l.SumQ += sq[rx];
+	  l.SumP += sp[rx];
+	  l.PeakP = std::max(l.PeakP, pk[rx]);
+	  l.Samples += rows;
 	}
 
-	IQBuf_t ReturnBuffer = RxIQBuf[RxReadCounter];	// get the next receiver buffer
-	++RxReadCounter &= (NUMRXIQBUFS - 1);		// increment read counter modulo
+	if (Level[0].Samples >= LevelPeriod * RxSampleRate)
+	  EndLevelWindow();
+};
 
-	//pthread_mutex_unlock(&mutexRPG);
+void HermesProxy::EndLevelWindow()	// Rx thread
+{
+	const double fs = 8388607.0;		// full scale
+	gr::hpsdr::hermes_level out[MAXRECEIVERS];
+	unsigned long n = (LevelSeq.load(std::memory_order_relaxed) >> 1) + 1;
 
-	return ReturnBuffer;			// next readable Rx buffer
+	for (int rx=0; rx < NumReceivers; rx++)
+	{
+	  LevelSums & l = Level[rx];
+	  double samples = (double)l.Samples;
+	  double dci = l.SumI / samples + DC[rx][0];	// of the input, before removal
+	  double dcq = l.SumQ / samples + DC[rx][1];
+
+	  out[rx].windows = n;
+	  out[rx].samples = l.Samples;
+	  out[rx].power_dbfs = 10.0 * log10(l.SumP / samples / (fs * fs) + 1e-20);
+	  out[rx].peak_dbfs = 10.0 * log10(l.PeakP / (fs * fs) + 1e-20);
+	  out[rx].dc_i = dci / fs;
+	  out[rx].dc_q = dcq / fs;
+
+	  if (DCRemove)
+	  {
+	    DC[rx][0] = (int32_t)lrint(dci);
+	    DC[rx][1] = (int32_t)lrint(dcq);
+	  }
+	  memset(&l, 0, sizeof(l));
+	}
+
+	// The Rx thread never waits: readers retry if they overlap the copy.
+	LevelSeq.store(2 * n - 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	for (int rx=0; rx < NumReceivers; rx++)
+	  LevelOut[rx] = out[rx];
+	LevelSeq.store(2 * n, std::memory_order_release);
 };
 
+void HermesProxy::GetLevel(int Rx, gr::hpsdr::hermes_level & l)
+{
+	if (Rx < 0 || Rx >= MAXRECEIVERS)
+	{
+	  l = gr::hpsdr::hermes_level();
+	  return;
+	}
+
+	unsigned long seq;
+	do
+	{
+	  seq = LevelSeq.load(std::memory_order_acquire);
+	  l = LevelOut[Rx];
+	  std::atomic_thread_fence(std::memory_order_acquire);
+	} while ((seq & 1) || LevelSeq.load(std::memory_order_relaxed) != seq);
+};
 
 // ************  Routines to send data from gnuradio to the transmitter ***************
 
@@ -808,13 +759,13 @@ void HermesProxy::ScheduleTxFrame(unsigned long RxBufCount) // Transmit one ethe
 //	// Compute a selector to decide which scheduler vector to use
 
 		int FrameIndex;
-		int RxNumIndex = NumReceivers-3;	  //   3,  4,  5,  6,  7  -->  0, 1, 2, 3, 4
+		int RxNumIndex = NumReceivers-3;	  //   3,  4,  5,  6,  7,  8  -->  0, 1, 2, 3, 4, 5
 
 		int SpeedIndex = (RxSampleRate) / 48000;  // 48k, 96k, 192k, 384k -->  1, 2, 4, 8
 		SpeedIndex = SpeedIndex >> 1;		  // 48k, 96k, 192k, 384k -->  0, 1, 2, 4
 		if (SpeedIndex == 4)  SpeedIndex = 3;	  // 48k, 96k, 192k, 384k -->  0, 1, 2, 3
 
-		int selector = RxNumIndex * 4 + SpeedIndex;	//  0 .. 19
+		int selector = RxNumIndex * 4 + SpeedIndex;	//  0 .. 23
 
 	// Compute the frame number within a vector
 
@@ -848,243 +799,6 @@ void HermesProxy::ScheduleTxFrame(unsigned long RxBufCount) // Transmit one ethe
 	return;
 };
 
-void HermesProxy::UpdateHermes()	// send a set of control registers to hardware with naught Tx data
-{
-
-	// Repurposed to send the initial registers to Hermes before starting the stream.
-	// Ought to rename this as InitializeHermes or something similar.
-
-	// DEBUG
-	//fprintf(stderr, "UpdateHermes called\n");
-
-	unsigned char buffer[512];	// dummy up a USB HPSDR buffer;
-	for(int i=0; i<512; i++)
-		buffer[i] = 0;
-
-	int length = 512;		// metis_write ignores this value
-	unsigned char ep = 0x02;	// all Hermes data is sent to end point 2
-
-	// metis_write needs to be called twice to make one ethernet write to the hardware
-	// Set these registers before starting the receive stream
-
-	BuildControlRegs(0, buffer);
-	metis_write(ep, buffer, length);
-	BuildControlRegs(2, buffer);
-	metis_write(ep, buffer, length);
-
-	BuildControlRegs(0, buffer);
-	metis_write(ep, buffer, length);
-	BuildControlRegs(4, buffer);
-	metis_write(ep, buffer, length);
-
-	BuildControlRegs(0, buffer);
-	metis_write(ep, buffer, length);
-	BuildControlRegs(6, buffer);
-	metis_write(ep, buffer, length);
-
-	// Initialize the first TxBuffer (currently empty) with a valid control frame (on startup only)
-	
-	BuildControlRegs(0, buffer);
-	RawBuf_t initial = TxBuf[0];
-	for(int i=0; i<512; i++)
-		initial[i] = buffer[i];
-
-	return;
-}
-
-
-void HermesProxy::BuildControlRegs(unsigned RegNum, RawBuf_t outbuf)
-{
-	// create the sync + control register values to send to Hermes
-	// base on RegNum and the various parameter values.
-	// RegNum must be even.
-
-	unsigned char Speed = 0;	// Rx sample rate
-	unsigned char RxCtrl = 0;	// Rx controls
-	unsigned char Ctrl4 = 0;	// Rx register C4 control
-
-	outbuf[0] = outbuf[1] = outbuf[2] = 0x7f;	// HPSDR USB sync
-
-	outbuf[3] = RegNum;		// C0 Control Register (Bank Sel + PTT)
-	if (PTTMode == PTTOn)
-	  outbuf[3] |= 0x01;				// set MOX bit
-
-	switch(RegNum)
-	{
-	  case 0:
-	    Speed = ClockSource;	// Set clock Source from user input
-	    if(RxSampleRate == 384000)
-		Speed |= 0x03;
-	    if(RxSampleRate == 192000)
-		Speed |= 0x02;
-	    if(RxSampleRate == 96000)
-		Speed |= 0x01;
-	    if(RxSampleRate == 48000)
-		Speed |= 0x00;
-
-	    RxCtrl = 0x00;
-	    if(RxPreamp)
-		RxCtrl |= 0x04;
-	    if(ADCdither)
-		RxCtrl |= 0x08;
-	    if(ADCrandom)
-		RxCtrl |= 0x10;
-
-
-	    Ctrl4 |= ((NumReceivers-1) << 3) & 0x38;	// Number of receivers
-							// V1.58 of protocol_1 spec allows
-							// setting up to 8 receivers, but
-							// I can't find which register to set the
-							// Rx Frequency of the 8th receiver.
-							// Hermes sends corrupted USB frames if
-							// NumReceivers > 4.   Theoretically
-							// Red Pitaya is OK to 6 (to be tested by
-							// someone else).
-
-
-	    if(Duplex)
-		Ctrl4 |= 0x04;
-
-	    outbuf[4] = Speed;				// C1
-	    outbuf[5] = 0x00;				// C2
-	    outbuf[6] = RxCtrl | AlexRxAnt;		// C3
-	    outbuf[7] = Ctrl4 | AlexTxAnt;		// C4 - #Rx, Duplex
-          break;
-
-	  case 2:					// Tx NCO freq (and Rx1 NCO for special case)
-	    outbuf[4] = ((unsigned char)(TransmitFrequency >> 24)) & 0xff;	// c1 RxFreq MSB
-	    outbuf[5] = ((unsigned char)(TransmitFrequency >> 16)) & 0xff;	// c2
-	    outbuf[6] = ((unsigned char)(TransmitFrequency >> 8)) & 0xff;	// c3
-	    outbuf[7] = ((unsigned char)(TransmitFrequency)) & 0xff;		// c4 RxFreq LSB
-          break;
-
-	  case 4:					// Rx1 NCO freq (out port 0)
-	    outbuf[4] = ((unsigned char)(Receive0Frequency >> 24)) & 0xff;	// c1 RxFreq MSB
-	    outbuf[5] = ((unsigned char)(Receive0Frequency >> 16)) & 0xff;	// c2
-	    outbuf[6] = ((unsigned char)(Receive0Frequency >> 8)) & 0xff;	// c3
-	    outbuf[7] = ((unsigned char)(Receive0Frequency)) & 0xff;	// c4 RxFreq LSB
-	  break;
-
-	  case 6:					// Rx2 NCO freq (out port 1)
-	    outbuf[4] = ((unsigned char)(Receive1Frequency >> 24)) & 0xff; // c1 RxFreq MSB
-	    outbuf[5] = ((unsigned char)(Receive1Frequency >> 16)) & 0xff; // c2
-	    outbuf[6] = ((unsigned char)(Receive1Frequency >> 8)) & 0xff;	 // c3
-	    outbuf[7] = ((unsigned char)(Receive1Frequency)) & 0xff;	 // c4 RxFreq LSB
-	  break;
-
-	  case 8:					// Rx3 NCO freq (out port 2)
-	    outbuf[4] = ((unsigned char)(Receive2Frequency >> 24)) & 0xff; // c1 RxFreq MSB
-	    outbuf[5] = ((unsigned char)(Receive2Frequency >> 16)) & 0xff; // c2
-	    outbuf[6] = ((unsigned char)(Receive2Frequency >> 8)) & 0xff;	 // c3
-	    outbuf[7] = ((unsigned char)(Receive2Frequency)) & 0xff;	 // c4 RxFreq LSB
-	  break;
-
-	  case 10:					// Rx4 NCO freq (out port 3)
-	    outbuf[4] = ((unsigned char)(Receive3Frequency >> 24)) & 0xff; // c1 RxFreq MSB
-	    outbuf[5] = ((unsigned char)(Receive3Frequency >> 16)) & 0xff; // c2
-	    outbuf[6] = ((unsigned char)(Receive3Frequency >> 8)) & 0xff;	 // c3
-	    outbuf[7] = ((unsigned char)(Receive3Frequency)) & 0xff;	 // c4 RxFreq LSB
-	  break;
-
-	  case 12:					// Rx5 NCO freq (out port 4)
-	    outbuf[4] = ((unsigned char)(Receive4Frequency >> 24)) & 0xff; // c1 RxFreq MSB
-	    outbuf[5] = ((unsigned char)(Receive4Frequency >> 16)) & 0xff; // c2
-	    outbuf[6] = ((unsigned char)(Receive4Frequency >> 8)) & 0xff;	 // c3
-	    outbuf[7] = ((unsigned char)(Receive4Frequency)) & 0xff;	 // c4 RxFreq LSB
-	  break;
-
-	  case 14:					// Rx6 NCO freq (out port 5)
-	    outbuf[4] = ((unsigned char)(Receive5Frequency >> 24)) & 0xff; // c1 RxFreq MSB
-	    outbuf[5] = ((unsigned char)(Receive5Frequency >> 16)) & 0xff; // c2
-	    outbuf[6] = ((unsigned char)(Receive5Frequency >> 8)) & 0xff;	 // c3
-	    outbuf[7] = ((unsigned char)(Receive5Frequency)) & 0xff;	 // c4 RxFreq LSB
-	  break;
-
-	  case 16:					// Rx7 NCO freq (out port 6)
-	    outbuf[4] = ((unsigned char)(Receive6Frequency >> 24)) & 0xff; // c1 RxFreq MSB
-	    outbuf[5] = ((unsigned char)(Receive6Frequency >> 16)) & 0xff; // c2
-	    outbuf[6] = ((unsigned char)(Receive6Frequency >> 8)) & 0xff;	 // c3
-	    outbuf[7] = ((unsigned char)(Receive6Frequency)) & 0xff;	 // c4 RxFreq LSB
-	  break;
-
-
-	//	Note:  While Ver 1.58 of the HPSDR USB protocol doucment specifies up to 8 receivers,
-	//	It only defines 7 receive frequency control register addresses. So we are currently
-	//	limited to 7 receivers implemented.
-
-
-	  case 18:					// drive level & filt select (if Alex)
-	    if (PTTOffMutesTx & (PTTMode == PTTOff))
-		outbuf[4] = 0;				// (almost) kill Tx when PTTOff and PTTControlsTx
-	    else
-		outbuf[4] = TxDrive;			// c1
-
-
-	    unsigned char RxHPF, TxLPF;
-
-	    RxHPF = AlexRxHPF;
-	    if (AlexRxHPF == 0)				// if Rx autotrack
-	    {
-		if (Receive0Frequency < 1500000)
-		  RxHPF = 0x20;				// bypass
-		else if (Receive0Frequency < 6500000)
-	          RxHPF = 0x10;				// 1.5 MHz HPF
-		else if (Receive0Frequency < 9500000)
-		  RxHPF = 0x08;				// 6.5 MHz HPF
-		else if (Receive0Frequency < 13000000)
-		  RxHPF = 0x04;				// 9.5 mHz HPF
-		else if (Receive0Frequency < 20000000)
-		  RxHPF = 0x01;				// 13 Mhz HPF
-		else if (Receive0Frequency < 50000000)
-		  RxHPF = 0x02;				// 20 MHz HPF
-		else RxHPF = 0x40;			// 6M BPF + LNA
-	    }
-
-	    TxLPF = AlexTxLPF;
-	    if (AlexTxLPF == 0)				// if Tx autotrack
-	    {
-		if (TransmitFrequency > 30000000)
-		  TxLPF = 0x10;				// 6m LPF
-		else if (TransmitFrequency > 19000000)
-		  TxLPF = 0x20;				// 10/12m LPF
-		else if (TransmitFrequency > 14900000)
-		  TxLPF = 0x40;				// 15/17m LPF
-		else if (TransmitFrequency > 9900000)
-		  TxLPF = 0x01;				// 30/20m LPF
-		else if (TransmitFrequency > 4900000)
-		  TxLPF = 0x02;				// 60/40m LPF
-		else if (TransmitFrequency > 3400000)
-		  TxLPF = 0x04;				// 80m LPF
-		else TxLPF = 0x08;			// 160m LPF
-	    }
-
-	    outbuf[5] = 0x40;				// c2 - Alex Manual filter control enabled
-	    outbuf[6] = RxHPF & 0x7f;			// c3 - Alex HPF filter selection
-	    outbuf[7] = TxLPF & 0x7f;			// c4 - Alex LPF filter selection
-	  break;
-
-	  case 20:					// Hermes input attenuator setting
-	    outbuf[4] = 0;				//
-	    outbuf[5] = 0x17;				// Not implemented yet, should not be called by
-	    outbuf[6] = 0;				// TxControlCycler yet.
-	    outbuf[7] = RxAtten;			// 0..31 db attenuator setting (same function as preamp)
-	  break;
-	
-	  case 22:
-	    outbuf[4] = 0;				// Register not documented, but zeroed by
-	    outbuf[5] = 0;				// PowerSDR...
-	    outbuf[6] = 0;				//
-	    outbuf[7] = 0;				//
-	  break;					
-
-	  default:
-	    fprintf(stderr, "Invalid Hermes/Metis register selection: %d\n", RegNum);
-	    break;
-	};
-
-};
-
-
 // hermesNB calls this routine to give IQ data from the block input connector to the proxy.
 // Packs transformed data into one HPSDR USB buffer with control registers.
 // HermesNB gives us 63 complex samples from in0, we fill one USB buffer with them.
@@ -1105,11 +819,8 @@ int HermesProxy::PutTxIQ(const gr_complex * in0, /*const gr_complex * in1,*/ int
 
 	// format a HPSDR USB frame to send to Hermes.
 
-	TxControlCycler += 2;		// advance to next register bank, modulo
-	if (TxControlCycler > 0x14)	// 11 register banks (0..10). Note: Bank 10
-	  TxControlCycler = 0;		//    (Hermes attenuator) requires firmware V2.0
-
-	BuildControlRegs(TxControlCycler, outbuf);	// First 8 bytes are the control registers.
+	BuildNextControlRegs(outbuf);	// First 8 bytes are the control registers.
+	HPSDR_TRACE2(tx_build, outbuf[3], TxBufFillCount());
 
 
 	// Next 63 * 8 bytes are the IQ data and the Audio data.
@@ -1197,105 +908,6 @@ int HermesProxy::PutTxIQ(const gr_complex * in0, /*const gr_complex * in1,*/ int
 };
 
 
-RawBuf_t HermesProxy::GetNextTxBuf()		// get a TXBuf if available
-{
-
-	  //int status = pthread_mutex_trylock(&mutexGPT); // Don't block gnuradio scheduler
-	  //if(status != 0)
-	 //   return NULL;	// No buffers if can't acquire mutex
-
-	  if (((TxWriteCounter+1) & (NUMTXBUFS - 1)) == TxReadCounter)
-	  {
-	    //pthread_mutex_unlock(&mutexGPT);
-	    return NULL;
-	  }
-	 
-	  ++TxWriteCounter &= (NUMTXBUFS - 1); // get next writeable buffer
-
-	  //pthread_mutex_unlock(&mutexGPT);
-	  return TxBuf[TxWriteCounter];
-};
-
-
-// SendTxIQ() is called on a periodic basis to send Tx Ethernet frames to the 
-// Hermes/Metis hardware.
-
-
-void HermesProxy::SendTxIQ()
-{
-
-	if(TxStop)				// Kill Tx frames if stopped
-		return;
-
-	unsigned char ep = 0x2;			// Tx data goes to end point 2
-
-//	fprintf(stderr, "SendTxIQ: TxReadCounter = %d   TxWriteCounter = %d  TxFrameIdleCount = %d\n",
-//		TxReadCounter, TxWriteCounter, TxFrameIdleCount); 
-
-	// Time to send one Tx Eth frame (2 x USB frames).
-	// If there are at least two buffers in the queue, send then free them.
-
-	//pthread_mutex_lock(&mutexGPT);
-
-	bool bufempty = (TxReadCounter == TxWriteCounter);
-	bool bufone = ((TxReadCounter+1 & (NUMTXBUFS - 1)) == TxWriteCounter);
-
-	int TempWriteCounter = TxWriteCounter;
-	if (TxWriteCounter < TxReadCounter)
-	  TempWriteCounter += NUMTXBUFS;
-	bool bufburst = ((TempWriteCounter - TxReadCounter) >= (TXINITIALBURST * 2));
-
-	//pthread_mutex_unlock(&mutexGPT);
-
-	TotalTxBufCount++;
-
-	if(TxHoldOff)	    	// Hold back initial burst of Tx Eth frames
-	{
-	  if (!bufburst)	// Not enough frames to send a burst
-	    return;
-	  			// Have enough frames to send the burst 
-	  TxHoldOff = false;	// clear the holdoff flag
-
-	  for (int i=0; i<(TXINITIALBURST * 2); i++)	// 2 USB frames per Ethernet frame
- 	  {
-	    metis_write(ep, TxBuf[TxReadCounter], 512);	// write one USB frame to metis
-	    ++TxReadCounter &= (NUMTXBUFS - 1);		// and free it
-	  }
-
-	  return;
-	}
-
- 	// We're out of bursting mode and into one-at-a-time mode
-
-	if ( bufempty | bufone )    // zero or one buffer ready	
-	{
-	  LostTxBufCount++;
-	  return;
-	}
-	else	// two or more buffers ready
-	{
-	//fprintf(stderr, "SendTxIQ02: TxReadCounter = %d   TxWriteCounter = %d  TxFrameIdleCount = %d\n",
-		//TxReadCounter, TxWriteCounter, TxFrameIdleCount); 
-
-	  metis_write(ep, TxBuf[TxReadCounter], 512);	// write one USB frame to metis
-
-	 // pthread_mutex_lock(&mutexGPT);
-	  ++TxReadCounter &= (NUMTXBUFS - 1);		// and free it
-	  //pthread_mutex_unlock(&mutexGPT);
-
-	  metis_write(ep, TxBuf[TxReadCounter], 512);	// write next USB frame to metis
-
-	  //pthread_mutex_lock(&mutexGPT);
-	  ++TxReadCounter &= (NUMTXBUFS - 1);		// and free it
-	  //pthread_mutex_unlock(&mutexGPT);
-
-	 // TxFrameIdleCount = 0;				// have just sent a frame
-	};
-
-	return;
-};
-
-
 // TODO not yet implemented
 void HermesProxy::ReceiveMicLR() {};	// receive an LR audio bufer from Hermes hardware
 
@@ -22,130 +22,74 @@
 // Proxy for Hermes board wideband mode, communicates with
 // only one hardware module.
 // Version:  March 21, 2015
+//	     October 2026	-- Common device/protocol code moved to HermesCore
+//	     October 2026	-- Unconverted int16 ADC samples (WBOutputShort)
+//	     October 2026	-- Resync the reassembly after an EP4 sequence restart
 
 #include <gnuradio/io_signature.h>
-#include "HermesProxy.h"		// typedefs and enums
+#include "HermesCore.h"		// buffer sizes, typedefs, enums and the shared core
 
 #ifndef HermesProxyW_H
 #define HermesProxyW_H
 
-#define NUMRXIQBUFS	128		// number of receiver IQ buffers in circular queue.
-					// Must be integral power of 2 (2,4,8,16,32,64, etc.)
+#define WBVECTORSIZE	16384		// number of floats in one wideband output vector
 
-#define RXBUFSIZE	256		// number of floats in one RxIQBuf, #complexes is half
-					// Must be integral power of 2 (2,4,8,16,32,64, etc.)
+#define WBFRAMES	32		// Ethernet frames (2 x 256 samples) per wideband vector
 
-#define NUMTXBUFS	128		// number of transmit buffers in circular queue
+#define NUMWBVECTORS	8		// number of wideband vectors in the Rx ring.
 					// Must be integral power of 2
 
-#define TXBUFSIZE	512		// number of bytes in one TxBuf
-					
+#define WBLATEWINDOW	64		// frames a straggler may trail the newest frame by,
+					// a larger backwards jump is a sequence restart
 
+enum {	WBGapDrop,			// incomplete vectors are thrown away
+	WBGapZeroFill };		// missing frames are zeroed, the vector is tagged
 
-//typedef float* IQBuf_t;			// IQ buffer type (IQ samples as floats)
-//typedef unsigned char* RawBuf_t;	// Raw transmit buffer type
+enum {	WBOutputFloat,			// ring slots hold float samples, +/- 1.0
+	WBOutputShort };		// int16 ADC samples as received, the first half of each slot
 
-//enum {  PTTOff,				// PTT disabled
-//	PTTVox,				// PTT vox mode (examines TxFrame to decide whether to Tx)
-//	PTTOn };			// PTT force Tx on
-
-class HermesProxyW
+class HermesProxyW : public HermesCore
 {
 
 private:
 
-	IQBuf_t RxIQBuf[NUMRXIQBUFS];	// ReceiveIQ buffers
-	unsigned RxWriteCounter;	// Which Rx buffer to write to
-	unsigned RxReadCounter;		// Which Rx buffer to read from
-	unsigned RxWriteFill;		// Fill level of the RxWrite buffer
-
-	RawBuf_t TxBuf[NUMTXBUFS]; 	// Transmit buffers
-	unsigned TxWriteCounter;	// Which Tx buffer to write to
-	unsigned TxReadCounter;		// Which Tx buffer to read from
-	unsigned TxControlCycler;	// Which Tx control register set to send
-	unsigned TxFrameIdleCount;	// How long we've gone since sending a TxFrame
-
-	unsigned long LostRxBufCount;	// Lost-buffer counter for packets we actually got
-	unsigned long TotalRxBufCount;	// Total buffer count (may roll over)
-	unsigned long LostTxBufCount;	//
-	unsigned long TotalTxBufCount;	//
-	unsigned long CorruptRxCount;	//
-	unsigned long LostEthernetRx;	//
-	unsigned long CurrentEthSeqNum;	// Diagnostic
-
-public:
-
-	unsigned Receive0Frequency;	// 1st rcvr. Corresponds to out0 in gnuradio
-	unsigned Receive1Frequency;	// 2nd rcvr. Corresponds to out1 in gnuradio
-	unsigned TransmitFrequency;
-	int NumReceivers;
-	int RxSampleRate;
-
-	unsigned char TxDrive;
-	unsigned char RxAtten;		// not yet used (requires Hermes firmware V2.0)
-
-	unsigned int ClockSource;	// upper 6-bits of clock control register
-
-	unsigned char AlexRxAnt;	// Select Alex Receive Antenna or from T/R relay
-	unsigned char AlexTxAnt;	// Select Alex Tx Antenna
-	unsigned char AlexRxHPF;	// Select Alex Receive High Pass Filter
-	unsigned char AlexTxLPF;	// Select Alex Transmit Low Pass Filter
+	IQBuf_t WBVector;		// vector being assembled, NULL if its frames are being dropped
+	unsigned WBVectorNum;		// SequenceNum >> 5 of the vector being assembled
+	unsigned WBFrameMask;		// bit n set when frame n of WBVector has arrived
+	unsigned WBNewestSeq;		// highest sequence number seen since the (re)start
+	bool WBStarted;			// false until the first frame arrives
+	uint64_t WBArrival;		// when the vector's first frame arrived, MonotonicNs()
+	uint64_t WBUnpack;		// when the proxy started on that frame
+	unsigned WBMissing[NUMWBVECTORS];	// missing frames in each ring slot (zero-fill policy)
 
-	int PTTMode;
-	bool RxPreamp;
-	bool ADCdither;
-	bool ADCrandom;
-	bool ADCoverload;
-	bool Duplex;
+	Counter_t WBVectorsComplete;	// vectors with all 32 frames
+	Counter_t WBVectorsFilled;	// incomplete vectors zero-filled and emitted
+	Counter_t WBVectorsDropped;	// incomplete vectors thrown away
+	Counter_t WBLateFrames;		// frames arriving after their vector was finished
 
-	unsigned char HermesVersion;
-	unsigned int AIN1, AIN2, AIN3, AIN4, AIN5, AIN6;  // Analog inputs to Hermes
-	unsigned int AlexRevPwr;
-	unsigned int SlowCount;
-	int Verbose;
+	void FinishVector();		// commit, zero-fill or drop the vector being assembled
 
-	bool TxStop;
-	bool PTTOffMutesTx;		// PTT Off mutes the transmitter
-	bool PTTOnMutesRx;		// PTT On receiver
-	char interface[16];
-
-	char mactarget[18];		// Requested target's MAC address as string
-					// "HH:HH:HH:HH:HH:HH" HH is hexadecimal string.
-	unsigned int metis_entry;	// Index into Metis_card MAC table
+public:
 
+	int GapPolicy;			// WBGapDrop or WBGapZeroFill
+	int OutputType;			// WBOutputFloat or WBOutputShort, set before Start()
 
 	HermesProxyW(int RxPre, const char* Intfc, const char * ClkS,
 			int AlexRA, int AlexTA, int AlexHPF, int AlexRPF,
-			const char* MACAddr);	// constructor
+			const char* MACAddr, int GapPol);	// constructor
 
 	~HermesProxyW();			// destructor
 
-	void Stop();			// stop ethernet I/O
 	void Start();			// start rx stream
 
-	void SendTxIQ();		// send an IQ buffer to Hermes transmit hardware
-	void BuildControlRegs(unsigned, RawBuf_t);	// fill in the 8 byte sync+control registers from RegNum
 	void PutTxIQ();			// post a transmit TxIQ buffer
 	void ScheduleTxFrame();    	// Schedule a Tx frame
-	RawBuf_t GetNextTxBuf(); 	// get an empty Tx Buffer
-
-	void UpdateHermes();		// update control registers in Hermes without any Tx data
-
-	void ReceiveRxIQ(unsigned char *); // receive an IQ buffer from Hermes hardware via metis.cc thread
-
-	IQBuf_t GetNextRxWriteBuf();	// Used to be named GetRxIQ()  
-	IQBuf_t GetNextRxReadBuf();	// Used to be named GetNextRxBuf(IQBuf_t)
-	IQBuf_t GetCurrentRxReadBuf();	//
-	IQBuf_t GetCurrentRxWriteBuf();	//  
-	bool RxReadBufAligned();	// True if the current Rcv Read Buffer is aligned on a 64 buffer boundary
-	bool RxWriteBufAligned();	// True if the current Rcv Write Buffer is aligned on a 64 buffer boundary
-	int RxBufFillCount();		// how many RxBuffers are filled?
-
-	void PrintRawBuf(RawBuf_t);	// for debugging
 
+	void ReceiveRxIQ(unsigned char *, uint64_t); // receive an IQ buffer from Hermes hardware via metis.cc thread
+	unsigned RxReadMissing();	// missing frames in the RxReadSlot() vector, 0 if complete
 
+	void GetStats(gr::hpsdr::hermes_stats &);	// core counters plus the WB vector counters
 
 };
 
 #endif  // #ifndef HermesProxyW_H
-
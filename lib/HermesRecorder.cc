@@ -0,0 +1,264 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// HermesRecorder.cc
+//
+// Version:  October 2026
+
+#include "HermesRecorder.h"
+#include "HermesCapture.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define WINDOWBYTES	((off_t)RECWINDOWRECORDS * CAPTURERECORD)
+
+static_assert(sizeof(CaptureRecord) == CAPTURERECORD, "capture record layout");
+static_assert((CAPTUREHEADER + (RECWINDOWRECORDS * CAPTURERECORD)) % 4096 == 0, "windows start on a page");
+
+std::atomic<bool> HermesRecorder::Active(false);
+
+static CaptureRecord* Ring = NULL;		// RECRINGSIZE frames
+static std::atomic<unsigned long> Head(0);	// next slot to fill, Rx thread
+static std::atomic<unsigned long> Tail(0);	// next slot to write, writer thread
+static std::atomic<unsigned long> Written(0);	// records in the file
+static std::atomic<unsigned long> Dropped(0);	// ring full, or the disk
+
+static int File = -1;
+static CaptureHeader Header;
+static std::vector<CaptureIndex> Index;		// writer thread
+
+static CaptureRecord* Window = NULL;		// mmap() of the records being written
+static unsigned long WindowFirst = 0;		// record number of Window[0]
+static bool DiskFull = false;
+
+static std::thread Writer;
+static std::atomic<bool> Running(false);
+
+
+void HermesRecorder::Post(const unsigned char* Frame, int Length, uint64_t ArrivalNs, uint64_t WireNs)
+{
+	unsigned long head = Head.load(std::memory_order_relaxed);
+	if (head - Tail.load(std::memory_order_acquire) >= RECRINGSIZE)
+	{
+	  Dropped.fetch_add(1, std::memory_order_relaxed);	// writer behind, never wait for it
+	  return;
+	}
+
+	if (Length > CAPTUREFRAME)
+	  Length = CAPTUREFRAME;
+
+	CaptureRecord & r = Ring[head & (RECRINGSIZE - 1)];
+	r.ArrivalNs = ArrivalNs;
+	r.WireNs = WireNs;
+	r.Length = Length;
+	r.Reserved = 0;
+	memcpy(r.Frame, Frame, Length);
+	Head.store(head + 1, std::memory_order_release);
+};
+
+void HermesRecorder::Counts(unsigned long* Frames, unsigned long* Drops)
+{
+	*Frames = Written.load(std::memory_order_relaxed);
+	*Drops = Dropped.load(std::memory_order_relaxed);
+};
+
+
+static void WriteHeader()
+{
+	Header.Records = Written.load(std::memory_order_relaxed);
+	Header.Dropped = Dropped.load(std::memory_order_relaxed);
+	if (pwrite(File, &Header, sizeof(Header), 0) != (ssize_t)sizeof(Header))
+	  perror("HermesRecorder: header write failed");
+}
+
+static void UnmapWindow()
+{
+	if (Window == NULL)
+	  return;
+
+	off_t start = CAPTUREHEADER + (off_t)WindowFirst * CAPTURERECORD;
+	sync_file_range(File, start, WINDOWBYTES, SYNC_FILE_RANGE_WRITE);	// start write back now
+	munmap(Window, WINDOWBYTES);
+	Window = NULL;
+}
+
+static bool MapWindow(unsigned long First)	// writer thread
+{
+	off_t start = CAPTUREHEADER + (off_t)First * CAPTURERECORD;
+
+	int rc = posix_fallocate(File, start, WINDOWBYTES);
+	if (rc != 0)
+	{
+	  fprintf(stderr, "HermesRecorder: cannot extend capture file: %s, recording stopped\n", strerror(rc));
+	  return false;
+	}
+
+	void* p = mmap(NULL, WINDOWBYTES, PROT_READ | PROT_WRITE, MAP_SHARED, File, start);
+	if (p == MAP_FAILED)
+	{
+	  perror("HermesRecorder: mmap of capture file failed, recording stopped");
+	  return false;
+	}
+
+	madvise(p, WINDOWBYTES, MADV_SEQUENTIAL);
+	Window = (CaptureRecord*)p;
+	WindowFirst = First;
+	return true;
+}
+
+static void Drain()			// writer thread: ring -> file
+{
+	unsigned long tail = Tail.load(std::memory_order_relaxed);
+	unsigned long head = Head.load(std::memory_order_acquire);
+	unsigned long n = Written.load(std::memory_order_relaxed);
+
+	for ( ; tail != head; tail++)
+	{
+	  const CaptureRecord & r = Ring[tail & (RECRINGSIZE - 1)];
+
+	  if (!DiskFull && (Window == NULL || n - WindowFirst >= RECWINDOWRECORDS))
+	  {
+	    UnmapWindow();
+	    DiskFull = !MapWindow(n);
+	  }
+	  if (DiskFull)
+	  {
+	    Dropped.fetch_add(1, std::memory_order_relaxed);
+	    continue;
+	  }
+
+	  memcpy(&Window[n - WindowFirst], &r, sizeof(r));
+	  if (n % CAPTUREINDEXEVERY == 0)
+	  {
+	    CaptureIndex e = { r.WireNs, n };
+	    Index.push_back(e);
+	  }
+	  n++;
+	  Written.store(n, std::memory_order_relaxed);
+	  if (n % CAPTUREINDEXEVERY == 0)
+	    WriteHeader();		// a file cut off by a crash still knows its length
+
+	  Tail.store(tail + 1, std::memory_order_release);	// slot free for the Rx thread
+	}
+	Tail.store(tail, std::memory_order_release);
+}
+
+static void Run()
+{
+	while (Running.load(std::memory_order_acquire))
+	{
+	  if (Tail.load(std::memory_order_relaxed) == Head.load(std::memory_order_acquire))
+	    std::this_thread::sleep_for(std::chrono::milliseconds(RECPOLLMS));
+	  Drain();
+	}
+	Drain();			// whatever arrived before Close()
+}
+
+
+bool HermesRecorder::Open(const char* Path, const char* Interface)
+{
+	if (Active || Path == NULL || Path[0] == 0)
+	  return false;
+
+	File = open(Path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (File < 0)
+	{
+	  fprintf(stderr, "HermesRecorder: cannot create %s: %s\n", Path, strerror(errno));
+	  return false;
+	}
+
+	Ring = (CaptureRecord*)malloc(sizeof(CaptureRecord) * RECRINGSIZE);
+	if (Ring == NULL)
+	{
+	  fprintf(stderr, "HermesRecorder: cannot allocate the ring\n");
+	  close(File);
+	  File = -1;
+	  return false;
+	}
+	memset(Ring, 0, sizeof(CaptureRecord) * RECRINGSIZE);	// fault the pages in now, not on the Rx thread
+
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	memset(&Header, 0, sizeof(Header));
+	memcpy(Header.Magic, CAPTUREMAGIC, sizeof(Header.Magic));
+	Header.Version = CAPTUREVERSION;
+	Header.RecordSize = CAPTURERECORD;
+	Header.StartNs = (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+	strncpy(Header.Interface, Interface, sizeof(Header.Interface) - 1);
+
+	Head = 0;
+	Tail = 0;
+	Written = 0;
+	Dropped = 0;
+	Index.clear();
+	DiskFull = !MapWindow(0);
+	WriteHeader();
+
+	fprintf(stderr, "HermesRecorder: recording to %s\n", Path);
+	Running = true;
+	Writer = std::thread(Run);
+	Active = true;
+	return true;
+};
+
+void HermesRecorder::Close()
+{
+	if (!Active)
+	  return;
+	Active = false;			// metis stops posting
+
+	Running = false;
+	if (Writer.joinable())
+	  Writer.join();
+	UnmapWindow();
+
+	// the index goes right after the last record, and the preallocated
+	// space past it is given back
+	unsigned long n = Written.load(std::memory_order_relaxed);
+	off_t end = CAPTUREHEADER + (off_t)n * CAPTURERECORD;
+	size_t bytes = Index.size() * sizeof(CaptureIndex);
+	if (bytes == 0 || pwrite(File, &Index[0], bytes, end) == (ssize_t)bytes)
+	{
+	  Header.IndexOffset = end;
+	  Header.IndexEntries = Index.size();
+	}
+	else
+	  perror("HermesRecorder: index write failed");
+	WriteHeader();
+	if (ftruncate(File, end + bytes) != 0)
+	  perror("HermesRecorder: ftruncate failed");
+
+	fprintf(stderr, "HermesRecorder: %lu frames recorded, %lu dropped\n", n,
+		Dropped.load(std::memory_order_relaxed));
+	close(File);
+	File = -1;
+	free(Ring);
+	Ring = NULL;
+	Index.clear();
+};
@@ -0,0 +1,69 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// HermesRecorder.h
+//
+// Records every EP6 and EP4 frame metis receives, with its arrival time,
+// to a capture file (HermesCapture.h) for replay.
+//
+// The metis receive thread only copies the frame into a single producer,
+// single consumer ring in memory; it never waits on the disk. A writer
+// thread moves the frames from the ring into the file, which is grown
+// RECWINDOWRECORDS at a time with posix_fallocate() and written through
+// an mmap() of that window. If the writer falls behind by more than
+// RECRINGSIZE frames, or the disk fills, frames are dropped and counted
+// rather than held up.
+//
+// Sizing: 384 ksps with 7 receivers is about 17,500 EP6 frames (18 MB)
+// a second; the ring covers about a second of that against a stalled
+// disk.
+//
+// Version:  October 2026
+
+#ifndef HermesRecorder_H
+#define HermesRecorder_H
+
+#include <stdint.h>
+#include <atomic>
+
+#define RECRINGSIZE		16384	// frames between Rx thread and writer, integral power of 2
+#define RECWINDOWRECORDS	65536	// records per mmap() window, about 66 MB; multiple of 128
+					// so each window starts on a page boundary
+#define RECPOLLMS		2	// writer sleep when the ring is empty
+
+class HermesRecorder
+{
+
+	static std::atomic<bool> Active;
+
+public:
+
+	static bool Open(const char* Path, const char* Interface);	// create the file, start the writer
+	static void Close();		// write out the ring, the index and the header;
+					// after the receive thread has stopped
+
+	static inline bool Recording() { return Active.load(std::memory_order_relaxed); }
+	static void Post(const unsigned char* Frame, int Length, uint64_t ArrivalNs,
+			 uint64_t WireNs);	// metis receive thread only, never blocks
+	static void Counts(unsigned long* Frames, unsigned long* Dropped);
+
+};
+
+#endif  // #ifndef HermesRecorder_H
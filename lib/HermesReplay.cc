@@ -0,0 +1,256 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// HermesReplay.cc
+//
+// Version:  October 2026
+
+#include "HermesReplay.h"
+#include "LatencyHistogram.h"		// MonotonicNs()
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+// ************  CaptureFile  ***************
+
+CaptureFile::CaptureFile()
+{
+	File = -1;
+	Map = NULL;
+	Size = 0;
+	NumRecords = 0;
+	Index = NULL;
+	IndexEntries = 0;
+};
+
+CaptureFile::~CaptureFile()
+{
+	Close();
+};
+
+bool CaptureFile::Open(const char* Path)
+{
+	struct stat st;
+
+	Close();
+	File = open(Path, O_RDONLY);
+	if (File < 0 || fstat(File, &st) != 0)
+	{
+	  fprintf(stderr, "CaptureFile: cannot open %s: %s\n", Path, strerror(errno));
+	  Close();
+	  return false;
+	}
+
+	Size = st.st_size;
+	if (Size < CAPTUREHEADER)
+	{
+	  fprintf(stderr, "CaptureFile: %s is not a capture file\n", Path);
+	  Close();
+	  return false;
+	}
+
+	void* p = mmap(NULL, Size, PROT_READ, MAP_SHARED, File, 0);
+	if (p == MAP_FAILED)
+	{
+	  fprintf(stderr, "CaptureFile: cannot map %s: %s\n", Path, strerror(errno));
+	  Map = NULL;
+	  Close();
+	  return false;
+	}
+	Map = (const unsigned char*)p;
+	madvise(p, Size, MADV_SEQUENTIAL);
+
+	const CaptureHeader* h = Header();
+	if (memcmp(h->Magic, CAPTUREMAGIC, sizeof(h->Magic)) != 0 ||
+	    h->Version != CAPTUREVERSION || h->RecordSize != CAPTURERECORD)
+	{
+	  fprintf(stderr, "CaptureFile: %s is not a version %d capture file\n", Path, CAPTUREVERSION);
+	  Close();
+	  return false;
+	}
+
+	// the header is only trusted as far as the file backs it up
+	uint64_t space = (Size - CAPTUREHEADER) / CAPTURERECORD;
+
+	if (h->IndexOffset >= CAPTUREHEADER && h->IndexOffset <= Size &&
+	    h->IndexEntries <= (Size - h->IndexOffset) / sizeof(CaptureIndex))
+	{
+	  NumRecords = std::min<uint64_t>(h->Records, space);
+	  Index = (const CaptureIndex*)(Map + h->IndexOffset);
+	  IndexEntries = h->IndexEntries;
+	}
+	else
+	{
+	  // recording did not close: take every record up to the first one
+	  // never written, from the last count the header got
+	  uint64_t n = std::min<uint64_t>(h->Records, space);
+	  while (n < space && Record(n)->Length != 0)
+	    n++;
+	  NumRecords = n;
+	  fprintf(stderr, "CaptureFile: %s was not closed, %lu records, no index\n",
+		  Path, (unsigned long)NumRecords);
+	}
+	return true;
+};
+
+void CaptureFile::Close()
+{
+	if (Map != NULL)
+	  munmap((void*)Map, Size);
+	if (File >= 0)
+	  close(File);
+	File = -1;
+	Map = NULL;
+	Size = 0;
+	NumRecords = 0;
+	Index = NULL;
+	IndexEntries = 0;
+};
+
+uint64_t CaptureFile::Find(double Seconds) const
+{
+	if (NumRecords == 0 || Seconds <= 0.0)
+	  return 0;
+
+	uint64_t target = Record(0)->WireNs + (uint64_t)(Seconds * 1e9);
+	uint64_t n = 0;
+
+	// last index entry at or before the target, then on from there
+	uint64_t lo = 0, hi = IndexEntries;
+	while (lo < hi)
+	{
+	  uint64_t mid = (lo + hi) / 2;
+	  if (Index[mid].WireNs <= target)
+	    lo = mid + 1;
+	  else
+	    hi = mid;
+	}
+	if (lo > 0)
+	  n = Index[lo-1].Record;
+
+	while (n < NumRecords && Record(n)->WireNs < target)
+	  n++;
+	return std::min(n, NumRecords);
+};
+
+
+// ************  HermesReplay  ***************
+
+static CaptureFile Capture;
+static double Speed = 1.0;
+static uint64_t First = 0;			// record to start from
+
+static std::thread Thread;
+static std::atomic<bool> Running(false);
+static std::atomic<bool> Finished(false);
+
+
+static void Run(metis_dispatch_t Dispatch, int (*Ready)(int Ep))
+{
+	unsigned char frame[CAPTUREFRAME];	// dispatch may write to the frame, the map is read only
+	struct sockaddr_in addr;
+	uint64_t n, frames = 0, oversize = 0;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+
+	uint64_t start = MonotonicNs();
+	uint64_t first = (First < Capture.Records()) ? Capture.Record(First)->ArrivalNs : 0;
+
+	for (n = First; n < Capture.Records() && Running.load(std::memory_order_relaxed); n++)
+	{
+	  const CaptureRecord* r = Capture.Record(n);
+	  if (r->Length < 8)
+	    continue;
+	  if (r->Length > CAPTUREFRAME)		// damaged record, would overrun frame[]
+	  {
+	    oversize++;
+	    continue;
+	  }
+	  int ep = r->Frame[3];
+
+	  if (Speed > 0.0)		// keep the recorded spacing, scaled
+	  {
+	    uint64_t due = start + (uint64_t)((r->ArrivalNs - first) / Speed);
+	    for (uint64_t now = MonotonicNs(); now < due && Running.load(std::memory_order_relaxed);
+		 now = MonotonicNs())
+	      std::this_thread::sleep_for(std::chrono::nanoseconds(
+		std::min<uint64_t>(due - now, REPLAYSLEEPMS * 1000000ull)));
+	  }
+	  else				// as fast as the proxies take them
+	    while (!Ready(ep) && Running.load(std::memory_order_relaxed))
+	      std::this_thread::sleep_for(std::chrono::microseconds(REPLAYWAITUS));
+
+	  memcpy(frame, r->Frame, r->Length);
+	  Dispatch(frame, r->Length, &addr, MonotonicNs(), r->WireNs);
+	  frames++;
+	}
+
+	fprintf(stderr, "HermesReplay: %lu frames replayed in %.3f s\n", (unsigned long)frames,
+		(MonotonicNs() - start) * 1e-9);
+	if (oversize != 0)
+	  fprintf(stderr, "HermesReplay: %lu oversize records skipped\n", (unsigned long)oversize);
+	Finished.store(true, std::memory_order_release);
+}
+
+
+bool HermesReplay::Open(const char* Path, double Spd, double Start)
+{
+	if (!Capture.Open(Path))
+	  return false;
+
+	Speed = (Spd > 0.0) ? Spd : 0.0;
+	First = Capture.Find(Start);
+	Finished = false;
+	fprintf(stderr, "HermesReplay: %s, %lu records from %lu, speed %s\n", Path,
+		(unsigned long)Capture.Records(), (unsigned long)First,
+		(Speed > 0.0) ? "scaled" : "unthrottled");
+	return true;
+};
+
+void HermesReplay::Run(metis_dispatch_t Dispatch, int (*Ready)(int Ep))
+{
+	if (Running)
+	  return;
+	Running = true;
+	Thread = std::thread(::Run, Dispatch, Ready);
+};
+
+void HermesReplay::Stop()
+{
+	Running = false;
+	if (Thread.joinable())
+	  Thread.join();
+	Capture.Close();
+};
+
+bool HermesReplay::Done()
+{
+	return Finished.load(std::memory_order_acquire);
+};
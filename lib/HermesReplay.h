@@ -0,0 +1,83 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// HermesReplay.h
+//
+// Plays a capture file (HermesCapture.h) back through metis_dispatch(),
+// so the frames take the same path as live ones: TimeRxFrame() with the
+// recorded wire time, then the proxies' ReceiveRxIQ(). Sequence numbers
+// are the recorded ones, so the gaps of the recording are gaps again.
+//
+// Speed 1.0 keeps the recorded frame spacing, 2.0 plays twice as fast,
+// and 0 plays as fast as the proxies' Rx rings empty: the replay thread
+// waits for ring space instead of letting frames drop, so an offline run
+// over a capture decodes every frame and gives the same samples each
+// time.
+//
+// CaptureFile reads captures on its own, for bench-hpsdr.
+//
+// Version:  October 2026
+
+#ifndef HermesReplay_H
+#define HermesReplay_H
+
+#include "HermesCapture.h"
+#include "metis.h"
+#include <stddef.h>
+
+#define REPLAYWAITUS	100		// unthrottled: wait for Rx ring space
+#define REPLAYSLEEPMS	10		// longest sleep between frames, so Stop() is prompt
+
+class CaptureFile
+{
+	int File;
+	const unsigned char* Map;
+	size_t Size;
+	uint64_t NumRecords;
+	const CaptureIndex* Index;
+	uint64_t IndexEntries;
+
+public:
+	CaptureFile();
+	~CaptureFile();
+
+	bool Open(const char* Path);	// map the file, false (and why on stderr) if not a capture
+	void Close();
+
+	const CaptureHeader* Header() const { return (const CaptureHeader*)Map; };
+	uint64_t Records() const { return NumRecords; };
+	const CaptureRecord* Record(uint64_t N) const
+		{ return (const CaptureRecord*)(Map + CAPTUREHEADER + N * CAPTURERECORD); };
+	uint64_t Find(double Seconds) const;	// first record Seconds or more after the first
+};
+
+class HermesReplay
+{
+
+public:
+
+	static bool Open(const char* Path, double Speed, double Start);	// before Run()
+	static void Run(metis_dispatch_t Dispatch, int (*Ready)(int Ep));	// start the replay thread
+	static void Stop();		// stop the thread, unmap the file
+	static bool Done();		// every frame has been dispatched
+
+};
+
+#endif  // #ifndef HermesReplay_H
@@ -0,0 +1,487 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// HermesSigMF.cc
+//
+// Version:  October 2026
+
+#include "HermesSigMF.h"
+#include "HermesCore.h"
+#include "HermesProxy.h"		// NBOutput_t
+#include <algorithm>
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static_assert(SIGMFBLOCKBYTES % SIGMFALIGN == 0, "O_DIRECT writes are whole alignment units");
+
+static uint64_t RealtimeNs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static std::string DateTime(uint64_t Ns)	// ISO 8601 UTC, as core:datetime wants it
+{
+	char buf[48];
+	time_t sec = Ns / 1000000000ull;
+	struct tm tm;
+	gmtime_r(&sec, &tm);
+	size_t n = strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+	snprintf(buf + n, sizeof(buf) - n, ".%06luZ", (unsigned long)((Ns % 1000000000ull) / 1000));
+	return buf;
+}
+
+
+SigMFWriter::SigMFWriter(HermesCore* Prx, const char* Bas, int Fmt, int Rx, int In)
+{
+	Proxy = Prx;
+	Base = Bas;
+	Format = (Fmt == SigMF_cf32) ? SigMF_cf32 : SigMF_ci16;
+	NumRx = Rx;
+	Input = In;
+	ItemBytes = (Input == NBOutputSC16) ? 2 * sizeof(int16_t) :
+		    (Input == NBOutputSC32) ? 2 * sizeof(int32_t) : sizeof(gr_complex);
+	SampleRate = 0;
+
+	// a base given as one of the file names is taken without the suffix
+	const char* suffix[] = { ".sigmf-data", ".sigmf-meta", ".sigmf" };
+	for (int i=0; i<3; i++)
+	  if (Base.size() > strlen(suffix[i]) &&
+	      Base.compare(Base.size() - strlen(suffix[i]), std::string::npos, suffix[i]) == 0)
+	    Base.erase(Base.size() - strlen(suffix[i]));
+
+	Channels.resize(NumRx);
+	for (int rx=0; rx<NumRx; rx++)
+	{
+	  Channel & ch = Channels[rx];
+	  ch.Ring = new unsigned char[SIGMFRINGSAMPLES * ItemBytes]();	// zeroed: pages faulted in now, not on the work thread
+	  void* p = NULL;
+	  if (posix_memalign(&p, SIGMFALIGN, SIGMFBLOCKBYTES) != 0)
+	  {
+	    fprintf(stderr, "\nFATAL: unable to allocate the SigMF write buffer.\n");
+	    exit(1);
+	  }
+	  ch.Block = (unsigned char*)p;
+	  ch.Fill = 0;
+	  ch.File = -1;
+	  ch.Direct = false;
+	  ch.Written = 0;
+	}
+
+	Head = 0;
+	Tail = 0;
+	Dropped = 0;
+	FirstNs = 0;
+	Running = false;
+	Active = false;
+};
+
+SigMFWriter::~SigMFWriter()
+{
+	Stop();
+	for (int rx=0; rx<NumRx; rx++)
+	{
+	  delete [] Channels[rx].Ring;
+	  free(Channels[rx].Block);
+	}
+};
+
+void SigMFWriter::Start()
+{
+	if (Running || Proxy == NULL)
+	  return;
+
+	SampleRate = Proxy->RxSampleRate;
+	for (int rx=0; rx<NumRx; rx++)
+	{
+	  Channel & ch = Channels[rx];
+	  std::string path = Base + "_rx" + std::to_string(rx) + ".sigmf-data";
+
+	  ch.Direct = true;
+	  ch.File = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+	  if (ch.File < 0 && errno == EINVAL)		// tmpfs and some others
+	  {
+	    ch.Direct = false;
+	    ch.File = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	  }
+	  if (ch.File < 0)
+	  {
+	    fprintf(stderr, "SigMF: cannot create %s: %s, not recording\n", path.c_str(), strerror(errno));
+	    for (int i=0; i<rx; i++)
+	    {
+	      close(Channels[i].File);
+	      Channels[i].File = -1;
+	    }
+	    return;
+	  }
+	  ch.Fill = 0;
+	  ch.Written = 0;
+	  ch.Captures.clear();
+	  AddCapture(ch, 0, Frequency(rx), 0);	// datetime once the first sample is in
+	}
+
+	Annotations.clear();
+	Head = 0;
+	Tail = 0;
+	Dropped = 0;
+	FirstNs = 0;
+	Poll(true);
+	for (int rx=0; rx<NumRx; rx++)
+	  WriteMeta(rx);
+
+	fprintf(stderr, "SigMF: recording %d receiver%s to %s_rx*.sigmf-data, %s\n", NumRx,
+		NumRx > 1 ? "s" : "", Base.c_str(), Format == SigMF_ci16 ? "ci16_le" : "cf32_le");
+	Running = true;
+	Thread = std::thread(&SigMFWriter::Run, this);
+	Active = true;
+};
+
+void SigMFWriter::Stop()
+{
+	if (!Running)
+	{
+	  Proxy = NULL;
+	  return;
+	}
+
+	Active = false;			// work thread stops posting
+	Running = false;
+	if (Thread.joinable())
+	  Thread.join();			// its last Drain() empties the rings
+
+	Poll(false);
+	Proxy = NULL;
+	for (int rx=0; rx<NumRx; rx++)
+	{
+	  Flush(Channels[rx], true);
+	  if (Channels[rx].File >= 0)
+	    close(Channels[rx].File);
+	  Channels[rx].File = -1;
+	  WriteMeta(rx);
+	}
+
+	fprintf(stderr, "SigMF: %lu samples per receiver recorded, %lu dropped\n",
+		(unsigned long)Tail.load(), (unsigned long)Dropped.load());
+};
+
+
+void SigMFWriter::Write(const void* const* Out, int Samples)
+{
+	if (!Active.load(std::memory_order_relaxed) || Samples <= 0)
+	  return;
+
+	uint64_t head = Head.load(std::memory_order_relaxed);
+	if (head + Samples - Tail.load(std::memory_order_acquire) > SIGMFRINGSAMPLES)
+	{
+	  Dropped.fetch_add(Samples, std::memory_order_relaxed);	// writer behind, never wait for it
+	  return;
+	}
+	if (head == 0)
+	  FirstNs.store(RealtimeNs(), std::memory_order_relaxed);
+
+	unsigned at = head & (SIGMFRINGSAMPLES - 1);
+	unsigned first = std::min((unsigned)Samples, SIGMFRINGSAMPLES - at);
+	for (int rx=0; rx<NumRx; rx++)
+	{
+	  const unsigned char* out = (const unsigned char*)Out[rx];
+	  memcpy(&Channels[rx].Ring[at * ItemBytes], out, first * ItemBytes);
+	  memcpy(&Channels[rx].Ring[0], out + first * ItemBytes, (Samples - first) * ItemBytes);
+	}
+	Head.store(head + Samples, std::memory_order_release);
+};
+
+
+void SigMFWriter::Run()
+{
+	while (Running.load(std::memory_order_acquire))
+	{
+	  std::this_thread::sleep_for(std::chrono::milliseconds(SIGMFPOLLMS));
+	  Drain();
+	  Poll(false);
+	}
+	Drain();			// whatever came before Stop()
+};
+
+void SigMFWriter::Drain()		// writer thread: rings -> files
+{
+	uint64_t tail = Tail.load(std::memory_order_relaxed);
+	uint64_t head = Head.load(std::memory_order_acquire);
+	unsigned bytes = (Format == SigMF_ci16) ? 2 * sizeof(int16_t) : sizeof(gr_complex);
+
+	for (int rx=0; rx<NumRx; rx++)
+	{
+	  Channel & ch = Channels[rx];
+	  for (uint64_t t = tail; t != head; )
+	  {
+	    unsigned at = t & (SIGMFRINGSAMPLES - 1);
+	    unsigned n = std::min<uint64_t>(head - t, SIGMFRINGSAMPLES - at);
+	    n = std::min(n, (SIGMFBLOCKBYTES - ch.Fill) / bytes);
+	    Convert(&ch.Ring[at * ItemBytes], ch.Block + ch.Fill, n);
+	    ch.Fill += n * bytes;
+	    t += n;
+	    if (ch.Fill == SIGMFBLOCKBYTES)
+	      Flush(ch, false);
+	  }
+	}
+	Tail.store(head, std::memory_order_release);	// ring space free for Write()
+};
+
+// N complex samples of the block's output type to the file's. ci16 from
+// the 24 bit samples is their top 16, rounded; an sc16 output is written
+// as it is, whatever its shift.
+
+static inline int16_t Saturate16(long v)
+{
+	return (int16_t)(v > 32767 ? 32767 : v < -32768 ? -32768 : v);
+}
+
+void SigMFWriter::Convert(const unsigned char* In, unsigned char* Out, unsigned N)
+{
+	if ((Format == SigMF_ci16 && Input == NBOutputSC16) ||
+	    (Format == SigMF_cf32 && Input == NBOutputFC32))
+	{
+	  memcpy(Out, In, N * ItemBytes);
+	  return;
+	}
+
+	if (Format == SigMF_ci16)
+	{
+	  int16_t* out = (int16_t*)Out;
+	  if (Input == NBOutputSC32)
+	  {
+	    const int32_t* in = (const int32_t*)In;
+	    for (unsigned i=0; i<2*N; i++)
+	      out[i] = Saturate16((in[i] + 128) >> 8);
+	  }
+	  else
+	  {
+	    const float* in = (const float*)In;
+	    for (unsigned i=0; i<2*N; i++)
+	      out[i] = Saturate16(lrintf(in[i] * 32768.0f));
+	  }
+	}
+	else
+	{
+	  float* out = (float*)Out;
+	  if (Input == NBOutputSC32)
+	  {
+	    const int32_t* in = (const int32_t*)In;
+	    for (unsigned i=0; i<2*N; i++)
+	      out[i] = in[i] / 8388607.0f;
+	  }
+	  else
+	  {
+	    const int16_t* in = (const int16_t*)In;
+	    for (unsigned i=0; i<2*N; i++)
+	      out[i] = in[i] / 32768.0f;
+	  }
+	}
+};
+
+void SigMFWriter::Flush(Channel & ch, bool Last)
+{
+	if (ch.Fill == 0)
+	  return;
+
+	if (ch.File >= 0)
+	{
+	  if (Last && ch.Direct && ch.Fill % SIGMFALIGN != 0)	// short tail: O_DIRECT off for it
+	  {
+	    fcntl(ch.File, F_SETFL, fcntl(ch.File, F_GETFL) & ~O_DIRECT);
+	    ch.Direct = false;
+	  }
+	  if (pwrite(ch.File, ch.Block, ch.Fill, ch.Written) != (ssize_t)ch.Fill)
+	  {
+	    fprintf(stderr, "SigMF: write failed: %s, recording stopped\n", strerror(errno));
+	    close(ch.File);
+	    ch.File = -1;
+	  }
+	  else
+	    ch.Written += ch.Fill;
+	}
+	ch.Fill = 0;
+};
+
+
+unsigned SigMFWriter::Frequency(int Rx)
+{
+	switch (Rx)
+	{
+	  case 0: return Proxy->Receive0Frequency;
+	  case 1: return Proxy->Receive1Frequency;
+	  case 2: return Proxy->Receive2Frequency;
+	  case 3: return Proxy->Receive3Frequency;
+	  case 4: return Proxy->Receive4Frequency;
+	  case 5: return Proxy->Receive5Frequency;
+	  case 6: return Proxy->Receive6Frequency;
+	  default: return Proxy->Receive7Frequency;
+	}
+};
+
+void SigMFWriter::AddCapture(Channel & ch, uint64_t Sample, unsigned Freq, uint64_t RealNs)
+{
+	if (!ch.Captures.empty() && ch.Captures.back().Sample == Sample)	// one segment per sample
+	{
+	  ch.Captures.back().Frequency = Freq;
+	  if (RealNs != 0)
+	    ch.Captures.back().RealNs = RealNs;
+	  return;
+	}
+	Capture c = { Sample, Freq, RealNs };
+	ch.Captures.push_back(c);
+};
+
+void SigMFWriter::Poll(bool First)	// writer thread, or Start() / Stop() without it
+{
+	if (Proxy == NULL)
+	  return;
+
+	gr::hpsdr::hermes_stats st;
+	Proxy->GetStats(st);
+	unsigned long overload = Proxy->ADCOverloadFrames.load(std::memory_order_relaxed);
+	uint64_t dropped = Dropped.load(std::memory_order_relaxed);
+	uint64_t sample = Head.load(std::memory_order_acquire);	// where the work thread is
+	uint64_t now = RealtimeNs();
+
+	if (First)
+	{
+	  for (int rx=0; rx<NumRx; rx++)
+	    LastFrequency[rx] = Frequency(rx);
+	  LastLostEthernet = st.lost_ethernet_rx;
+	  LastLostRxBuf = st.lost_rx_buf;
+	  LastOverload = overload;
+	  LastDropped = dropped;
+	  LastPollSample = 0;
+	  LastAnchorNs = now;
+	  LastSampleRate = SampleRate;
+	  return;
+	}
+
+	uint64_t first = FirstNs.load(std::memory_order_relaxed);
+	if (first != 0)
+	  for (int rx=0; rx<NumRx; rx++)
+	    if (Channels[rx].Captures[0].RealNs == 0)
+	      Channels[rx].Captures[0].RealNs = first;
+
+	char text[160];
+	if (overload != LastOverload)	// over the interval since the last poll
+	{
+	  snprintf(text, sizeof(text), "%lu frames with the ADC overload bit", overload - LastOverload);
+	  Annotation a = { LastPollSample, sample - LastPollSample, "adc_overload", text };
+	  Annotations.push_back(a);
+	}
+
+	bool gap = false;
+	if (st.lost_ethernet_rx != LastLostEthernet || st.lost_rx_buf != LastLostRxBuf ||
+	    dropped != LastDropped)
+	{
+	  snprintf(text, sizeof(text), "%lu Ethernet frames lost, %lu Rx buffers dropped, "
+		   "%lu samples dropped by the recorder", st.lost_ethernet_rx - LastLostEthernet,
+		   st.lost_rx_buf - LastLostRxBuf, (unsigned long)(dropped - LastDropped));
+	  Annotation a = { sample, 0, "gap", text };
+	  Annotations.push_back(a);
+	  gap = true;			// and a segment to put the time right
+	}
+
+	if (Proxy->RxSampleRate != LastSampleRate)
+	{
+	  snprintf(text, sizeof(text), "sample rate changed to %d, core:sample_rate no longer applies",
+		   Proxy->RxSampleRate);
+	  Annotation a = { sample, 0, "sample_rate", text };
+	  Annotations.push_back(a);
+	  LastSampleRate = Proxy->RxSampleRate;
+	}
+
+	bool anchor = (now - LastAnchorNs >= SIGMFANCHORSECONDS * 1000000000ull);
+	for (int rx=0; rx<NumRx; rx++)
+	{
+	  unsigned f = Frequency(rx);
+	  if (gap || anchor || f != LastFrequency[rx])
+	    AddCapture(Channels[rx], sample, f, now);
+	  LastFrequency[rx] = f;
+	}
+
+	LastLostEthernet = st.lost_ethernet_rx;
+	LastLostRxBuf = st.lost_rx_buf;
+	LastOverload = overload;
+	LastDropped = dropped;
+	LastPollSample = sample;
+
+	if (anchor)			// keep the metadata on disk about as current as the data
+	{
+	  LastAnchorNs = now;
+	  for (int rx=0; rx<NumRx; rx++)
+	    WriteMeta(rx);
+	}
+};
+
+void SigMFWriter::WriteMeta(int Rx)
+{
+	Channel & ch = Channels[Rx];
+	std::string path = Base + "_rx" + std::to_string(Rx) + ".sigmf-meta";
+	std::string tmp = path + ".tmp";
+
+	FILE* f = fopen(tmp.c_str(), "w");
+	if (f == NULL)
+	{
+	  fprintf(stderr, "SigMF: cannot write %s: %s\n", tmp.c_str(), strerror(errno));
+	  return;
+	}
+
+	fprintf(f, "{\n    \"global\": {\n");
+	fprintf(f, "        \"core:datatype\": \"%s\",\n", Format == SigMF_ci16 ? "ci16_le" : "cf32_le");
+	fprintf(f, "        \"core:sample_rate\": %d,\n", SampleRate);
+	fprintf(f, "        \"core:version\": \"1.0.0\",\n");
+	fprintf(f, "        \"core:num_channels\": 1,\n");
+	fprintf(f, "        \"core:hw\": \"HPSDR Hermes, protocol 1\",\n");
+	fprintf(f, "        \"core:recorder\": \"gr-hpsdr hermesNB\",\n");
+	fprintf(f, "        \"core:description\": \"receiver %d of %d\"\n", Rx, NumRx);
+	fprintf(f, "    },\n    \"captures\": [");
+	for (size_t i=0; i<ch.Captures.size(); i++)
+	{
+	  const Capture & c = ch.Captures[i];
+	  fprintf(f, "%s\n        { \"core:sample_start\": %lu, \"core:frequency\": %u", i ? "," : "",
+		  (unsigned long)c.Sample, c.Frequency);
+	  if (c.RealNs != 0)
+	    fprintf(f, ", \"core:datetime\": \"%s\"", DateTime(c.RealNs).c_str());
+	  fprintf(f, " }");
+	}
+	fprintf(f, "\n    ],\n    \"annotations\": [");
+	for (size_t i=0; i<Annotations.size(); i++)
+	{
+	  const Annotation & a = Annotations[i];
+	  fprintf(f, "%s\n        { \"core:sample_start\": %lu", i ? "," : "", (unsigned long)a.Sample);
+	  if (a.Count != 0)
+	    fprintf(f, ", \"core:sample_count\": %lu", (unsigned long)a.Count);
+	  fprintf(f, ", \"core:label\": \"%s\", \"core:comment\": \"%s\" }", a.Label.c_str(), a.Comment.c_str());
+	}
+	fprintf(f, "\n    ]\n}\n");
+
+	if (fclose(f) != 0 || rename(tmp.c_str(), path.c_str()) != 0)
+	  fprintf(stderr, "SigMF: cannot write %s: %s\n", path.c_str(), strerror(errno));
+};
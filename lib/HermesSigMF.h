@@ -0,0 +1,147 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// HermesSigMF.h
+//
+// SigMF recordings of hermesNB's receiver outputs: for a base name
+// <Base>, receiver N goes to <Base>_rxN.sigmf-data (ci16_le or cf32_le
+// samples) and <Base>_rxN.sigmf-meta.
+//
+// The work thread only copies each output into a ring per receiver
+// (Write()), in the block's output type (NBOutput_t); it never waits on
+// the disk. A writer thread converts the
+// samples and writes them SIGMFBLOCKBYTES at a time from aligned buffers
+// with O_DIRECT, where the file system allows it. If the writer falls
+// behind by a ring, the work thread's samples are dropped and the drop
+// is annotated rather than held up.
+//
+// The writer thread also watches the proxy, every SIGMFPOLLMS:
+//   receiver frequency changes	new capture segment, core:frequency
+//   lost Ethernet frames or Rx	"gap" annotation, and a new capture segment
+//     buffers, ring drops		so core:datetime is right again after it
+//   ADC overload frames		"adc_overload" annotation over the poll interval
+// and starts a capture segment every SIGMFANCHORSECONDS as a time anchor.
+// Events are placed at the sample the work thread had reached when the
+// writer saw them, so to within SIGMFPOLLMS.
+//
+// The .sigmf-meta files are written at Start(), again at every anchor,
+// and complete at Stop(). As with StatsMonitor, the block deletes the
+// proxy in stop(), so Stop() comes first.
+//
+// Version:  October 2026
+
+#ifndef HermesSigMF_H
+#define HermesSigMF_H
+
+#include <gnuradio/io_signature.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+#define SIGMFRINGSAMPLES	(1 << 19)	// complex samples per receiver ring, integral power of 2
+#define SIGMFBLOCKBYTES		(1 << 20)	// bytes per O_DIRECT write
+#define SIGMFALIGN		4096		// O_DIRECT buffer and length alignment
+#define SIGMFPOLLMS		5		// writer wake up, and proxy event resolution
+#define SIGMFANCHORSECONDS	60		// seconds between core:datetime anchors
+
+enum SigMFFormat_t { SigMF_ci16, SigMF_cf32 };	// SigMFFormat make() parameter
+
+class HermesCore;
+
+class SigMFWriter
+{
+
+private:
+
+	struct Capture			// one captures[] segment
+	{
+	  uint64_t Sample;
+	  unsigned Frequency;
+	  uint64_t RealNs;		// CLOCK_REALTIME at Sample
+	};
+
+	struct Annotation		// one annotations[] entry, the same in every receiver's file
+	{
+	  uint64_t Sample;
+	  uint64_t Count;		// 0 = a point in the stream
+	  std::string Label;
+	  std::string Comment;
+	};
+
+	struct Channel			// one receiver
+	{
+	  unsigned char* Ring;		// SIGMFRINGSAMPLES items, filled by Write()
+	  unsigned char* Block;		// SIGMFBLOCKBYTES, aligned, being filled by the writer
+	  unsigned Fill;		// bytes in Block
+	  int File;
+	  bool Direct;			// File is O_DIRECT
+	  uint64_t Written;		// bytes in the file
+	  std::vector<Capture> Captures;
+	};
+
+	HermesCore* Proxy;		// NULL once stopped
+	std::string Base;
+	SigMFFormat_t Format;
+	int NumRx;
+	int Input;			// NBOutput_t of the items Write() gets
+	unsigned ItemBytes;		// their size
+	int SampleRate;			// at Start()
+
+	std::vector<Channel> Channels;
+	std::atomic<uint64_t> Head;	// samples Write() has put in every ring
+	std::atomic<uint64_t> Tail;	// samples the writer has taken from them
+	std::atomic<uint64_t> Dropped;	// samples Write() threw away, rings full
+	std::atomic<uint64_t> FirstNs;	// CLOCK_REALTIME of the first sample, 0 before it
+
+	std::vector<Annotation> Annotations;	// writer thread, then Stop()
+	std::thread Thread;
+	std::atomic<bool> Running;	// writer thread runs
+	std::atomic<bool> Active;	// Write() takes samples
+
+	void Run();			// writer thread
+	void Poll(bool First);		// look for proxy events
+	void Drain();			// rings -> files
+	void Convert(const unsigned char* In, unsigned char* Out, unsigned N);	// Input -> Format
+	void Flush(Channel & ch, bool Last);	// write Block out
+	void WriteMeta(int Rx);
+	void AddCapture(Channel & ch, uint64_t Sample, unsigned Frequency, uint64_t RealNs);
+	unsigned Frequency(int Rx);	// the proxy's Receive<Rx>Frequency
+
+	// proxy state at the last Poll()
+	unsigned LastFrequency[8];
+	unsigned long LastLostEthernet, LastLostRxBuf, LastOverload;
+	uint64_t LastDropped, LastPollSample, LastAnchorNs;
+	int LastSampleRate;
+
+public:
+
+	SigMFWriter(HermesCore* Prx, const char* Base, int Format, int NumRx, int Input);
+	~SigMFWriter();
+
+	void Start();			// create the files, start the writer
+	void Stop();			// write out the rings and the metadata, forget the proxy
+
+	void Write(const void* const* Out, int Samples);	// work thread only, never blocks
+
+};
+
+#endif  // #ifndef HermesSigMF_H
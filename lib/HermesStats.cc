@@ -0,0 +1,202 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// HermesStats.cc
+//
+// Version:  October 2026
+
+#include "HermesStats.h"
+#include "HermesCore.h"
+#include <chrono>
+#include <cstring>
+#include <string>
+
+
+StatsMonitor::StatsMonitor(gr::basic_block* Blk, HermesCore* Prx, double Per)
+{
+	Block = Blk;
+	Proxy = Prx;
+	Period = (Per > 0.0) ? Per : 0.0;
+	Running = false;
+	memset(&Last, 0, sizeof(Last));
+};
+
+StatsMonitor::~StatsMonitor()
+{
+	Stop();
+};
+
+void StatsMonitor::Start()
+{
+	std::lock_guard<std::mutex> lk(Lock);
+	if (Running || Period == 0.0 || Proxy == NULL)
+	  return;
+
+	Running = true;
+	Thread = std::thread(&StatsMonitor::Run, this);
+};
+
+void StatsMonitor::Stop()
+{
+	{
+	  std::lock_guard<std::mutex> lk(Lock);
+	  Running = false;
+	}
+	Wake.notify_all();
+	if (Thread.joinable())
+	  Thread.join();
+
+	std::lock_guard<std::mutex> lk(Lock);
+	if (Proxy != NULL)
+	  Proxy->GetStats(Last);
+	Proxy = NULL;
+};
+
+gr::hpsdr::hermes_stats StatsMonitor::Snapshot()
+{
+	std::lock_guard<std::mutex> lk(Lock);
+	if (Proxy != NULL)
+	  Proxy->GetStats(Last);
+	return Last;
+};
+
+double StatsMonitor::Latency(int Stage, double Pct)
+{
+	std::lock_guard<std::mutex> lk(Lock);
+	if (Proxy == NULL || Stage < 0 || Stage >= gr::hpsdr::LATENCY_STAGES)
+	  return 0.0;
+	return Proxy->Latency[Stage].Percentile(Pct) / 1000.0;
+};
+
+void StatsMonitor::ResetLatency()
+{
+	std::lock_guard<std::mutex> lk(Lock);
+	if (Proxy != NULL)
+	  for (int i=0; i<gr::hpsdr::LATENCY_STAGES; i++)
+	    Proxy->Latency[i].Reset();
+};
+
+
+// The monitor thread. Sleeps on the condition variable so Stop() does not
+// have to wait out the period.
+
+void StatsMonitor::Run()
+{
+	typedef std::chrono::steady_clock clock;
+
+	std::unique_lock<std::mutex> lk(Lock);
+
+	gr::hpsdr::hermes_stats prev, now;
+	Proxy->GetStats(prev);
+	clock::time_point then = clock::now();
+	clock::time_point next = then;
+
+	while (Running)
+	{
+	  next += std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(Period));
+	  Wake.wait_until(lk, next, [this] { return !Running; });
+	  if (!Running)
+	    break;
+
+	  Proxy->GetStats(now);
+	  clock::time_point t = clock::now();
+	  double seconds = std::chrono::duration<double>(t - then).count();
+	  pmt::pmt_t msg = AddLatency(ToDict(now, prev, seconds), Proxy);
+
+	  lk.unlock();			// never hold the lock across the scheduler
+	  Block->message_port_pub(pmt::mp("stats"), msg);
+	  lk.lock();
+
+	  prev = now;
+	  then = t;
+	}
+};
+
+
+pmt::pmt_t StatsMonitor::ToDict(const gr::hpsdr::hermes_stats & now,
+			const gr::hpsdr::hermes_stats & prev, double Seconds)
+{
+	pmt::pmt_t d = pmt::make_dict();
+
+	// counters, each with its rate over the last period
+#define COUNTER(f)							\
+	d = pmt::dict_add(d, pmt::mp(#f), pmt::from_uint64(now.f));	\
+	d = pmt::dict_add(d, pmt::mp(#f "_rate"),			\
+		pmt::from_double((Seconds > 0.0) ? (now.f - prev.f) / Seconds : 0.0));
+
+	COUNTER(lost_rx_buf)
+	COUNTER(total_rx_buf)
+	COUNTER(lost_tx_buf)
+	COUNTER(total_tx_buf)
+	COUNTER(corrupt_rx)
+	COUNTER(lost_ethernet_rx)
+	COUNTER(wb_vectors_complete)
+	COUNTER(wb_vectors_filled)
+	COUNTER(wb_vectors_dropped)
+	COUNTER(wb_late_frames)
+	COUNTER(busy_poll_hits)
+	COUNTER(busy_poll_misses)
+	COUNTER(record_frames)
+	COUNTER(record_dropped)
+#undef COUNTER
+
+	// levels
+	d = pmt::dict_add(d, pmt::mp("rx_ring_size"), pmt::from_long(now.rx_ring_size));
+	d = pmt::dict_add(d, pmt::mp("rx_ring_fill"), pmt::from_long(now.rx_ring_fill));
+	d = pmt::dict_add(d, pmt::mp("rx_ring_high_water"), pmt::from_long(now.rx_ring_high_water));
+	d = pmt::dict_add(d, pmt::mp("tx_queue_size"), pmt::from_long(now.tx_queue_size));
+	d = pmt::dict_add(d, pmt::mp("tx_queue_fill"), pmt::from_long(now.tx_queue_fill));
+	d = pmt::dict_add(d, pmt::mp("interval"), pmt::from_double(Seconds));
+
+	// receive timing
+	d = pmt::dict_add(d, pmt::mp("rx_jitter_us"), pmt::from_double(now.rx_jitter_us));
+	d = pmt::dict_add(d, pmt::mp("rx_interval_mean_us"), pmt::from_double(now.rx_interval_mean_us));
+	d = pmt::dict_add(d, pmt::mp("rx_interval_std_us"), pmt::from_double(now.rx_interval_std_us));
+	d = pmt::dict_add(d, pmt::mp("rx_interval_max_us"), pmt::from_double(now.rx_interval_max_us));
+	d = pmt::dict_add(d, pmt::mp("clock_drift_ppm"), pmt::from_double(now.clock_drift_ppm));
+	d = pmt::dict_add(d, pmt::mp("effective_sample_rate"), pmt::from_double(now.effective_sample_rate));
+	d = pmt::dict_add(d, pmt::mp("kernel_timestamps"), pmt::from_bool(now.kernel_timestamps != 0));
+	d = pmt::dict_add(d, pmt::mp("io_backend"), pmt::from_long(now.io_backend));
+	d = pmt::dict_add(d, pmt::mp("busy_poll_hit_ratio"), pmt::from_double(now.busy_poll_hit_ratio));
+
+	return d;
+};
+
+
+// Median, 99th percentile and largest latency of each stage since the
+// start (or the last reset_latency()), in microseconds.
+
+pmt::pmt_t StatsMonitor::AddLatency(pmt::pmt_t Dict, HermesCore* Prx)
+{
+	static const char* names[gr::hpsdr::LATENCY_STAGES] =
+		{ "socket_to_unpack", "unpack_to_commit", "commit_to_work", "arrival_to_work" };
+
+	for (int i=0; i<gr::hpsdr::LATENCY_STAGES; i++)
+	{
+	  std::string key = std::string("latency_") + names[i];
+	  LatencyHistogram & h = Prx->Latency[i];
+
+	  Dict = pmt::dict_add(Dict, pmt::mp(key + "_p50_us"), pmt::from_double(h.Percentile(50.0) / 1000.0));
+	  Dict = pmt::dict_add(Dict, pmt::mp(key + "_p99_us"), pmt::from_double(h.Percentile(99.0) / 1000.0));
+	  Dict = pmt::dict_add(Dict, pmt::mp(key + "_max_us"), pmt::from_double(h.Max() / 1000.0));
+	}
+
+	return Dict;
+};
@@ -0,0 +1,82 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// HermesStats.h
+//
+// Live view of a proxy's counters for hermesNB and hermesWB. get_stats()
+// reads the counters through the monitor, and while the flowgraph runs a
+// monitor thread publishes them on the block's "stats" message port every
+// Period seconds, as a PMT dict of the counters plus their per second
+// rates over the last period.
+//
+// The blocks delete their proxy in stop(), so the monitor takes a final
+// copy of the counters first and get_stats() keeps returning it. The
+// latency histograms go with the proxy, get_latency() returns 0 after stop().
+//
+// Version:  October 2026
+
+#include <gnuradio/basic_block.h>
+#include <pmt/pmt.h>
+#include <hpsdr/hermes_stats.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#ifndef HermesStats_H
+#define HermesStats_H
+
+class HermesCore;
+
+class StatsMonitor
+{
+
+private:
+
+	gr::basic_block* Block;		// owner of the "stats" port
+	HermesCore* Proxy;		// NULL once the proxy is gone
+	double Period;			// seconds between messages, 0 = no messages
+	gr::hpsdr::hermes_stats Last;	// final copy after Stop()
+
+	std::mutex Lock;		// guards Proxy, Last and Running
+	std::condition_variable Wake;
+	std::thread Thread;
+	bool Running;
+
+	void Run();			// monitor thread
+
+public:
+
+	StatsMonitor(gr::basic_block* Blk, HermesCore* Prx, double Per);
+	~StatsMonitor();
+
+	void Start();			// start publishing
+	void Stop();			// stop publishing, keep a final copy, forget the proxy
+
+	gr::hpsdr::hermes_stats Snapshot();	// live counters, or the final copy
+	double Latency(int Stage, double Pct);	// microseconds, 0 once stopped
+	void ResetLatency();
+
+	static pmt::pmt_t ToDict(const gr::hpsdr::hermes_stats & now,
+			const gr::hpsdr::hermes_stats & prev, double Seconds);
+	static pmt::pmt_t AddLatency(pmt::pmt_t Dict, HermesCore* Prx);
+
+};
+
+#endif  // #ifndef HermesStats_H
@@ -0,0 +1,192 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// HermesTelemetry.cc
+//
+// Version:  October 2026
+
+#include "HermesTelemetry.h"
+#include "HermesCore.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdio.h>
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+TelemetryMonitor::TelemetryMonitor(gr::basic_block* Blk, HermesCore* Prx)
+{
+	Block = Blk;
+	Proxy = Prx;
+	Running = false;
+	memset(&Last, 0, sizeof(Last));
+};
+
+TelemetryMonitor::~TelemetryMonitor()
+{
+	Stop();
+};
+
+void TelemetryMonitor::Start()
+{
+	std::lock_guard<std::mutex> lk(Lock);
+	if (Running || Proxy == NULL)
+	  return;
+
+	Running = true;
+	Thread = std::thread(&TelemetryMonitor::Run, this);
+};
+
+void TelemetryMonitor::Stop()
+{
+	{
+	  std::lock_guard<std::mutex> lk(Lock);
+	  Running = false;
+	}
+	Wake.notify_all();
+	if (Thread.joinable())
+	  Thread.join();
+
+	std::lock_guard<std::mutex> lk(Lock);
+	if (Proxy != NULL)
+	  Decode(Proxy, Last);
+	Proxy = NULL;
+};
+
+gr::hpsdr::hermes_telemetry TelemetryMonitor::Snapshot()
+{
+	std::lock_guard<std::mutex> lk(Lock);
+	if (Proxy != NULL)
+	  Decode(Proxy, Last);
+	return Last;
+};
+
+
+// The telemetry thread. Runs below the priority of the receive and work
+// threads, it only has to keep up with a human reading a meter.
+
+void TelemetryMonitor::Run()
+{
+	typedef std::chrono::steady_clock clock;
+
+#ifdef __linux__
+	setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), TELEMETRYNICE);	// this thread only
+#endif
+
+	std::unique_lock<std::mutex> lk(Lock);
+
+	gr::hpsdr::hermes_telemetry now;
+	clock::time_point next = clock::now();
+
+	while (Running)
+	{
+	  next += std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(TELEMETRYSECONDS));
+	  Wake.wait_until(lk, next, [this] { return !Running; });
+	  if (!Running)
+	    break;
+
+	  Decode(Proxy, now);
+	  if (!now.valid)		// nothing from Hermes yet
+	    continue;
+
+	  bool verbose = (Proxy->Verbose != 0);
+	  pmt::pmt_t msg = ToDict(now);
+
+	  lk.unlock();			// never hold the lock across the scheduler or stdio
+	  Block->message_port_pub(pmt::mp("telemetry"), msg);
+	  if (verbose)
+	    Print(now);
+	  lk.lock();
+	}
+};
+
+
+void TelemetryMonitor::Decode(HermesCore* Prx, gr::hpsdr::hermes_telemetry & t)
+{
+	uint32_t bank00 = Prx->StatusLatch[0].load(std::memory_order_relaxed);	// C1..C4 of each bank
+	uint32_t bank08 = Prx->StatusLatch[1].load(std::memory_order_relaxed);
+	uint32_t bank10 = Prx->StatusLatch[2].load(std::memory_order_relaxed);
+	uint32_t bank18 = Prx->StatusLatch[3].load(std::memory_order_relaxed);
+
+	t.valid = (Prx->StatusFrames.load(std::memory_order_relaxed) != 0);
+	t.adc_overload = (bank00 >> 24) & 0x01;
+	t.adc_overload_frames = Prx->ADCOverloadFrames.load(std::memory_order_relaxed);
+	t.hermes_version = bank00 & 0xff;
+
+	t.ain5 = bank08 >> 16;
+	t.ain1 = bank08 & 0xffff;
+	t.ain2 = bank10 >> 16;
+	t.ain3 = bank10 & 0xffff;
+	t.ain4 = bank18 >> 16;
+	t.ain6 = bank18 & 0xffff;
+
+	t.forward_power = (double)t.ain1 * (double)t.ain1 / 145000.0;
+	t.reverse_power = (double)t.ain2 * (double)t.ain2 / 145000.0;
+	t.swr = SWR(t.forward_power, t.reverse_power);
+};
+
+double TelemetryMonitor::SWR(double Fwd, double Rev)
+{
+	if (Fwd <= 0.0)
+	  return 0.0;
+
+	double rho = sqrt(Rev / Fwd);		// reflection coefficient
+	double swr = (1.0 + rho) / (1.0 - rho);
+
+	// there was an anomaly in the SWR calculation, make it obvious ...
+	if (!std::isnormal(swr) || swr < 1.0)
+	  return 99.9;
+
+	return swr;
+};
+
+pmt::pmt_t TelemetryMonitor::ToDict(const gr::hpsdr::hermes_telemetry & t)
+{
+	pmt::pmt_t d = pmt::make_dict();
+
+	d = pmt::dict_add(d, pmt::mp("forward_power"), pmt::from_double(t.forward_power));
+	d = pmt::dict_add(d, pmt::mp("reverse_power"), pmt::from_double(t.reverse_power));
+	d = pmt::dict_add(d, pmt::mp("swr"), pmt::from_double(t.swr));
+	d = pmt::dict_add(d, pmt::mp("adc_overload"), pmt::from_bool(t.adc_overload != 0));
+	d = pmt::dict_add(d, pmt::mp("adc_overload_frames"), pmt::from_uint64(t.adc_overload_frames));
+	d = pmt::dict_add(d, pmt::mp("hermes_version"), pmt::from_long(t.hermes_version));
+	d = pmt::dict_add(d, pmt::mp("ain1"), pmt::from_long(t.ain1));
+	d = pmt::dict_add(d, pmt::mp("ain2"), pmt::from_long(t.ain2));
+	d = pmt::dict_add(d, pmt::mp("ain3"), pmt::from_long(t.ain3));
+	d = pmt::dict_add(d, pmt::mp("ain4"), pmt::from_long(t.ain4));
+	d = pmt::dict_add(d, pmt::mp("ain5"), pmt::from_long(t.ain5));
+	d = pmt::dict_add(d, pmt::mp("ain6"), pmt::from_long(t.ain6));
+
+	return d;
+};
+
+void TelemetryMonitor::Print(const gr::hpsdr::hermes_telemetry & t)
+{
+	fprintf(stderr, "AlexFwdPwr = %4.1f  AlexRevPwr = %4.1f   ", t.forward_power, t.reverse_power);
+	// report SWR if forward power is non-zero
+	if (static_cast<int>(t.forward_power) != 0)
+	  fprintf(stderr, "SWR = %.2f:1   ", t.swr);
+	fprintf(stderr, "ADCOver: %d  HermesVersion: %d (dec)  %X (hex)\n", t.adc_overload,
+		t.hermes_version, t.hermes_version);
+};
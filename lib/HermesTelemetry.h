@@ -0,0 +1,82 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// HermesTelemetry.h
+//
+// Decodes the Hermes status registers for hermesNB. The metis Rx thread
+// only latches the raw C1..C4 bytes (HermesCore::LatchStatus); this class
+// turns them into forward and reverse power and SWR, on a thread of its
+// own at reduced priority. Every TELEMETRYSECONDS it publishes them on the
+// block's "telemetry" message port and, in Verbose mode, prints them.
+//
+// As with StatsMonitor, the block deletes the proxy in stop(), so Stop()
+// decodes a final copy and get_telemetry() keeps returning it.
+//
+// Version:  October 2026
+
+#include <gnuradio/basic_block.h>
+#include <pmt/pmt.h>
+#include <hpsdr/hermes_stats.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#ifndef HermesTelemetry_H
+#define HermesTelemetry_H
+
+#define TELEMETRYSECONDS 1.0		// seconds between decodes
+#define TELEMETRYNICE	10		// nice value of the telemetry thread
+
+class HermesCore;
+
+class TelemetryMonitor
+{
+
+private:
+
+	gr::basic_block* Block;		// owner of the "telemetry" port
+	HermesCore* Proxy;		// NULL once the proxy is gone
+	gr::hpsdr::hermes_telemetry Last;	// final copy after Stop()
+
+	std::mutex Lock;		// guards Proxy, Last and Running
+	std::condition_variable Wake;
+	std::thread Thread;
+	bool Running;
+
+	void Run();			// telemetry thread
+
+public:
+
+	TelemetryMonitor(gr::basic_block* Blk, HermesCore* Prx);
+	~TelemetryMonitor();
+
+	void Start();			// start decoding and publishing
+	void Stop();			// stop, keep a final copy, forget the proxy
+
+	gr::hpsdr::hermes_telemetry Snapshot();	// decoded now, or the final copy
+
+	static void Decode(HermesCore* Prx, gr::hpsdr::hermes_telemetry &);
+	static double SWR(double Fwd, double Rev);	// 0 if no forward power, 99.9 if anomalous
+	static pmt::pmt_t ToDict(const gr::hpsdr::hermes_telemetry &);
+	static void Print(const gr::hpsdr::hermes_telemetry &);	// the Verbose line
+
+};
+
+#endif  // #ifndef HermesTelemetry_H
@@ -0,0 +1,65 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// HermesTrace.h
+//
+// USDT static tracepoints, provider "hpsdr". Built with -DENABLE_USDT=ON
+// (which needs sys/sdt.h, from systemtap-sdt-dev) each HPSDR_TRACE is a
+// nop instruction plus an ELF note that perf, bpftrace and systemtap can
+// attach to; otherwise the macros expand to nothing and their arguments
+// are not evaluated.
+//
+//   rx_frame(ep, seq, bytes, arrival_ns)	metis receive thread, each datagram
+//   rx_gap(expected, seq)			EP6/EP4 sequence number skipped ahead
+//   rx_commit(slot, fill, arrival_ns)		Rx ring slot handed to the work thread
+//   rx_drop(lost_rx_buf)			Rx ring full, data thrown away
+//   work_emit(block, items, fill)		general_work() output, block 0 = NB, 1 = WB
+//   tx_build(bank, queued)			Tx USB frame built, control bank C0
+//   tx_send(seq, bytes)			metis_send_buffer()
+//   control_change(bank, c1c4)			a control bank differs from the last one sent
+//
+// e.g.  bpftrace -e 'usdt:/usr/local/lib/libgnuradio-hpsdr.so:hpsdr:rx_gap { @[arg1 - arg0] = count(); }'
+//
+// Version:  October 2026
+
+#ifndef HermesTrace_H
+#define HermesTrace_H
+
+#ifdef HPSDR_USDT
+
+#include <sys/sdt.h>
+
+#define HPSDR_TRACE_ENABLED		1
+#define HPSDR_TRACE1(name, a)		DTRACE_PROBE1(hpsdr, name, a)
+#define HPSDR_TRACE2(name, a, b)	DTRACE_PROBE2(hpsdr, name, a, b)
+#define HPSDR_TRACE3(name, a, b, c)	DTRACE_PROBE3(hpsdr, name, a, b, c)
+#define HPSDR_TRACE4(name, a, b, c, d)	DTRACE_PROBE4(hpsdr, name, a, b, c, d)
+
+#else
+
+#define HPSDR_TRACE_ENABLED		0
+#define HPSDR_TRACE1(name, a)		do { } while (0)
+#define HPSDR_TRACE2(name, a, b)	do { } while (0)
+#define HPSDR_TRACE3(name, a, b, c)	do { } while (0)
+#define HPSDR_TRACE4(name, a, b, c, d)	do { } while (0)
+
+#endif  // HPSDR_USDT
+
+#endif  // #ifndef HermesTrace_H
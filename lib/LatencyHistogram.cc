@@ -0,0 +1,106 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// LatencyHistogram.cc
+//
+// Version:  October 2026
+
+#include "LatencyHistogram.h"
+
+
+LatencyHistogram::LatencyHistogram()
+{
+	Reset();
+};
+
+int LatencyHistogram::BucketOf(uint64_t Ns)
+{
+	if (Ns < LATENCYLINEAR)
+	  return (int)Ns;
+
+	int msb = 63 - __builtin_clzll(Ns);		// 4 and up
+	int sub = (int)(Ns >> (msb - 3)) & (LATENCYSUB - 1);
+	int index = LATENCYLINEAR + (msb - 4) * LATENCYSUB + sub;
+
+	return (index < LATENCYBUCKETS) ? index : LATENCYBUCKETS - 1;
+};
+
+double LatencyHistogram::BucketMid(int Index)
+{
+	if (Index < LATENCYLINEAR)
+	  return (double)Index;
+
+	int msb = 4 + (Index - LATENCYLINEAR) / LATENCYSUB;
+	int sub = (Index - LATENCYLINEAR) % LATENCYSUB;
+	double lower = (double)((uint64_t)(LATENCYSUB + sub) << (msb - 3));
+	double width = (double)(1ull << (msb - 3));
+
+	return lower + width / 2.0;
+};
+
+void LatencyHistogram::Reset()
+{
+	for (int i=0; i<LATENCYBUCKETS; i++)
+	  Bucket[i].store(0, std::memory_order_relaxed);
+	Samples.store(0, std::memory_order_relaxed);
+	Largest.store(0, std::memory_order_relaxed);
+};
+
+uint64_t LatencyHistogram::Count()
+{
+	return Samples.load(std::memory_order_relaxed);
+};
+
+uint64_t LatencyHistogram::Max()
+{
+	return Largest.load(std::memory_order_relaxed);
+};
+
+double LatencyHistogram::Percentile(double Pct)
+{
+	uint64_t counts[LATENCYBUCKETS];
+	uint64_t total = 0;
+
+	for (int i=0; i<LATENCYBUCKETS; i++)	// count from the buckets, not Samples,
+	{					// so the two always agree
+	  counts[i] = Bucket[i].load(std::memory_order_relaxed);
+	  total += counts[i];
+	}
+
+	if (total == 0)
+	  return 0.0;
+
+	if (Pct <= 0.0)
+	  Pct = 0.0;
+	if (Pct >= 100.0)
+	  return (double)Max();
+
+	double largest = (double)Max();
+	uint64_t rank = (uint64_t)(Pct / 100.0 * total);	// samples below the answer
+	uint64_t seen = 0;
+	for (int i=0; i<LATENCYBUCKETS; i++)
+	{
+	  seen += counts[i];
+	  if (seen > rank)		// never report more than the largest sample
+	    return (BucketMid(i) < largest) ? BucketMid(i) : largest;
+	}
+
+	return largest;
+};
@@ -0,0 +1,83 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// LatencyHistogram.h
+//
+// Log-bucketed latency histogram in nanoseconds. Below 16 ns each value
+// has its own bucket, above that each power of 2 is split into 8 buckets,
+// so a percentile is good to 1/16 (about 6%) from 16 ns up to 2^40 ns
+// (18 minutes). Anything longer lands in the last bucket.
+//
+// One thread adds samples, any thread may read percentiles while it does.
+// The buckets are relaxed atomics, so a reader sees each bucket current
+// but not all buckets at the same instant.
+//
+// Version:  October 2026
+
+#include <atomic>
+#include <stdint.h>
+#include <time.h>
+
+#ifndef LatencyHistogram_H
+#define LatencyHistogram_H
+
+#define LATENCYLINEAR	16		// buckets of 1 ns at the bottom
+#define LATENCYSUB	8		// buckets per power of 2 above that
+#define LATENCYBUCKETS	(LATENCYLINEAR + (40 - 4) * LATENCYSUB)
+
+static inline uint64_t MonotonicNs()	// host monotonic clock, ns
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+class LatencyHistogram
+{
+
+private:
+
+	std::atomic<uint64_t> Bucket[LATENCYBUCKETS];
+	std::atomic<uint64_t> Samples;
+	std::atomic<uint64_t> Largest;	// ns
+
+	static int BucketOf(uint64_t Ns);
+	static double BucketMid(int Index);	// representative value of a bucket, ns
+
+public:
+
+	LatencyHistogram();
+
+	void Add(uint64_t Ns)		// writer thread only
+	{
+	  Bucket[BucketOf(Ns)].fetch_add(1, std::memory_order_relaxed);
+	  Samples.fetch_add(1, std::memory_order_relaxed);
+	  if (Ns > Largest.load(std::memory_order_relaxed))
+	    Largest.store(Ns, std::memory_order_relaxed);
+	}
+
+	void Reset();			// clear, safe while the writer runs
+	uint64_t Count();		// samples added since the last Reset()
+	uint64_t Max();			// largest sample, ns
+	double Percentile(double Pct);	// ns, Pct 0..100, 0 if empty
+
+};
+
+#endif  // #ifndef LatencyHistogram_H
@@ -0,0 +1,153 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// NBDecimator.cc
+//
+// Decimating low pass filter for the hermesNB outputs. See NBDecimator.h.
+//
+// Version:  October 2026
+
+#include "NBDecimator.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_VOLK
+#include <volk/volk.h>
+#endif
+
+int NBDecimator::ParseFactor(const char* Spec, int Rx)
+{
+	if (Spec == NULL)
+	  return 1;
+
+	const char* p = Spec;
+	for (int i=0; i<Rx && p != NULL; i++)	// skip to entry Rx
+	{
+	  p = strchr(p, ',');
+	  if (p != NULL)
+	    p++;
+	}
+	if (p == NULL)
+	  return 1;
+
+	int f = atoi(p);
+	if (f < 1 || f > DECMAXFACTOR)
+	{
+	  if (f != 0)
+	    fprintf(stderr, "hermesNB: receiver %d decimation %d is not 1 to %d, not decimating\n",
+		    Rx, f, DECMAXFACTOR);
+	  return 1;
+	}
+	return f;
+}
+
+NBDecimator::NBDecimator(int Fac)
+{
+	Factor = Fac;
+	NumTaps = Factor * DECTAPSPERPHASE;
+
+	void* t = NULL;
+	void* h = NULL;
+	if (posix_memalign(&t, 64, NumTaps * sizeof(float)) != 0 ||
+	    posix_memalign(&h, 64, (NumTaps - 1 + DECBLOCK) * sizeof(gr_complex)) != 0)
+	{
+	  fprintf(stderr, "\nFATAL: unable to allocate the decimation filter.\n");
+	  exit(1);
+	}
+	Taps = (float*)t;
+	History = (gr_complex*)h;
+#ifndef HAVE_VOLK
+	TapsIQ = new float[2 * NumTaps];
+#endif
+
+	// Blackman windowed sinc, unity gain at DC
+
+	double fc = DECCUTOFF / Factor;		// cycles per input sample
+	double mid = (NumTaps - 1) / 2.0;
+	double sum = 0.0;
+	for (int i=0; i<NumTaps; i++)
+	{
+	  double x = i - mid;
+	  double sinc = (x == 0.0) ? 2.0 * fc : sin(2.0 * M_PI * fc * x) / (M_PI * x);
+	  double w = 0.42 - 0.5 * cos(2.0 * M_PI * i / (NumTaps - 1))
+			  + 0.08 * cos(4.0 * M_PI * i / (NumTaps - 1));
+	  Taps[i] = (float)(sinc * w);
+	  sum += Taps[i];
+	}
+	for (int i=0; i<NumTaps; i++)
+	  Taps[i] = (float)(Taps[i] / sum);
+#ifndef HAVE_VOLK
+	for (int i=0; i<NumTaps; i++)
+	  TapsIQ[2*i] = TapsIQ[2*i+1] = Taps[i];
+#endif
+
+	for (int i=0; i<NumTaps - 1 + DECBLOCK; i++)
+	  History[i] = gr_complex(0.0f, 0.0f);
+	Next = NumTaps - 1;
+}
+
+NBDecimator::~NBDecimator()
+{
+	free(Taps);
+	free(History);
+#ifndef HAVE_VOLK
+	delete [] TapsIQ;
+#endif
+}
+
+int NBDecimator::Decimate(const gr_complex* in, int n, gr_complex* out)
+{
+	int produced = 0;
+	int keep = NumTaps - 1;
+
+	while (n > 0)
+	{
+	  int take = (n < DECBLOCK) ? n : DECBLOCK;
+	  memcpy(&History[keep], in, take * sizeof(gr_complex));
+	  in += take;
+	  n -= take;
+
+	  for (; Next < keep + take; Next += Factor)
+	  {
+	    const gr_complex* x = &History[Next - keep];	// oldest input of this output
+#ifdef HAVE_VOLK
+	    volk_32fc_32f_dot_prod_32fc((lv_32fc_t*)&out[produced], (const lv_32fc_t*)x,
+					Taps, NumTaps);
+#else
+	    // I,Q times the doubled taps, in eight partial sums (2 * NumTaps is
+	    // a multiple of 8) that the compiler keeps in vector registers
+	    const float* xf = (const float*)x;
+	    float acc[8] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	    for (int i=0; i<2*NumTaps; i+=8)
+	      for (int k=0; k<8; k++)
+		acc[k] += xf[i + k] * TapsIQ[i + k];
+	    out[produced] = gr_complex(acc[0] + acc[2] + acc[4] + acc[6],
+				       acc[1] + acc[3] + acc[5] + acc[7]);
+#endif
+	    produced++;
+	  }
+
+	  memmove(&History[0], &History[take], keep * sizeof(gr_complex));	// last NumTaps-1 inputs
+	  Next -= take;
+	}
+	return produced;
+}
@@ -0,0 +1,78 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// NBDecimator.h
+//
+// Decimating low pass filter for one hermesNB receiver output, so a radio
+// run at 384 ksps for NCO agility can hand gnuradio 48 ksps (or less)
+// per channel without a decimating FIR block, and its buffers, on every
+// port.
+//
+// The filter is Blackman windowed sinc, DECTAPSPERPHASE taps per phase of
+// the Factor phase polyphase form, cut off at DECCUTOFF of the output
+// rate. Only the kept outputs are computed: each is one dot product of the
+// taps with the last Factor * DECTAPSPERPHASE inputs, which is all the
+// polyphase branches summed, done with VOLK where it is available.
+//
+// Response, as fractions of the output rate: flat to about 0.28, -6 dB
+// at DECCUTOFF, and -72 dB or better from about 0.52, so nothing aliases
+// back below 0.48.
+//
+// Version:  October 2026
+
+#ifndef NBDecimator_H
+#define NBDecimator_H
+
+#include <gnuradio/io_signature.h>
+
+#define DECTAPSPERPHASE	24		// filter taps per output sample
+#define DECCUTOFF	0.4		// -6 dB point, fraction of the output rate
+#define DECMAXFACTOR	64
+#define DECBLOCK	256		// inputs taken per pass
+
+class NBDecimator
+{
+
+private:
+
+	int Factor;			// inputs per output
+	int NumTaps;			// Factor * DECTAPSPERPHASE
+	float* Taps;			// reversed for the dot product (the filter is symmetric)
+#ifndef HAVE_VOLK
+	float* TapsIQ;			// each tap twice, for I and Q
+#endif
+	gr_complex* History;		// NumTaps-1 previous inputs, then DECBLOCK new ones
+	int Next;			// History index of the last input of the next output
+
+public:
+
+	// Receiver Rx's factor in Spec, a comma separated list with one entry
+	// per receiver ("8,8,4"). Missing entries are 1, no decimation.
+	static int ParseFactor(const char* Spec, int Rx);
+
+	NBDecimator(int Factor);
+	~NBDecimator();
+
+	int Decimate(const gr_complex* in, int n, gr_complex* out);	// outputs written,
+						// at most n / Factor + 1
+
+};
+
+#endif  // #ifndef NBDecimator_H
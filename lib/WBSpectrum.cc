@@ -0,0 +1,137 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2017 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// WBSpectrum.cc
+//
+// Welch power spectrum of the wideband ADC vectors. See WBSpectrum.h.
+//
+// Version:  October 2026
+
+#include "WBSpectrum.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdexcept>
+
+#define MINFFTSIZE	64
+#define MAXFFTSIZE	16384
+
+int WBSpectrum::OutputBins(int FFTSize)
+{
+	if (FFTSize == 0)
+	  return 0;				// spectrum mode off
+
+	if ((FFTSize < MINFFTSIZE) || (FFTSize > MAXFFTSIZE) || (FFTSize & (FFTSize - 1)))
+	{
+	  char msg[128];
+	  snprintf(msg, sizeof(msg), "hermesWB: FFT size %d must be a power of 2 from %d to %d",
+		   FFTSize, MINFFTSIZE, MAXFFTSIZE);
+	  throw std::runtime_error(msg);
+	}
+
+#ifdef HAVE_FFTW3F
+	return FFTSize / 2;
+#else
+	throw std::runtime_error("hermesWB: built without FFTW3f, spectrum mode is not available");
+#endif
+}
+
+WBSpectrum::WBSpectrum(int FFTSz, int OverlapPercent, int FFTAverage, int VectorSize)
+{
+	FFTSize = FFTSz;
+
+	if (OverlapPercent < 0) OverlapPercent = 0;
+	if (OverlapPercent > 90) OverlapPercent = 90;
+	Hop = FFTSize * (100 - OverlapPercent) / 100;
+	if (Hop < 1) Hop = 1;
+	NumSegments = 1 + (VectorSize - FFTSize) / Hop;
+
+	Average = (FFTAverage < 1) ? 1 : FFTAverage;
+	VectorCount = 0;
+
+	// 4-term Blackman-Harris: -92 dB sidelobes, enough for the 14 bit ADC
+
+	Window = new float[FFTSize];
+	double WindowSum = 0.0;
+	for (int i=0; i<FFTSize; i++)
+	{
+	  double x = 2.0 * M_PI * i / FFTSize;
+	  Window[i] = (float)(0.35875 - 0.48829 * cos(x) + 0.14128 * cos(2*x) - 0.01168 * cos(3*x));
+	  WindowSum += Window[i];
+	}
+
+	// A full scale sine has |X| = WindowSum/2 at its bin
+
+	Scale = (float)(4.0 / (WindowSum * WindowSum));
+
+	Accum = new float[FFTSize/2];
+	for (int i=0; i<FFTSize/2; i++)
+	  Accum[i] = 0.0f;
+
+#ifdef HAVE_FFTW3F
+	FFTIn = (float*)fftwf_malloc(FFTSize * sizeof(float));
+	FFTOut = (fftwf_complex*)fftwf_malloc((FFTSize/2 + 1) * sizeof(fftwf_complex));
+
+	// Planned once here, while the flowgraph is being built. FFTW planning
+	// is not thread safe; executing the plan from the work thread is.
+	Plan = fftwf_plan_dft_r2c_1d(FFTSize, FFTIn, FFTOut, FFTW_MEASURE);
+#endif
+}
+
+WBSpectrum::~WBSpectrum()
+{
+#ifdef HAVE_FFTW3F
+	fftwf_destroy_plan(Plan);
+	fftwf_free(FFTIn);
+	fftwf_free(FFTOut);
+#endif
+	delete[] Window;
+	delete[] Accum;
+}
+
+bool WBSpectrum::Accumulate(const float* vector)
+{
+#ifdef HAVE_FFTW3F
+	for (int seg=0; seg<NumSegments; seg++)
+	{
+	  const float* in = vector + seg * Hop;
+	  for (int i=0; i<FFTSize; i++)
+	    FFTIn[i] = in[i] * Window[i];
+
+	  fftwf_execute(Plan);
+
+	  for (int i=0; i<FFTSize/2; i++)
+	    Accum[i] += FFTOut[i][0] * FFTOut[i][0] + FFTOut[i][1] * FFTOut[i][1];
+	}
+#endif
+	return (++VectorCount >= Average);
+}
+
+void WBSpectrum::Output(float* out)
+{
+	float norm = Scale / (float)(VectorCount * NumSegments);
+
+	for (int i=0; i<FFTSize/2; i++)
+	{
+	  float p = Accum[i] * norm;
+	  out[i] = 10.0f * log10f(p + 1e-20f);	// floor at -200 dB, never log(0)
+	  Accum[i] = 0.0f;
+	}
+	VectorCount = 0;
+}
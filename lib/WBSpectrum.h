@@ -0,0 +1,76 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2017 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// WBSpectrum.h
+//
+// Welch power spectrum of the wideband ADC vectors, for hermesWB's
+// spectrum output mode. Each 16384 sample vector is split into
+// Blackman-Harris windowed segments of FFTSize samples with the requested
+// overlap. |X|^2 is averaged over all segments of FFTAverage vectors and
+// emitted as FFTSize/2 bins in dBFS (a full scale sine reads 0 dB), DC
+// first. Consecutive vectors are not time contiguous, so segments never
+// span two vectors.
+//
+// Version:  October 2026
+
+#ifndef WBSpectrum_H
+#define WBSpectrum_H
+
+#ifdef HAVE_FFTW3F
+#include <fftw3.h>
+#endif
+
+class WBSpectrum
+{
+
+private:
+
+	int FFTSize;			// samples per FFT, integral power of 2
+	int Hop;			// samples between segment starts
+	int NumSegments;		// segments per wideband vector
+	int Average;			// vectors averaged per output spectrum
+	int VectorCount;		// vectors accumulated so far
+
+	float* Window;			// FFTSize window coefficients
+	float* Accum;			// FFTSize/2 accumulated |X|^2
+	float Scale;			// dBFS normalisation for one segment
+
+#ifdef HAVE_FFTW3F
+	float* FFTIn;			// windowed segment
+	fftwf_complex* FFTOut;		// FFTSize/2+1 bins
+	fftwf_plan Plan;
+#endif
+
+public:
+
+	// Floats in one output spectrum, 0 for FFTSize 0 (spectrum mode off).
+	// Throws std::runtime_error if FFTSize is not usable, or FFTW is not
+	// available, rather than let the block change its output item size.
+	static int OutputBins(int FFTSize);
+
+	WBSpectrum(int FFTSize, int OverlapPercent, int FFTAverage, int VectorSize);
+	~WBSpectrum();
+
+	bool Accumulate(const float* vector);	// add one vector, true when a spectrum is ready
+	void Output(float* out);		// write the averaged spectrum in dB, restart averaging
+
+};
+
+#endif  // #ifndef WBSpectrum_H
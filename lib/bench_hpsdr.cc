@@ -0,0 +1,538 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2017 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+//
+// bench-hpsdr
+//
+// Microbenchmark for the Rx and Tx hot paths. Each case runs over fixed
+// synthetic frames (same bytes every run) and reports ns per operation
+// and samples/s. The proxies run detached: metis_stub.cc replaces
+// metis.cc, so there is no discovery and no socket I/O.
+//
+// Usage:  bench-hpsdr [-n iterations] [-c cpu] [-j] [-r capture [-x receivers]]
+//
+//   -n  operations per case (default 1000000)
+//   -c  pin to this CPU before running (default: not pinned)
+//   -j  write JSON to stdout instead of the table, for comparing releases
+//   -r  also run the receive path over the EP6/EP4 frames of a capture
+//	 file (HermesRecorder), and print a checksum of the samples
+//   -x  receivers the capture was recorded with (default 1)
+//
+// Version:  October 2026
+//	     October 2026 - proxy, Tx and de-interleave cases, CPU pinning, JSON
+//	     October 2026 - capture replay case
+//	     October 2026 - sc16, WB short and receiver level cases
+//	     October 2026 - NB decimator cases
+//
+
+#include "HermesKernels.h"
+#include "HermesProxy.h"
+#include "HermesProxyW.h"
+#include "HermesReplay.h"
+#include "NBDecimator.h"
+#include "metis.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+#include <vector>
+
+HermesProxy* Hermes;			// normally defined by hermesNB_impl.cc
+HermesProxyW* HermesW;			// normally defined by hermesWB_impl.cc
+
+// ---------------- fixtures -----------------
+
+static unsigned char nbframe[1032];	// one synthetic EP6 Ethernet frame
+static unsigned char wbframe[1032];	// one synthetic EP4 Ethernet frame
+static float out[512];			// converted samples
+static gr_complex txin[63];		// one Tx USB frame of samples
+static gr_complex rxout[MAXRECEIVERS][80];	// de-interleave outputs
+static volatile float sink;		// keeps the compiler from dropping the work
+static std::vector<unsigned char> capframes;	// -r: EP6/EP4 frames, CAPTUREFRAME bytes each
+
+struct Result
+{
+	char name[40];
+	double ns;			// ns per operation
+	int samples;			// samples per operation (0 = not a sample kernel)
+};
+
+static std::vector<Result> results;	// one per case, in the order they ran
+
+static double now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void record(const char* name, double ns, int samples)
+{
+	Result r;
+	snprintf(r.name, sizeof(r.name), "%s", name);
+	r.ns = ns;
+	r.samples = samples;
+	results.push_back(r);
+}
+
+static void fill(unsigned char* frame, unsigned char ep)
+{
+	unsigned int lcg = 12345;		// fixed seed: identical frame every run
+	for (int i=8; i<1032; i++)
+	{
+	  lcg = lcg * 1103515245 + 12345;
+	  frame[i] = (unsigned char)(lcg >> 16);
+	}
+	frame[0] = 0xEF;
+	frame[1] = 0xFE;
+	frame[2] = 0x01;
+	frame[3] = ep;
+	frame[4] = frame[5] = frame[6] = frame[7] = 0;
+}
+
+static void set_sequence(unsigned char* frame, unsigned int seq)
+{
+	frame[4] = seq >> 24;
+	frame[5] = seq >> 16;
+	frame[6] = seq >> 8;
+	frame[7] = seq;
+}
+
+static void drain_rx(HermesCore* proxy)
+{
+	while (proxy->RxReadSlot() != NULL)
+	  proxy->RxRelease();
+}
+
+// ---------------- cases -----------------
+
+// ns per Ethernet frame (512 wideband samples)
+static double bench_convert(void (*kernel)(const unsigned char*, float*, int), long iterations)
+{
+	double start = now_ns();
+	for (long n=0; n<iterations; n++)
+	{
+	  kernel(&wbframe[8], &out[0], 256);		// first USB frame
+	  kernel(&wbframe[520], &out[256], 256);	// second USB frame
+	  sink += out[n & 511];
+	}
+	return (now_ns() - start) / iterations;
+}
+
+// ns per EP6 Ethernet frame, including taking the two slots off the ring
+static double bench_nb_receive(int nrx, long iterations)
+{
+	Hermes->NumReceivers = nrx;
+	for (int usb=8; usb<=520; usb+=512)
+	  nbframe[usb] = nbframe[usb+1] = nbframe[usb+2] = 0x7f;
+
+	double start = now_ns();
+	for (long n=0; n<iterations; n++)
+	{
+	  set_sequence(nbframe, (unsigned int)n + 1);
+	  Hermes->ReceiveRxIQ(nbframe, 0);
+	  drain_rx(Hermes);
+	}
+	return (now_ns() - start) / iterations;
+}
+
+// ns per Ethernet frame of 1 receiver samples (252 values)
+static double bench_unpack(long iterations)
+{
+	double start = now_ns();
+	for (long n=0; n<iterations; n++)
+	{
+	  float acc = 0.0f;
+	  for (int row=0; row<63; row++)
+	  {
+	    acc += Hermes->Unpack2C(&nbframe[16 + row*8]);
+	    acc += Hermes->Unpack2C(&nbframe[16 + row*8 + 3]);
+	    acc += Hermes->Unpack2C(&nbframe[528 + row*8]);
+	    acc += Hermes->Unpack2C(&nbframe[528 + row*8 + 3]);
+	  }
+	  sink += acc;
+	}
+	return (now_ns() - start) / iterations;
+}
+
+// ns per PutTxIQ() call (63 samples). The queue is drained untimed.
+static double bench_put_tx(long iterations)
+{
+	double total = 0.0;
+	long done = 0;
+	while (done < iterations)
+	{
+	  double start = now_ns();
+	  for (int i=0; i<NUMTXBUFS/2; i++)
+	    Hermes->PutTxIQ(txin, 63);
+	  total += now_ns() - start;
+	  done += NUMTXBUFS/2;
+
+	  while (Hermes->GetNextTxBuf() != NULL)	// fill, then
+	    ;
+	  for (int i=0; i<NUMTXBUFS; i++)		// empty the queue
+	    Hermes->SendTxIQ();
+	}
+	return total / done;
+}
+
+// ns per ScheduleTxFrame() call, queue refilled untimed
+static double bench_schedule_tx(int nrx, int rate, long iterations)
+{
+	Hermes->NumReceivers = nrx;
+	Hermes->RxSampleRate = rate;
+
+	double total = 0.0;
+	long done = 0;
+	unsigned long count = 0;
+	while (done < iterations)
+	{
+	  while (Hermes->GetNextTxBuf() != NULL)
+	    ;
+	  double start = now_ns();
+	  for (int i=0; i<NUMTXBUFS/2; i++)
+	    Hermes->ScheduleTxFrame(count++);
+	  total += now_ns() - start;
+	  done += NUMTXBUFS/2;
+	}
+	return total / done;
+}
+
+// ns per register bank
+static double bench_control_regs(long iterations)
+{
+	unsigned char buf[512];
+	double start = now_ns();
+	for (long n=0; n<iterations; n++)
+	{
+	  Hermes->BuildControlRegs((n % 12) * 2, buf);
+	  sink += buf[4 + (n & 3)];
+	}
+	return (now_ns() - start) / iterations;
+}
+
+// ns per EP4 Ethernet frame, vectors taken off the ring as they complete
+static double bench_wb_receive(long iterations)
+{
+	double start = now_ns();
+	for (long n=0; n<iterations; n++)
+	{
+	  set_sequence(wbframe, (unsigned int)n);
+	  HermesW->ReceiveRxIQ(wbframe, 0);
+	  if ((n & 0x1f) == 0x1f)
+	    drain_rx(HermesW);
+	}
+	return (now_ns() - start) / iterations;
+}
+
+// ns per NB ring slot copied to the output ports
+static double bench_deinterleave(int nrx, long iterations)
+{
+	static float slot[RXBUFSIZE];
+	void* ports[MAXRECEIVERS];
+	for (int i=0; i<RXBUFSIZE; i++)
+	  slot[i] = (float)i / RXBUFSIZE;
+	for (int rx=0; rx<MAXRECEIVERS; rx++)
+	  ports[rx] = rxout[rx];
+
+	int rows = Hermes->USBRowCount[nrx-1];
+	double start = now_ns();
+	for (long n=0; n<iterations; n++)
+	{
+	  DeinterleaveIQ(slot, ports, nrx, rows);
+	  sink += rxout[n % nrx][n % rows].real();
+	}
+	return (now_ns() - start) / iterations;
+}
+
+// the same for an sc16 slot
+static double bench_deinterleave16(int nrx, long iterations)
+{
+	static int16_t slot[RXBUFSIZE];
+	void* ports[MAXRECEIVERS];
+	for (int i=0; i<RXBUFSIZE; i++)
+	  slot[i] = (int16_t)i;
+	for (int rx=0; rx<MAXRECEIVERS; rx++)
+	  ports[rx] = rxout[rx];
+
+	int rows = Hermes->USBRowCount[nrx-1];
+	double start = now_ns();
+	for (long n=0; n<iterations; n++)
+	{
+	  DeinterleaveIQ16(slot, ports, nrx, rows);
+	  sink += ((int16_t*)rxout[n % nrx])[n % rows];
+	}
+	return (now_ns() - start) / iterations;
+}
+
+// ns per 63 samples (one rx1 USB frame) through one receiver's decimator
+static double bench_decimate(int factor, long iterations)
+{
+	NBDecimator dec(factor);
+	gr_complex in[63];
+	for (int i=0; i<63; i++)
+	  in[i] = gr_complex((float)i / 63, (float)-i / 63);
+
+	double start = now_ns();
+	for (long n=0; n<iterations; n++)
+	{
+	  int produced = dec.Decimate(in, 63, rxout[0]);
+	  sink += rxout[0][produced > 0 ? produced - 1 : 0].real();
+	}
+	return (now_ns() - start) / iterations;
+}
+
+// Samples of each ring slot folded into a 64 bit FNV-1a hash
+static void drain_sum(HermesCore* proxy, int floats, uint64_t* sum)
+{
+	IQBuf_t slot;
+	while ((slot = proxy->RxReadSlot()) != NULL)
+	{
+	  const unsigned char* p = (const unsigned char*)slot;
+	  for (unsigned i=0; i<floats * sizeof(float); i++)
+	    *sum = (*sum ^ p[i]) * 1099511628211ull;
+	  proxy->RxRelease();
+	}
+}
+
+// One pass over the capture through fresh proxies, nothing timed, for the
+// checksum: it depends only on the capture and the receiver count.
+static uint64_t replay_checksum(int nrx)
+{
+	Hermes = new HermesProxy(7074000, 0, 0, 0, 0, 0, 0, 0, 7074000, 0,
+				 PTTOff, 0, 0, 0, 48000, "bench", "0xF8", 0, 0, 0x20, 0x10,
+				 0, nrx, "*");
+	HermesW = new HermesProxyW(0, "bench", "0xF8", 0, 0, 0x20, 0x10, "*", WBGapDrop);
+	Hermes->Start();
+
+	uint64_t sum = 14695981039346656037ull;
+	int nbfloats = 2 * Hermes->USBRowCount[nrx-1] * nrx;
+	for (size_t f=0; f<capframes.size(); f+=CAPTUREFRAME)
+	{
+	  unsigned char* frame = &capframes[f];
+	  if (frame[3] == 6)
+	  {
+	    Hermes->ReceiveRxIQ(frame, 0);
+	    drain_sum(Hermes, nbfloats, &sum);
+	  }
+	  else
+	  {
+	    HermesW->ReceiveRxIQ(frame, 0);
+	    drain_sum(HermesW, WBVECTORSIZE, &sum);
+	  }
+	}
+	return sum;
+}
+
+// ns per captured Ethernet frame, cycling through the capture
+static double bench_replay(long iterations)
+{
+	long frames = capframes.size() / CAPTUREFRAME;
+	double start = now_ns();
+	for (long n=0; n<iterations; n++)
+	{
+	  unsigned char* frame = &capframes[(n % frames) * CAPTUREFRAME];
+	  if (frame[3] == 6)
+	  {
+	    Hermes->ReceiveRxIQ(frame, 0);
+	    drain_rx(Hermes);
+	  }
+	  else
+	  {
+	    HermesW->ReceiveRxIQ(frame, 0);
+	    drain_rx(HermesW);
+	  }
+	}
+	return (now_ns() - start) / iterations;
+}
+
+static void load_capture(const char* path, long limit)
+{
+	CaptureFile capture;
+	if (!capture.Open(path))
+	  exit(1);
+
+	for (uint64_t n=0; n<capture.Records() && (long)(capframes.size() / CAPTUREFRAME) < limit; n++)
+	{
+	  const CaptureRecord* r = capture.Record(n);
+	  if (r->Length != CAPTUREFRAME || (r->Frame[3] != 6 && r->Frame[3] != 4))
+	    continue;
+	  capframes.insert(capframes.end(), r->Frame, r->Frame + CAPTUREFRAME);
+	}
+	if (capframes.empty())
+	{
+	  fprintf(stderr, "bench-hpsdr: no EP6 or EP4 frames in %s\n", path);
+	  exit(1);
+	}
+}
+
+// ---------------- main -----------------
+
+static void usage()
+{
+	fprintf(stderr, "usage: bench-hpsdr [-n iterations] [-c cpu] [-j] [-r capture [-x receivers]]\n");
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	long iterations = 1000000;
+	int cpu = -1;
+	bool json = false;
+	const char* capture = NULL;
+	int capnrx = 1;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:c:jr:x:")) != -1)
+	{
+	  switch (opt)
+	  {
+	    case 'n': iterations = atol(optarg); break;
+	    case 'c': cpu = atoi(optarg); break;
+	    case 'j': json = true; break;
+	    case 'r': capture = optarg; break;
+	    case 'x': capnrx = atoi(optarg); break;
+	    default: usage();
+	  }
+	}
+	if (iterations < NUMTXBUFS || capnrx < 1 || capnrx > MAXRECEIVERS)
+	  usage();
+	if (capture != NULL)
+	  load_capture(capture, iterations);
+
+	if (cpu >= 0)
+	{
+	  cpu_set_t set;
+	  CPU_ZERO(&set);
+	  CPU_SET(cpu, &set);
+	  if (sched_setaffinity(0, sizeof(set), &set) != 0)
+	  {
+	    perror("bench-hpsdr: sched_setaffinity");
+	    return 1;
+	  }
+	}
+
+	fill(nbframe, 0x06);
+	fill(wbframe, 0x04);
+	for (int i=0; i<63; i++)
+	  txin[i] = gr_complex(0.5f * (i & 7) / 7.0f, -0.25f);
+
+	Hermes = new HermesProxy(7074000, 0, 0, 0, 0, 0, 0, 0, 7074000, 0,
+				 PTTOff, 0, 0, 0, 48000, "bench", "0xF8", 0, 0, 0x20, 0x10,
+				 0, 1, "*");
+	HermesW = new HermesProxyW(0, "bench", "0xF8", 0, 0, 0x20, 0x10, "*", WBGapDrop);
+	Hermes->Start();
+
+	double generic = bench_convert(ConvertADC16_generic, iterations);
+	record("ConvertADC16_generic", generic, 512);
+	record("ConvertADC16", bench_convert(ConvertADC16, iterations), 512);
+
+	char name[40];
+	for (int nrx=1; nrx<=MAXRECEIVERS; nrx++)
+	{
+	  snprintf(name, sizeof(name), "NB.ReceiveRxIQ.rx%d", nrx);
+	  record(name, bench_nb_receive(nrx, iterations), 2 * Hermes->USBRowCount[nrx-1] * nrx);
+	}
+	Hermes->NumReceivers = 1;
+	record("NB.Unpack2C", bench_unpack(iterations), 252);
+
+	for (int nrx=1; nrx<=MAXRECEIVERS; nrx++)
+	{
+	  snprintf(name, sizeof(name), "NB.DeinterleaveIQ.rx%d", nrx);
+	  record(name, bench_deinterleave(nrx, iterations), Hermes->USBRowCount[nrx-1] * nrx);
+	}
+
+	Hermes->OutputType = NBOutputSC16;	// hermesNB OutputType 1
+	for (int nrx=1; nrx<=MAXRECEIVERS; nrx*=4)
+	{
+	  snprintf(name, sizeof(name), "NB.ReceiveRxIQ.sc16.rx%d", nrx);
+	  record(name, bench_nb_receive(nrx, iterations), 2 * Hermes->USBRowCount[nrx-1] * nrx);
+	  snprintf(name, sizeof(name), "NB.DeinterleaveIQ16.rx%d", nrx);
+	  record(name, bench_deinterleave16(nrx, iterations), Hermes->USBRowCount[nrx-1] * nrx);
+	}
+	Hermes->OutputType = NBOutputFC32;
+
+	Hermes->LevelPeriod = 1.0;		// hermesNB LevelPeriod, levels in the unpack loop
+	for (int nrx=1; nrx<=MAXRECEIVERS; nrx*=4)
+	{
+	  snprintf(name, sizeof(name), "NB.ReceiveRxIQ.level.rx%d", nrx);
+	  record(name, bench_nb_receive(nrx, iterations), 2 * Hermes->USBRowCount[nrx-1] * nrx);
+	}
+	Hermes->LevelPeriod = 0.0;
+	Hermes->NumReceivers = 1;
+
+	for (int factor=2; factor<=8; factor*=2)	// hermesNB Decimation
+	{
+	  snprintf(name, sizeof(name), "NB.Decimate.%d", factor);
+	  record(name, bench_decimate(factor, iterations), 63);
+	}
+
+	record("Tx.PutTxIQ", bench_put_tx(iterations), 63);
+	record("Tx.ScheduleTxFrame.rx1.48k", bench_schedule_tx(1, 48000, iterations), 0);
+	record("Tx.ScheduleTxFrame.rx4.192k", bench_schedule_tx(4, 192000, iterations), 0);
+	record("Tx.BuildControlRegs", bench_control_regs(iterations), 0);
+
+	record("WB.ReceiveRxIQ", bench_wb_receive(iterations), 512);
+	HermesW->OutputType = WBOutputShort;	// hermesWB OutputType 1
+	record("WB.ReceiveRxIQ.short", bench_wb_receive(iterations), 512);
+	HermesW->OutputType = WBOutputFloat;
+
+	uint64_t checksum = 0;
+	if (capture != NULL)
+	{
+	  checksum = replay_checksum(capnrx);
+	  record("Replay.ReceiveRxIQ", bench_replay(iterations), 0);
+	}
+
+	if (json)
+	{
+	  printf("{\n  \"bench\": \"bench-hpsdr\",\n  \"iterations\": %ld,\n  \"cpu\": %d,\n  \"results\": [\n",
+		 iterations, cpu);
+	  for (size_t i=0; i<results.size(); i++)
+	    printf("    { \"name\": \"%s\", \"ns_per_op\": %.2f, \"samples_per_op\": %d, \"msamples_per_s\": %.2f }%s\n",
+		   results[i].name, results[i].ns, results[i].samples,
+		   results[i].samples ? results[i].samples * 1e3 / results[i].ns : 0.0,
+		   (i == results.size()-1) ? "" : ",");
+	  printf("  ]");
+	  if (capture != NULL)
+	    printf(",\n  \"replay_frames\": %lu,\n  \"replay_checksum\": \"%016llx\"",
+		   (unsigned long)(capframes.size() / CAPTUREFRAME), (unsigned long long)checksum);
+	  printf("\n}\n");
+	}
+	else
+	{
+	  printf("%-30s %12s %14s\n", "case", "ns/op", "Msamples/s");
+	  for (size_t i=0; i<results.size(); i++)
+	    if (results[i].samples)
+	      printf("%-30s %12.1f %14.1f\n", results[i].name, results[i].ns,
+		     results[i].samples * 1e3 / results[i].ns);
+	    else
+	      printf("%-30s %12.1f %14s\n", results[i].name, results[i].ns, "-");
+	  printf("ConvertADC16 speedup: %.2fx\n", generic / results[1].ns);
+	  if (capture != NULL)
+	    printf("Replay: %lu frames, checksum %016llx\n",
+		   (unsigned long)(capframes.size() / CAPTUREFRAME), (unsigned long long)checksum);
+	}
+
+	// no delete: the proxy destructors print statistics to stderr
+	return 0;
+}
@@ -27,6 +27,24 @@
 //		256 sample buffers to gnuradio, rather each stream
 //		contains a smaller number of samples dependent on
 //		the number of receivers.
+//
+// October 2026 - de-interleave moved to DeinterleaveIQ() in
+//		HermesKernels so bench-hpsdr can time it.
+//
+// October 2026 - get_stats(), get_latency() and a periodic "stats" message port.
+// October 2026 - get_telemetry() and a "telemetry" message port, status decoded off the Rx thread.
+// October 2026 - work_emit tracepoint.
+// October 2026 - IOBackend selects sockets or io_uring for the metis socket.
+// October 2026 - IOBackend 2, AF_XDP.
+// October 2026 - BusyPollUs and RxCore for the receive thread.
+// October 2026 - RecordFile, raw frame capture.
+// October 2026 - ReplayFile, a capture in place of the radio; WORK_DONE at its end.
+// October 2026 - SigMFFile, SigMF recording of the receiver outputs.
+// October 2026 - OutputType, sc16 and sc32 outputs unpacked straight from
+//		the 24 bit samples.
+// October 2026 - LevelPeriod, get_level() and a "level" message port, measured
+//		in the unpack loop; DCRemove.
+// October 2026 - Decimation, a decimating filter per receiver output (NBDecimator).
 // -----------------------------------------------------------------
 
 #ifdef HAVE_CONFIG_H
@@ -37,9 +55,39 @@
 #include "hermesNB_impl.h"
 
 #include "HermesProxy.h"
+#include "metis.h"
+#include "HermesKernels.h"
+#include "HermesStats.h"
+#include "HermesTelemetry.h"
+#include "HermesSigMF.h"
+#include "NBDecimator.h"
+#include "HermesTrace.h"
 #include <stdio.h>	// for DEBUG PRINTF's
+#include <cstring>
+#include <mutex>
+#include <vector>
 
 HermesProxy* Hermes;	// make it visible to metis.cc
+static StatsMonitor* NBStats;	// counters for get_stats() and the "stats" port
+static TelemetryMonitor* NBTelemetry;	// status for get_telemetry() and the "telemetry" port
+static SigMFWriter* NBSigMF;	// SigMF recording of the outputs, NULL for none
+static gr::hpsdr::hermes_level NBLevel[MAXRECEIVERS];	// for get_level(), kept after stop()
+static std::mutex NBLevelLock;	// guards NBLevel
+
+static int output_type(int OutputType)	// NBOutput_t, complex float if out of range
+{
+	return (OutputType == NBOutputSC16 || OutputType == NBOutputSC32) ? OutputType : NBOutputFC32;
+}
+
+static int output_bytes(int OutputType)	// bytes per output item
+{
+	switch (output_type(OutputType))
+	{
+	  case NBOutputSC16:	return 2 * sizeof(int16_t);
+	  case NBOutputSC32:	return 2 * sizeof(int32_t);
+	  default:		return sizeof(gr_complex);
+	}
+}
 
 
 namespace gr {
@@ -53,13 +101,21 @@ namespace gr {
 			 unsigned char TxDr, int RxSmp, const char* Intfc, 
 			 const char * ClkS, int AlexRA, int AlexTA,
 			 int AlexHPF, int AlexLPF, int Verbose, int NumRx,
-			 const char* MACAddr)
+			 const char* MACAddr, float StatsPeriod, int IOBackend,
+			 int BusyPollUs, int RxCore, const char* RecordFile,
+			 const char* ReplayFile, float ReplaySpeed, float ReplayStart,
+			 const char* SigMFFile, int SigMFFormat, int OutputType,
+			 int SC16Shift, int SC16Round, float LevelPeriod, int DCRemove,
+			 const char* Decimation)
     {
       return gnuradio::get_initial_sptr
         (new hermesNB_impl(RxFreq0, RxFreq1, RxFreq2, RxFreq3, RxFreq4, RxFreq5,
 			RxFreq6, RxFreq7, TxFreq, RxPre, PTTModeSel, PTTTxMute,
 			PTTRxMute, TxDr, RxSmp, Intfc, ClkS, AlexRA, AlexTA,
-			AlexHPF, AlexLPF, Verbose, NumRx, MACAddr));
+			AlexHPF, AlexLPF, Verbose, NumRx, MACAddr, StatsPeriod, IOBackend,
+			BusyPollUs, RxCore, RecordFile, ReplayFile, ReplaySpeed, ReplayStart,
+			SigMFFile, SigMFFormat, OutputType, SC16Shift, SC16Round,
+			LevelPeriod, DCRemove, Decimation));
     }
 
     /*
@@ -72,15 +128,68 @@ namespace gr {
 			 unsigned char TxDr, int RxSmp, const char* Intfc, 
 			 const char * ClkS, int AlexRA, int AlexTA,
 			 int AlexHPF, int AlexLPF, int Verbose, int NumRx,
-			 const char* MACAddr)
+			 const char* MACAddr, float StatsPeriod, int IOBackend,
+			 int BusyPollUs, int RxCore, const char* RecordFile,
+			 const char* ReplayFile, float ReplaySpeed, float ReplayStart,
+			 const char* SigMFFile, int SigMFFormat, int OutputType,
+			 int SC16Shift, int SC16Round, float LevelPeriod, int DCRemove,
+			 const char* Decimation)
       : gr::block("hermesNB",
               gr::io_signature::make(1, 1, sizeof(gr_complex)),		// inputs to hermesNB block
-              gr::io_signature::make(1, MAXRECEIVERS, sizeof(gr_complex)) )	// outputs from hermesNB block
+              gr::io_signature::make(1, MAXRECEIVERS, output_bytes(OutputType)) )	// outputs from hermesNB block
     {
+	metis_set_backend(IOBackend);	// sockets, io_uring or AF_XDP, before discovery
+	metis_set_busy_poll(BusyPollUs, RxCore);
+	metis_set_record_file(RecordFile);
+	metis_set_replay(ReplayFile, ReplaySpeed, ReplayStart);
+
 	Hermes = new HermesProxy(RxFreq0, RxFreq1, RxFreq2, RxFreq3, RxFreq4,
 		 RxFreq5, RxFreq6, RxFreq7, TxFreq, RxPre, PTTModeSel, PTTTxMute,
 		 PTTRxMute, TxDr, RxSmp, Intfc, ClkS, AlexRA, AlexTA,
 		 AlexHPF, AlexLPF, Verbose, NumRx, MACAddr);	// Create proxy, do Hermes ethernet discovery
+	Hermes->OutputType = output_type(OutputType);
+	Hermes->SC16Shift = SC16Shift;
+	Hermes->SC16Round = (bool)SC16Round;
+	Hermes->LevelPeriod = (LevelPeriod > 0.0) ? LevelPeriod : 0.0;
+	Hermes->DCRemove = (bool)DCRemove;
+	if (DCRemove && LevelPeriod <= 0.0)
+	  fprintf(stderr, "hermesNB: DCRemove needs a LevelPeriod, no DC removal\n");
+
+	message_port_register_out(pmt::mp("stats"));
+	NBStats = new StatsMonitor(this, Hermes, StatsPeriod);
+	message_port_register_out(pmt::mp("telemetry"));
+	NBTelemetry = new TelemetryMonitor(this, Hermes);
+	message_port_register_out(pmt::mp("level"));
+	LevelSeen = 0;
+	for (int rx=0; rx<MAXRECEIVERS; rx++)
+	  NBLevel[rx] = hermes_level();
+
+	Decimating = false;
+	Decimator.assign(NumRx, (NBDecimator*)NULL);
+	DecimatorIn.assign(NumRx, (void*)NULL);
+	for (int rx=0; rx<NumRx; rx++)
+	{
+	  int factor = NBDecimator::ParseFactor(Decimation, rx);
+	  if (factor > 1)
+	  {
+	    Decimator[rx] = new NBDecimator(factor);
+	    Decimating = true;
+	  }
+	}
+	if (Decimating && Hermes->OutputType != NBOutputFC32)
+	{
+	  fprintf(stderr, "hermesNB: Decimation needs complex float outputs, not decimating\n");
+	  for (int rx=0; rx<NumRx; rx++)
+	    delete Decimator[rx];
+	  Decimator.assign(NumRx, (NBDecimator*)NULL);
+	  Decimating = false;
+	}
+	if (Decimating)
+	  for (int rx=0; rx<NumRx; rx++)
+	    DecimatorIn[rx] = new gr_complex[RXBUFSIZE / 2];
+	NBSigMF = NULL;
+	if (SigMFFile != NULL && SigMFFile[0] != 0)
+	  NBSigMF = new SigMFWriter(Hermes, SigMFFile, SigMFFormat, NumRx, Hermes->OutputType);
 	//Hermes->RxSampleRate = RxSmp;
 	//Hermes->RxPreamp = RxPre;
 
@@ -98,6 +207,11 @@ namespace gr {
     hermesNB_impl::~hermesNB_impl()
     {
 	//delete Hermes;
+	for (unsigned rx=0; rx<Decimator.size(); rx++)
+	{
+	  delete Decimator[rx];
+	  delete [] (gr_complex*)DecimatorIn[rx];
+	}
     }
 
 
@@ -105,6 +219,15 @@ namespace gr {
 bool hermesNB::stop()		// override base class
     {
 	Hermes->Stop();			// stop ethernet activity on Hermes
+	NBStats->Stop();		// keep the final counters for get_stats()
+	NBTelemetry->Stop();		// and the final status for get_telemetry()
+	if (NBSigMF != NULL)
+	  NBSigMF->Stop();		// write out the recording while the proxy is there
+	{
+	  std::lock_guard<std::mutex> lock(NBLevelLock);	// and the final levels
+	  for (int rx=0; rx<MAXRECEIVERS; rx++)
+	    Hermes->GetLevel(rx, NBLevel[rx]);
+	}
         delete Hermes;			// Stop is guaranteed to be called
 					// by gnuradio.
 	return gr::block::stop();	// call base class stop()
@@ -113,9 +236,54 @@ bool hermesNB::stop()		// override base class
 bool hermesNB::start()		// override base class
     {
 	Hermes->Start();		// start rx stream on Hermes
+	NBStats->Start();		// start publishing on the "stats" port
+	NBTelemetry->Start();		// decode status, publish on the "telemetry" port
+	if (NBSigMF != NULL)
+	  NBSigMF->Start();		// SigMF files, before the first samples
 	return gr::block::start();	// call base class start()
     }
 
+hermes_stats hermesNB::get_stats()
+    {
+	return NBStats->Snapshot();
+    }
+
+double hermesNB::get_latency(int stage, double percentile)
+    {
+	return NBStats->Latency(stage, percentile);
+    }
+
+void hermesNB::reset_latency()
+    {
+	NBStats->ResetLatency();
+    }
+
+hermes_telemetry hermesNB::get_telemetry()
+    {
+	return NBTelemetry->Snapshot();
+    }
+
+hermes_level hermesNB::get_level(int rx)
+    {
+	std::lock_guard<std::mutex> lock(NBLevelLock);
+	return (rx >= 0 && rx < MAXRECEIVERS) ? NBLevel[rx] : hermes_level();
+    }
+
+double hermesNB::get_forward_power()
+    {
+	return NBTelemetry->Snapshot().forward_power;
+    }
+
+double hermesNB::get_reverse_power()
+    {
+	return NBTelemetry->Snapshot().reverse_power;
+    }
+
+double hermesNB::get_swr()
+    {
+	return NBTelemetry->Snapshot().swr;
+    }
+
 void hermesNB::set_Receive0Frequency (float Rx0F) // callback to allow slider to set frequency
     {
 	Hermes->Receive0Frequency = (unsigned)Rx0F;	// slider must be of type real, convert to unsigned
@@ -224,6 +392,39 @@ void hermesNB::set_Verbose(int Verb)		// callback to turn Verbose mode on or off
 	Hermes->Verbose = Verb;
 }
 
+// Latest level window of every receiver to get_level() and the "level"
+// port, one dict per window with a vector entry per figure, receiver 0
+// first.
+
+void hermesNB_impl::PublishLevel(int NumRx)
+{
+	std::vector<double> power(NumRx), peak(NumRx), dci(NumRx), dcq(NumRx);
+	hermes_level l;
+
+	LevelSeen = Hermes->LevelWindows();
+	{
+	  std::lock_guard<std::mutex> lock(NBLevelLock);
+	  for (int rx=0; rx<NumRx; rx++)
+	  {
+	    Hermes->GetLevel(rx, l);
+	    NBLevel[rx] = l;
+	    power[rx] = l.power_dbfs;
+	    peak[rx] = l.peak_dbfs;
+	    dci[rx] = l.dc_i;
+	    dcq[rx] = l.dc_q;
+	  }
+	}
+
+	pmt::pmt_t d = pmt::make_dict();
+	d = pmt::dict_add(d, pmt::mp("windows"), pmt::from_uint64(l.windows));
+	d = pmt::dict_add(d, pmt::mp("samples"), pmt::from_uint64(l.samples));
+	d = pmt::dict_add(d, pmt::mp("power_dbfs"), pmt::init_f64vector(NumRx, power));
+	d = pmt::dict_add(d, pmt::mp("peak_dbfs"), pmt::init_f64vector(NumRx, peak));
+	d = pmt::dict_add(d, pmt::mp("dc_i"), pmt::init_f64vector(NumRx, dci));
+	d = pmt::dict_add(d, pmt::mp("dc_q"), pmt::init_f64vector(NumRx, dcq));
+	message_port_pub(pmt::mp("level"), d);
+}
+
 void hermesNB_impl::forecast (int noutput_items, gr_vector_int &ninput_items_required)
     {
         /* <+forecast+> e.g. ninput_items_required[0] = noutput_items */
@@ -256,18 +457,56 @@ int hermesNB_impl::general_work (int noutput_items,
 
 	IQBuf_t Rx;
 	int NumRx = Hermes->NumReceivers;
+	bool ended = metis_replay_done();	// before the ring: the last frame is in it by then
 
-        if( (Rx = Hermes->GetRxIQ()) == NULL)	//no more available from the radio
-            return(0);				// tell gnuradio we did not produce any samples
+        if( (Rx = Hermes->RxReadSlot()) == NULL)	//no more available from the radio
+            return(ended ? WORK_DONE : 0);	// tell gnuradio we did not produce any samples
 
 	int SamplesPerRx = Hermes->USBRowCount[NumRx-1];
 
 	// Send buffered complex samples to our block's output port(s)
 
-	for (int index=0; index<SamplesPerRx; index++)
-	    for (int receiver=0; receiver < NumRx; receiver++)
-	        ((gr_complex *)output_items[receiver])[index] = gr_complex(*Rx++, *Rx++);
-
+	if (Decimating)
+	{
+	  // De-interleave to the filter inputs, then each receiver's own
+	  // number of outputs. SigMF records at the radio's rate.
+
+	  DeinterleaveIQ(Rx, &DecimatorIn[0], NumRx, SamplesPerRx);
+	  if (NBSigMF != NULL)
+	    NBSigMF->Write((const void* const*)&DecimatorIn[0], SamplesPerRx);
+
+	  for (int rx=0; rx<NumRx; rx++)
+	  {
+	    gr_complex* out = (gr_complex*)output_items[rx];
+	    if (Decimator[rx] != NULL)
+	      produce(rx, Decimator[rx]->Decimate((const gr_complex*)DecimatorIn[rx], SamplesPerRx, out));
+	    else
+	    {
+	      memcpy(out, DecimatorIn[rx], SamplesPerRx * sizeof(gr_complex));
+	      produce(rx, SamplesPerRx);
+	    }
+	  }
+
+	  Hermes->RxRelease();
+	  if (Hermes->LevelWindows() != LevelSeen)
+	    PublishLevel(NumRx);
+	  HPSDR_TRACE3(work_emit, 0, SamplesPerRx, Hermes->RxBufFillCount());
+	  return(WORK_CALLED_PRODUCE);
+	}
+
+	if (Hermes->OutputType == NBOutputSC16)
+	  DeinterleaveIQ16((const int16_t*)Rx, &output_items[0], NumRx, SamplesPerRx);
+	else if (Hermes->OutputType == NBOutputSC32)
+	  DeinterleaveIQ32((const int32_t*)Rx, &output_items[0], NumRx, SamplesPerRx);
+	else
+	  DeinterleaveIQ(Rx, &output_items[0], NumRx, SamplesPerRx);
+	if (NBSigMF != NULL)
+	  NBSigMF->Write((const void* const*)&output_items[0], SamplesPerRx);
+
+	Hermes->RxRelease();			// give the buffer back to the Rx thread
+	if (Hermes->LevelWindows() != LevelSeen)
+	  PublishLevel(NumRx);
+	HPSDR_TRACE3(work_emit, 0, SamplesPerRx, Hermes->RxBufFillCount());
 
 	return(SamplesPerRx);
 
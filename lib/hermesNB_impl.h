@@ -22,6 +22,9 @@
 #define INCLUDED_HPSDR_HERMESNB_IMPL_H
 
 #include <hpsdr/hermesNB.h>
+#include <vector>
+
+class NBDecimator;
 
 namespace gr {
   namespace hpsdr {
@@ -29,7 +32,12 @@ namespace gr {
     class hermesNB_impl : public hermesNB
     {
      private:
-      // Nothing to declare in this block.
+      unsigned long LevelSeen;	// level windows published on the "level" port
+      bool Decimating;		// some receiver has a Decimation factor
+      std::vector<NBDecimator*> Decimator;	// per receiver, NULL for none
+      std::vector<void*> DecimatorIn;	// per receiver, gr_complex samples before decimation
+
+      void PublishLevel(int NumRx);
 
      public:
 
@@ -53,6 +61,27 @@ namespace gr {
  * \param Verbose  Turns Verbose mode on (=1) or off (=0)
  * \param NumRx  Number of Receivers (1 or 2)
  * \param MACAddr MAC Address of target or * for first detected
+ * \param StatsPeriod  Seconds between "stats" messages, 0 for none
+ * \param IOBackend  Network I/O: sockets (0), io_uring (1) or AF_XDP (2),
+ *		     falls back to sockets
+ * \param BusyPollUs  Microseconds the receive thread spins on the socket
+ *		      before it blocks, 0 to always block
+ * \param RxCore  CPU to pin the receive thread to, -1 for any
+ * \param RecordFile  Capture file for every EP6/EP4 frame received, "" for none
+ * \param ReplayFile  Capture file to play in place of the radio, "" for the radio
+ * \param ReplaySpeed  Replay speed, 1 as recorded, 0 as fast as the flowgraph runs
+ * \param ReplayStart  Seconds into the capture to start the replay
+ * \param SigMFFile  Base name of a SigMF recording of each receiver, "" for none
+ * \param SigMFFormat  SigMF samples: ci16_le (0) or cf32_le (1)
+ * \param OutputType  Output items: complex float (0), sc16 (1) or sc32 (2)
+ * \param SC16Shift  sc16: bits dropped from the 24 bit samples, 0..8
+ * \param SC16Round  sc16: round (1) or truncate (0) the dropped bits
+ * \param LevelPeriod  Seconds per receiver level window ("level" port,
+ *		       get_level()), 0 for none
+ * \param DCRemove  Subtract each receiver's mean I, Q of the last level
+ *		    window from its samples (needs LevelPeriod)
+ * \param Decimation  Decimation factor of each receiver output, comma
+ *		      separated ("8,8,4"), "" or 1 for none; complex float only
  *
  */
       hermesNB_impl(int RxFreq0, int RxFreq1, int RxFreq2, int RxFreq3,
@@ -62,7 +91,12 @@ namespace gr {
 			 unsigned char TxDr, int RxSmp, const char* Intfc, 
 			 const char * ClkS, int AlexRA, int AlexTA,
 			 int AlexHPF, int AlexLPF, int Verbose, int NumRx,
-			 const char* MACAddr);
+			 const char* MACAddr, float StatsPeriod, int IOBackend,
+			 int BusyPollUs, int RxCore, const char* RecordFile,
+			 const char* ReplayFile, float ReplaySpeed, float ReplayStart,
+			 const char* SigMFFile, int SigMFFormat, int OutputType,
+			 int SC16Shift, int SC16Round, float LevelPeriod, int DCRemove,
+			 const char* Decimation);
       ~hermesNB_impl();
 
       // Where all the action really happens
@@ -22,6 +22,17 @@
 // Additions for ALEX friendly registers 03/01/2015
 // On the alex branch.
 // -----------------------------------------------------------------
+// October 2026 - optional Welch power spectrum output (FFTSize != 0)
+// October 2026 - get_stats(), get_latency() and a periodic "stats" message port
+// October 2026 - work_emit tracepoint
+// October 2026 - IOBackend selects sockets or io_uring for the metis socket
+// October 2026 - IOBackend 2, AF_XDP
+// October 2026 - BusyPollUs and RxCore for the receive thread
+// October 2026 - RecordFile, raw frame capture
+// October 2026 - ReplayFile, a capture in place of the radio; WORK_DONE at its end
+// October 2026 - OutputType 1, raw vectors of int16 ADC samples
+// October 2026 - an unusable FFTSize throws instead of sending raw vectors
+// -----------------------------------------------------------------
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -31,10 +42,24 @@
 #include "hermesWB_impl.h"
 
 #include "HermesProxyW.h"
+#include "metis.h"
+#include "HermesStats.h"
+#include "HermesTrace.h"
 #include <stdio.h>	// for DEBUG PRINTF's
+#include <cstring>
 
 
 HermesProxyW* HermesW;	// make it visible to metis.cc
+static StatsMonitor* WBStats;	// counters for get_stats() and the "stats" port
+
+static int output_bytes(int SpectrumBins, int OutputType)	// bytes per output item
+{
+	if (SpectrumBins != 0)
+	  return SpectrumBins * sizeof(float);		// spectra are always float
+	if (OutputType == WBOutputShort)
+	  return WBVECTORSIZE * sizeof(int16_t);
+	return WBVECTORSIZE * sizeof(float);
+}
 
 namespace gr {
   namespace hpsdr {
@@ -42,10 +67,16 @@ namespace gr {
     hermesWB::sptr
     hermesWB::make(int RxPre, const char* Intfc, const char * ClkS,
 		   int AlexRA, int AlexTA, int AlexHPF, int AlexLPF,
-		   const char* MACAddr)
+		   const char* MACAddr, int GapPolicy,
+		   int FFTSize, int FFTOverlap, int FFTAverage, float StatsPeriod, int IOBackend,
+			 int BusyPollUs, int RxCore, const char* RecordFile,
+			 const char* ReplayFile, float ReplaySpeed, float ReplayStart,
+			 int OutputType)
     {
       return gnuradio::get_initial_sptr
-        (new hermesWB_impl(RxPre, Intfc, ClkS, AlexRA, AlexTA, AlexHPF, AlexLPF, MACAddr));
+        (new hermesWB_impl(RxPre, Intfc, ClkS, AlexRA, AlexTA, AlexHPF, AlexLPF, MACAddr, GapPolicy,
+			   FFTSize, FFTOverlap, FFTAverage, StatsPeriod, IOBackend, BusyPollUs, RxCore,
+			   RecordFile, ReplayFile, ReplaySpeed, ReplayStart, OutputType));
     }
 
     /*
@@ -53,12 +84,38 @@ namespace gr {
      */
     hermesWB_impl::hermesWB_impl(int RxPre, const char* Intfc, const char * ClkS,
 			 int AlexRA, int AlexTA, int AlexHPF, int AlexLPF,
-			 const char* MACAddr)
+			 const char* MACAddr, int GapPolicy,
+			 int FFTSize, int FFTOverlap, int FFTAverage, float StatsPeriod, int IOBackend,
+			 int BusyPollUs, int RxCore, const char* RecordFile,
+			 const char* ReplayFile, float ReplaySpeed, float ReplayStart,
+			 int OutputType)
       : gr::block("hermesWB",
               gr::io_signature::make(0, 0, 0),				// No inputs to hermesWB block
-              gr::io_signature::make(1, 1, 16384 * sizeof(float)) )	// output from hermesWB block
+              gr::io_signature::make(1, 1,
+		output_bytes(WBSpectrum::OutputBins(FFTSize), OutputType)) )	// output from hermesWB block
     {
-	HermesW = new HermesProxyW(RxPre, Intfc, ClkS, AlexRA, AlexTA, AlexHPF, AlexLPF, MACAddr);	// Create proxy, do Hermes ethernet discovery
+	int bins = WBSpectrum::OutputBins(FFTSize);	// validated above, throws if unusable
+	Shorts = (bins == 0) && (OutputType == WBOutputShort);
+	if (OutputType == WBOutputShort && !Shorts)
+	  fprintf(stderr, "hermesWB: spectrum output is float, OutputType ignored\n");
+	SpectrumBins = (bins != 0) ? bins : WBVECTORSIZE;
+	SpectrumMissing = 0;
+	if (bins != 0)
+	  Spectrum = new WBSpectrum(FFTSize, FFTOverlap, FFTAverage, WBVECTORSIZE);
+	else
+	  Spectrum = NULL;
+
+	metis_set_backend(IOBackend);	// sockets, io_uring or AF_XDP, before discovery
+	metis_set_busy_poll(BusyPollUs, RxCore);
+	metis_set_record_file(RecordFile);
+	metis_set_replay(ReplayFile, ReplaySpeed, ReplayStart);
+
+	HermesW = new HermesProxyW(RxPre, Intfc, ClkS, AlexRA, AlexTA, AlexHPF, AlexLPF, MACAddr,
+				  GapPolicy);	// Create proxy, do Hermes ethernet discovery
+	HermesW->OutputType = Shorts ? WBOutputShort : WBOutputFloat;
+
+	message_port_register_out(pmt::mp("stats"));
+	WBStats = new StatsMonitor(this, HermesW, StatsPeriod);
     }
 
     /*
@@ -67,6 +124,7 @@ namespace gr {
     hermesWB_impl::~hermesWB_impl()
     {
 	// delete HermesW;
+	delete Spectrum;
     }
 
 
@@ -74,6 +132,7 @@ namespace gr {
 bool hermesWB::stop()		// override base class
     {
 	HermesW->Stop();		// stop ethernet activity on Hermes
+	WBStats->Stop();		// keep the final counters for get_stats()
 	delete HermesW;			// print stats, dispose buffers.
 	return gr::block::stop();	// call base class stop()
     }
@@ -81,9 +140,25 @@ bool hermesWB::stop()		// override base class
 bool hermesWB::start()		// override base class
     {
 	HermesW->Start();		// start rx stream on Hermes
+	WBStats->Start();		// start publishing on the "stats" port
 	return gr::block::start();	// call base class start()
     }
 
+hermes_stats hermesWB::get_stats()
+    {
+	return WBStats->Snapshot();
+    }
+
+double hermesWB::get_latency(int stage, double percentile)
+    {
+	return WBStats->Latency(stage, percentile);
+    }
+
+void hermesWB::reset_latency()
+    {
+	WBStats->ResetLatency();
+    }
+
 
 void hermesWB::set_RxPreamp(int RxPre)	// callback to set RxPreamp on or off
     {
@@ -118,6 +193,11 @@ void hermesWB::set_AlexTxLPF(int LPF)		// callback to set Alex Tx Low Pass filte
 	HermesW->AlexTxLPF = LPF;
 }
 
+void hermesWB::set_GapPolicy(int Policy)	// callback to select drop or zero-fill of incomplete vectors
+{
+	HermesW->GapPolicy = Policy;
+}
+
 
 
 void hermesWB_impl::forecast (int noutput_items, gr_vector_int &ninput_items_required)
@@ -133,39 +213,63 @@ int hermesWB_impl::general_work (int noutput_items,
 
        float *out0 = (float *) output_items[0];		// WB Rcvr samples
     
-  // We always get 256 Real samples per USB frame (Read buffer) from HermesProxyW
-  //
-  // We need to send 16,384 floats to gnuradio as one item ( a vector).
-  // This requires aligning to the 64 receive buffers belonging to the same
-  // time sequence. If not aligned, then throw away buffers until aligned.
-  //
-
-	if (!HermesW->RxReadBufAligned())  	// not aligned - we have a problem
-     	  for (int i=0; i<63; i++)
+  // HermesProxyW assembles each 16,384 sample vector in one ring slot, so a
+  // complete vector is a single copy. Emit as many as are ready and fit.
+  // Zero-filled vectors are tagged "wb_gap" with the number of missing
+  // 512 sample frames.
+
+	int produced = 0;
+	IQBuf_t ReadBuf;
+	bool ended = metis_replay_done();	// before the ring: the last vector is in it by then
+
+	if (Spectrum != NULL)
+	{
+	  // Spectrum mode: every FFTAverage vectors become one SpectrumBins
+	  // spectrum. The tag carries the missing frames of all of them.
+
+	  while ((produced < noutput_items) && ((ReadBuf = HermesW->RxReadSlot()) != NULL))
 	  {
-	    if (HermesW->RxBufFillCount() == 0) // we're out of buffers, do nothing
-		return 0;	    
-	    IQBuf_t dummy = HermesW->GetNextRxReadBuf();  // consume a buffer
-	    if (HermesW->RxReadBufAligned())
-		return 0;
+	    SpectrumMissing += HermesW->RxReadMissing();
+	    bool ready = Spectrum->Accumulate(ReadBuf);
+	    HermesW->RxRelease();
+
+	    if (ready)
+	    {
+	      if (SpectrumMissing != 0)
+	        add_item_tag(0, nitems_written(0) + produced,
+			     pmt::mp("wb_gap"), pmt::from_long(SpectrumMissing));
+	      SpectrumMissing = 0;
+
+	      Spectrum->Output(out0);
+	      out0 += SpectrumBins;
+	      produced++;
+	    }
 	  }
-  	if (HermesW->RxBufFillCount() < 64)	// aligned but not enough buffers, do nothing
-	  return 0;
-
-   // aligned and have enough Read buffers - emit one complete vector to out0[]
+	  HPSDR_TRACE3(work_emit, 1, produced, HermesW->RxBufFillCount());
+	  if (produced == 0 && ended)
+	    return(WORK_DONE);
+	  return(produced);
+	}
 
-	IQBuf_t ReadBuf = HermesW->GetCurrentRxReadBuf();
-	IQBuf_t out = out0;
+	unsigned char* out = (unsigned char*)output_items[0];
+	size_t bytes = WBVECTORSIZE * (Shorts ? sizeof(int16_t) : sizeof(float));
 
-	for (int i=0; i<64; i++)
+	while ((produced < noutput_items) && ((ReadBuf = HermesW->RxReadSlot()) != NULL))
 	{
-//	  for (int j=0; j<256; j++)
-//	    out0[i*256+j] = ReadBuf[j];
-	  memcpy(out, ReadBuf, 256*sizeof(float));
-	  out += 256;  
-	  ReadBuf = HermesW->GetNextRxReadBuf();
+	  unsigned missing = HermesW->RxReadMissing();
+	  if (missing != 0)
+	    add_item_tag(0, nitems_written(0) + produced,
+			 pmt::mp("wb_gap"), pmt::from_long(missing));
+
+	  memcpy(out, ReadBuf, bytes);		// float or int16 vector
+	  HermesW->RxRelease();
+	  out += bytes;
+	  produced++;
 	}
-	return(1);
+	HPSDR_TRACE3(work_emit, 1, produced, HermesW->RxBufFillCount());
+	if (produced == 0 && ended)
+	  return(WORK_DONE);
+	return(produced);
 
 
     }	// general_work
@@ -22,6 +22,7 @@
 #define INCLUDED_HPSDR_HERMESWB_IMPL_H
 
 #include <hpsdr/hermesWB.h>
+#include "WBSpectrum.h"
 
 namespace gr {
   namespace hpsdr {
@@ -29,7 +30,10 @@ namespace gr {
     class hermesWB_impl : public hermesWB
     {
      private:
-      // Nothing to declare in this block.
+      WBSpectrum* Spectrum;	// NULL when sending raw vectors
+      int SpectrumBins;		// floats per output item in spectrum mode
+      unsigned SpectrumMissing;	// missing frames in the vectors averaged so far
+      bool Shorts;		// raw vectors of int16 ADC samples, not floats
 
      public:
 
@@ -41,11 +45,34 @@ namespace gr {
  * \param AlexTA  HPSDR Alex Tx Ant Selector
  * \param AlexHPF  HPSDR Alex Rx High Pass Filter Selector
  * \param AlexLPF  HPSDR Alex Tx Low Pass Filter Selector
+ * \param MACAddr  Hermes MAC address to connect to, or "*" for the first found
+ * \param GapPolicy  Incomplete vectors are dropped (0) or zero-filled and
+ *                   tagged "wb_gap" with the number of missing frames (1)
+ * \param FFTSize  0 outputs raw 16384 sample vectors. A power of 2 from 64
+ *                 to 16384 outputs FFTSize/2 bin power spectra in dBFS instead
+ * \param FFTOverlap  Overlap of the FFT segments within a vector, percent
+ * \param FFTAverage  Number of vectors averaged into each output spectrum
+ * \param StatsPeriod  Seconds between "stats" messages, 0 for none
+ * \param IOBackend  Network I/O: sockets (0), io_uring (1) or AF_XDP (2),
+ *		     falls back to sockets
+ * \param BusyPollUs  Microseconds the receive thread spins on the socket
+ *		      before it blocks, 0 to always block
+ * \param RxCore  CPU to pin the receive thread to, -1 for any
+ * \param RecordFile  Capture file for every EP6/EP4 frame received, "" for none
+ * \param ReplayFile  Capture file to play in place of the radio, "" for the radio
+ * \param ReplaySpeed  Replay speed, 1 as recorded, 0 as fast as the flowgraph runs
+ * \param ReplayStart  Seconds into the capture to start the replay
+ * \param OutputType  Raw vectors of float (0) or unconverted int16 ADC
+ *		      samples (1); spectra are always float
  *
  */
       hermesWB_impl(int RxPre, const char* Intfc, const char * ClkS,
 			 int AlexRA, int AlexTA, int AlexHPF, int AlexLPF,
-			 const char* MACAddr);
+			 const char* MACAddr, int GapPolicy,
+			 int FFTSize, int FFTOverlap, int FFTAverage, float StatsPeriod, int IOBackend,
+			 int BusyPollUs, int RxCore, const char* RecordFile,
+			 const char* ReplayFile, float ReplaySpeed, float ReplayStart,
+			 int OutputType);
       ~hermesWB_impl();
 
       // Where all the action really happens
@@ -43,6 +43,40 @@
 // Hermes hardware and send to HermesProxyW. Test that appropriate proxies
 // exist (pointer is not NULL).
 //
+// October 2026 - on the loopback interface, send discovery straight to
+// the HermesEmulator address. Broadcasts do not reach it.
+//
+// October 2026 - stamp each received frame with MonotonicNs() for the
+// proxies' latency histograms.
+//
+// October 2026 - receive with recvmsg() and pass the SO_TIMESTAMPNS kernel
+// time stamp (or CLOCK_REALTIME if the socket has none) to the proxies'
+// jitter and clock drift monitors.
+//
+// October 2026 - warnings from the receive thread go through HermesLog,
+// rate limited and off the thread, instead of fprintf() per packet.
+//
+// October 2026 - USDT tracepoints at receive and send (HermesTrace.h).
+//
+// October 2026 - optional io_uring backend (metis_uring.cc), chosen with
+// metis_set_backend() before discovery. Frame dispatch split out of the
+// receive thread so both backends share it.
+//
+// October 2026 - optional AF_XDP backend (metis_xdp.cc). Its receive
+// thread polls the AF_XDP socket and the metis socket together.
+//
+// October 2026 - busy poll: the socket receive thread spins on
+// non-blocking reads for up to busy_poll_us before it blocks, with
+// SO_BUSY_POLL where allowed, and may be pinned to a core.
+//
+// October 2026 - EP6/EP4 frames recorded to a capture file when
+// metis_set_record_file() names one (HermesRecorder).
+//
+// October 2026 - replay: metis_set_replay() names a capture file that
+// stands in for the radio. Discovery finds it at once, and the frames go
+// through metis_dispatch() from the HermesReplay thread once the stream
+// is turned on. Tx frames are dropped.
+//
 
 
 #include <stdlib.h>
@@ -63,10 +97,19 @@
 
 #include <string.h>
 #include <errno.h>
+#include <time.h>
 
 #include "metis.h"
 #include "HermesProxy.h"
 #include "HermesProxyW.h"
+#include "HermesLog.h"
+#include "HermesTrace.h"
+#include "metis_uring.h"
+#include "metis_xdp.h"
+#include "HermesRecorder.h"
+#include "HermesReplay.h"
+#include <poll.h>
+#include <atomic>
 
 #define MAX_METIS_CARDS 10
 METIS_CARD metis_cards[MAX_METIS_CARDS];
@@ -85,6 +128,18 @@ static struct sockaddr_in discovery_addr;
 static int discovery_length;
 
 static int discovering;
+static int kernel_timestamps;	// SO_TIMESTAMPNS accepted by the socket
+static int requested_backend = METIS_BACKEND_SOCKET;	// metis_set_backend()
+static std::atomic<int> backend(METIS_BACKEND_SOCKET);	// in use, after any fallback
+static std::atomic<bool> receive_stopping(false);	// metis_stop_receive_thread() has begun
+static int busy_poll_us = 0;		// spin budget before a blocking read, 0 = always block
+static int receive_core = -1;		// CPU for the receive thread, -1 = any
+static std::atomic<unsigned long> poll_hits(0);	// spins that found a frame
+static std::atomic<unsigned long> poll_misses(0);	// spins that ran out of budget
+static char record_file[256];		// capture file, empty = not recording
+static char replay_file[256];		// capture file to play, empty = use the radio
+static float replay_speed = 1.0;	// 1 = as recorded, 0 = unthrottled
+static float replay_start = 0;		// seconds into the capture
 
 static unsigned char hw_address[6];
 static long ip_address;
@@ -174,12 +229,51 @@ static int get_addr(int sock, const char * ifname) {
   return 0;
 }
 
+static void metis_dispatch(unsigned char* buffer, int bytes_read, struct sockaddr_in* addr,
+			   uint64_t arrival, uint64_t wire_ns);
+
+// A capture file in place of the radio: one card, found at once, no socket.
+
+static void metis_replay_discover() {
+    fprintf(stderr,"Replaying capture %s\n",replay_file);
+
+    backend = METIS_BACKEND_REPLAY;
+    kernel_timestamps = 0;
+    HermesLog::Start();
+    if(!HermesReplay::Open(replay_file, replay_speed, replay_start)) {
+        fprintf(stderr,"cannot replay %s\n",replay_file);
+        exit(1);
+    }
+
+    strcpy(metis_cards[0].ip_address,"0.0.0.0");
+    strcpy(metis_cards[0].mac_address,"00:00:00:00:00:00");
+    discovering = 0;
+    found = 1;
+}
+
+// Unthrottled replay waits for a proxy's Rx ring to have room for the
+// frame (two NB buffers, or a WB vector) rather than drop it.
+
+static int metis_replay_ready(int ep) {
+    HermesCore* proxy = NULL;
+    if(ep == 6)
+        proxy = Hermes;
+    else if(ep == 4)
+        proxy = HermesW;
+    return proxy == NULL || proxy->RxBufFree() >= 2;
+}
+
 void metis_discover(const char* interface) {
     int rc;
     int i;
     int on=1;
     struct ifreq ifr;
 
+    if(replay_file[0] != 0) {
+        metis_replay_discover();
+        return;
+    }
+
     fprintf(stderr,"Looking for Metis/Hermes card on interface %s\n",interface);
 
     discovering=1;
@@ -191,6 +285,32 @@ void metis_discover(const char* interface) {
         exit(1);
     }
 
+    // ask for kernel receive time stamps, for the jitter and drift monitors
+    kernel_timestamps = 0;
+#ifdef SO_TIMESTAMPNS
+    if(setsockopt(discovery_socket, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == 0)
+        kernel_timestamps = 1;
+#endif
+
+    // kernel busy polling of the NIC queue while we read: above the
+    // net.core.busy_read sysctl it needs CAP_NET_ADMIN, the spin works without
+#ifdef SO_BUSY_POLL
+    if(busy_poll_us > 0) {
+        if(setsockopt(discovery_socket, SOL_SOCKET, SO_BUSY_POLL, &busy_poll_us, sizeof(busy_poll_us)) != 0)
+            fprintf(stderr,"SO_BUSY_POLL not set: %s, spinning in user space only\n", strerror(errno));
+#ifdef SO_PREFER_BUSY_POLL
+        setsockopt(discovery_socket, SOL_SOCKET, SO_PREFER_BUSY_POLL, &on, sizeof(on));
+#endif
+    }
+#endif
+    poll_hits = 0;
+    poll_misses = 0;
+    receive_stopping = false;
+
+    backend = requested_backend;
+    if(backend == METIS_BACKEND_IO_URING && metis_uring_init(discovery_socket) < 0)
+        backend = METIS_BACKEND_SOCKET;
+
 
     // get my MAC address and IP address
     if(get_addr(discovery_socket,interface)<0) {
@@ -208,14 +328,38 @@ void metis_discover(const char* interface) {
          interface,
          hw_address[0], hw_address[1], hw_address[2], hw_address[3], hw_address[4], hw_address[5]);
 
+    if(backend == METIS_BACKEND_AF_XDP) {
+        if(metis_xdp_init(interface, ip_address, DISCOVERY_SEND_PORT) < 0)
+            backend = METIS_BACKEND_SOCKET;
+        else
+            kernel_timestamps = 0;	// the radio's frames no longer pass the socket
+    }
+
+    HermesLog::Start();		// receive thread warnings
+    if(record_file[0] != 0)
+        HermesRecorder::Open(record_file, interface);
 
     // start a receive thread to get discovery responses
-    rc=pthread_create(&receive_thread_id,NULL,metis_receive_thread,NULL);
+    void* (*receive_thread)(void*) = metis_receive_thread;
+    if(backend == METIS_BACKEND_IO_URING)
+        receive_thread = metis_uring_receive_thread;
+    else if(backend == METIS_BACKEND_AF_XDP)
+        receive_thread = metis_xdp_receive_thread;
+    rc=pthread_create(&receive_thread_id,NULL,receive_thread,NULL);
     if(rc != 0) {
         fprintf(stderr,"pthread_create failed on metis_receive_thread: rc=%d\n", rc);
         exit(1);
     }
 
+    if(receive_core >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(receive_core, &cpus);
+        rc=pthread_setaffinity_np(receive_thread_id, sizeof(cpus), &cpus);
+        if(rc != 0)
+            fprintf(stderr,"cannot pin metis_receive_thread to CPU %d: %s\n", receive_core, strerror(rc));
+    }
+
     // bind to this interface
     struct sockaddr_in name={0};
     name.sin_family = AF_INET;
@@ -236,6 +380,8 @@ void metis_discover(const char* interface) {
     discovery_addr.sin_family=AF_INET;
     discovery_addr.sin_port=htons(DISCOVERY_SEND_PORT);
     discovery_addr.sin_addr.s_addr=htonl(INADDR_BROADCAST);
+    if((ntohl(ip_address) >> 24) == 127)	// loopback: HermesEmulator
+        discovery_addr.sin_addr.s_addr=inet_addr(EMULATOR_ADDRESS);
 
     buffer[0]=0xEF;
     buffer[1]=0xFE;
@@ -254,12 +400,70 @@ int metis_found() {
     return found;
 }
 
+int metis_kernel_timestamps() {
+    return kernel_timestamps;
+}
+
+void metis_set_backend(int b) {
+    requested_backend = b;
+}
+
+int metis_backend() {
+    return backend;
+}
+
+void metis_set_busy_poll(int spin_us, int core) {
+    busy_poll_us = (spin_us > 0) ? spin_us : 0;
+    receive_core = core;
+}
+
+void metis_set_record_file(const char* path) {
+    record_file[0] = 0;
+    if(path != NULL)
+        strncat(record_file, path, sizeof(record_file) - 1);
+}
+
+void metis_record_counts(unsigned long* frames, unsigned long* dropped) {
+    HermesRecorder::Counts(frames, dropped);
+}
+
+void metis_set_replay(const char* path, float speed, float start) {
+    replay_file[0] = 0;
+    if(path != NULL)
+        strncat(replay_file, path, sizeof(replay_file) - 1);
+    replay_speed = speed;
+    replay_start = start;
+}
+
+int metis_replay_done() {
+    return backend == METIS_BACKEND_REPLAY && HermesReplay::Done();
+}
+
+void metis_poll_counts(unsigned long* hits, unsigned long* misses) {
+    *hits = poll_hits.load(std::memory_order_relaxed);
+    *misses = poll_misses.load(std::memory_order_relaxed);
+}
+
 // close socket, stop receive thread, wait for thread to terminate
 void metis_stop_receive_thread() {
 
+    if(backend == METIS_BACKEND_REPLAY) {
+        HermesReplay::Stop();
+        HermesLog::Stop();
+        return;
+    }
+
+    receive_stopping = true;		// before backend is read, see metis_uring_receive_thread()
     shutdown(discovery_socket, 2);
-    pthread_cancel(receive_thread_id);
+    if(backend == METIS_BACKEND_IO_URING)
+        metis_uring_stop();		// returns within METISURINGWAITMS
+    else
+        pthread_cancel(receive_thread_id);
     pthread_join(receive_thread_id, NULL);
+    metis_uring_exit();
+    metis_xdp_exit();
+    HermesRecorder::Close();
+    HermesLog::Stop();
 
 };
 
@@ -286,6 +490,12 @@ void metis_receive_stream_control(unsigned char streamControl, unsigned int entr
 
     discovering=0;
 
+    if(backend == METIS_BACKEND_REPLAY) {
+        if(streamControl != RxStream_Off)
+            HermesReplay::Run(metis_dispatch, metis_replay_ready);
+        return;
+    }
+
     h=gethostbyname(metis_cards[entry].ip_address);
     if(h==NULL) {
         fprintf(stderr,"metis_start_receiver_stream unknown target.  MAC: %s    IP: %s\n",
@@ -317,28 +527,14 @@ void metis_receive_stream_control(unsigned char streamControl, unsigned int entr
       send_sequence = -1;	// reset HPSDR Tx Ethernet sequence number on stream stop
 }
 
-void* metis_receive_thread(void* arg) {
-    struct sockaddr_in addr;
-    int length;
-    unsigned char buffer[2048];
-    int bytes_read;
-
-    length=sizeof(addr);
-    while(1) {
-   	bytes_read=recvfrom(discovery_socket,buffer,sizeof(buffer),0,(struct sockaddr*)&addr,(socklen_t *)&length);
-        if(bytes_read<0) {
-            if (errno == EINTR)	 // new code to handle case of signal received
-              continue;
-
-            perror("recvfrom socket failed for metis_receive_thread");
-            exit(1);
-        }
+// Hand one received datagram to the proxies, or to discovery. Shared by the
+// socket receive thread below and the io_uring one (metis_uring.cc).
 
-	if(bytes_read == 0)
-	    continue;
+static void metis_dispatch(unsigned char* buffer, int bytes_read, struct sockaddr_in* addr,
+			   uint64_t arrival, uint64_t wire_ns) {
 
 	if(bytes_read > 1048)
-	    fprintf(stderr, "Metis Receive Thread: bytes_read = %d  (>1048)\n", bytes_read);
+	    HermesLog::Post(LOG_RX_OVERSIZE, bytes_read);
 
         if(buffer[0]==0xEF && buffer[1]==0xFE) {
             switch(buffer[2]) {
@@ -349,26 +545,35 @@ void* metis_receive_thread(void* arg) {
 
                         // get the sequence number
                         sequence=((buffer[4]&0xFF)<<24)+((buffer[5]&0xFF)<<16)+((buffer[6]&0xFF)<<8)+(buffer[7]&0xFF);
+                        HPSDR_TRACE4(rx_frame, ep, sequence, bytes_read, arrival);
+                        if((ep == 6 || ep == 4) && HermesRecorder::Recording())
+                            HermesRecorder::Post(buffer, bytes_read, arrival, wire_ns);
                         switch(ep) {
                             case 6: // EP6			Send to Hermes Narrowband
                                 // process the data
 				if(bytes_read != 1032)
-				  fprintf(stderr,"Metis: bytes_read = %d (!= 1032)\n", bytes_read);
+				  HermesLog::Post(LOG_RX_LENGTH, bytes_read);
 				if (Hermes != NULL)
-				  Hermes->ReceiveRxIQ(&buffer[0]); // send Ethernet frame to Proxy
+				{
+				  Hermes->TimeRxFrame(sequence, wire_ns);
+				  Hermes->ReceiveRxIQ(&buffer[0], arrival); // send Ethernet frame to Proxy
+				}
                                 break;
 
                             case 4: // EP4			Send to Hermes Wideband
 				if (HermesW != NULL)
-				  HermesW->ReceiveRxIQ(&buffer[0]); // send Ethernet frame to Proxy
+				{
+				  HermesW->TimeRxFrame(sequence, wire_ns);
+				  HermesW->ReceiveRxIQ(&buffer[0], arrival); // send Ethernet frame to Proxy
+				}
                                 break;
 
                             default:
-                                fprintf(stderr,"unexpected EP %d length=%d\n",ep,bytes_read);
+                                HermesLog::Post(LOG_RX_ENDPOINT, ep, bytes_read);
                                 break;
                         }
                     } else {
-                        fprintf(stderr,"unexpected data packet when in discovery mode\n");
+                        HermesLog::Post(LOG_RX_DATA_DISCOVERING);
                     }
                     break;
                 case 2:  // response to a discovery packet
@@ -382,28 +587,136 @@ void* metis_receive_thread(void* arg) {
     
                             // get ip address from packet header
                             sprintf(metis_cards[found].ip_address,"%d.%d.%d.%d",
-                                       addr.sin_addr.s_addr&0xFF,
-                                       (addr.sin_addr.s_addr>>8)&0xFF,
-                                       (addr.sin_addr.s_addr>>16)&0xFF,
-                                       (addr.sin_addr.s_addr>>24)&0xFF);
+                                       addr->sin_addr.s_addr&0xFF,
+                                       (addr->sin_addr.s_addr>>8)&0xFF,
+                                       (addr->sin_addr.s_addr>>16)&0xFF,
+                                       (addr->sin_addr.s_addr>>24)&0xFF);
                             fprintf(stderr,"Metis IP address %s\n",metis_cards[found].ip_address);
                             found++;
                         } else {
                             fprintf(stderr,"too many metis/Hermes cards!\n");
                         }
                     } else {
-                        fprintf(stderr,"unexepected discovery response when not in discovery mode\n");
+                        HermesLog::Post(LOG_RX_DISCOVERY_REPLY);
                     }
                     break;
                 default:
-                    fprintf(stderr,"unexpected packet type: 0x%02X\n",buffer[2]);
+                    HermesLog::Post(LOG_RX_PACKET_TYPE, buffer[2]);
                     break;
             }
         } else {
-            fprintf(stderr,"received bad header bytes on data port %02X,%02X\n",buffer[0],buffer[1]);
+            HermesLog::Post(LOG_RX_HEADER, buffer[0], buffer[1]);
+        }
+}
+
+// Read one datagram from the metis socket and dispatch it. Returns the
+// bytes read, or -1 if there was nothing (flags MSG_DONTWAIT) or a signal.
+
+static int metis_receive_socket(int flags) {
+    struct sockaddr_in addr;
+    unsigned char buffer[2048];
+    int bytes_read;
+    char control[256];
+    struct iovec iov;
+    struct msghdr msg;
+    struct cmsghdr* cmsg;
+    struct timespec wire;
+
+	iov.iov_base=buffer;
+	iov.iov_len=sizeof(buffer);
+	memset(&msg,0,sizeof(msg));
+	msg.msg_name=&addr;
+	msg.msg_namelen=sizeof(addr);
+	msg.msg_iov=&iov;
+	msg.msg_iovlen=1;
+	msg.msg_control=control;
+	msg.msg_controllen=sizeof(control);
+
+   	bytes_read=recvmsg(discovery_socket,&msg,flags);
+
+        if(bytes_read<0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)	 // signal, or nothing yet
+              return -1;
+
+            perror("recvmsg socket failed for metis_receive_thread");
+            exit(1);
         }
+
+	if(bytes_read == 0)
+	    return 0;
+
+	// only a real frame pays for the clock reads, an empty busy poll spin does not
+	uint64_t arrival = MonotonicNs();
+	wire.tv_sec = 0;
+#ifdef SO_TIMESTAMPNS
+	for(cmsg=CMSG_FIRSTHDR(&msg); cmsg!=NULL; cmsg=CMSG_NXTHDR(&msg,cmsg))
+	    if(cmsg->cmsg_level==SOL_SOCKET && cmsg->cmsg_type==SCM_TIMESTAMPNS)
+	        memcpy(&wire, CMSG_DATA(cmsg), sizeof(wire));
+#endif
+	if(wire.tv_sec == 0)			// no kernel time stamp, use our own
+	    clock_gettime(CLOCK_REALTIME, &wire);
+	uint64_t wire_ns = (uint64_t)wire.tv_sec * 1000000000ull + wire.tv_nsec;
+
+	metis_dispatch(buffer, bytes_read, &addr, arrival, wire_ns);
+	return bytes_read;
+}
+
+void* metis_receive_thread(void* arg) {
+    while(1) {
+	if(busy_poll_us > 0) {			// spin, then block
+	    uint64_t deadline = MonotonicNs() + busy_poll_us * 1000ull;
+	    int hit = 0;
+	    do {
+		if(metis_receive_socket(MSG_DONTWAIT) >= 0) {
+		    hit = 1;
+		    break;
+		}
+	    } while(MonotonicNs() < deadline);
+
+	    if(hit) {
+		poll_hits.fetch_add(1, std::memory_order_relaxed);
+		continue;
+	    }
+	    poll_misses.fetch_add(1, std::memory_order_relaxed);
+	}
+	metis_receive_socket(0);
+    }
+}
+
+void* metis_uring_receive_thread(void* arg) {
+    if(metis_uring_receive(metis_dispatch) == 0)
+        return NULL;			// stopped
+
+    fprintf(stderr,"io_uring cannot receive on this kernel, using sockets\n");
+    // Either the stop sees the socket backend and cancels us, or it
+    // started first and we see receive_stopping: never neither.
+    backend = METIS_BACKEND_SOCKET;
+    if(receive_stopping)
+        return NULL;
+    return metis_receive_thread(arg);
+}
+
+void* metis_xdp_receive_thread(void* arg) {
+    struct pollfd fds[2];
+
+    fds[0].fd=metis_xdp_fd();		// the radio's frames, redirected by XDP
+    fds[0].events=POLLIN;
+    fds[1].fd=discovery_socket;		// anything the program passed to the kernel
+    fds[1].events=POLLIN;
+
+    while(1) {
+        if(poll(fds,2,-1) < 0) {
+            if (errno == EINTR)
+              continue;
+
+            perror("poll failed for metis_receive_thread");
+            exit(1);
+        }
+        if(fds[0].revents & POLLIN)
+            metis_xdp_receive(metis_dispatch);
+        if(fds[1].revents & POLLIN)
+            metis_receive_socket(MSG_DONTWAIT);
     }
-    
 }
 
 static unsigned char output_buffer[1032];
@@ -461,6 +774,15 @@ for(int i=520; i<528; i++)
 fprintf(stderr,"\n");
 */
 
+    HPSDR_TRACE2(tx_send, send_sequence, length);
+
+    if(backend == METIS_BACKEND_REPLAY)
+        return;				// no radio to send to
+
+    if(backend == METIS_BACKEND_IO_URING &&
+       metis_uring_send(buffer, length, &data_addr, data_addr_length) == 0)
+        return;				// queued, goes out with the next receive wait
+
     if(sendto(discovery_socket,buffer,length,0,(struct sockaddr*)&data_addr,data_addr_length)!=length) {
         perror("sendto socket failed for metis_send_data\n");
         exit(1);
@@ -2,10 +2,29 @@
 // This version has been modified from the John Melton original 
 // by Tom McDermott, N5EG for use with metis.cc and Gnuradio.
 // Version - November 16, 2012
+//	     October 2026 - EMULATOR_ADDRESS for discovery on the loopback
+//	     October 2026 - metis_set_backend(): sockets or io_uring
+//	     October 2026 - AF_XDP backend, metis_dispatch_t shared by the backends
+//	     October 2026 - metis_set_busy_poll(): spin before blocking, pin the receive thread
+//	     October 2026 - metis_set_record_file(): record EP6/EP4 frames for replay
+//	     October 2026 - metis_set_replay(): play a capture file instead of a radio
 
 #ifndef METIS_H
 #define METIS_H
 
+#include <netinet/in.h>
+#include <stdint.h>
+
+#define EMULATOR_ADDRESS "127.0.0.2"	// discovery target when the interface is loopback
+					// (HermesEmulator), broadcast does not reach it
+
+#define METIS_BACKEND_SOCKET	0	// recvmsg() / sendto()
+#define METIS_BACKEND_IO_URING	1	// multishot recvmsg, batched sends (needs liburing)
+#define METIS_BACKEND_AF_XDP	2	// XDP redirect of the radio's frames into UMEM
+#define METIS_BACKEND_REPLAY	3	// frames from a capture file, no radio (HermesReplay)
+
+typedef void (*metis_dispatch_t)(unsigned char* buffer, int bytes_read, struct sockaddr_in* addr,
+				 uint64_t arrival, uint64_t wire_ns);	// one received datagram
 
 enum {	RxStream_Off,		// Hermes Receiver Stream Controls
 	RxStream_NB_On,		// Narrow Band (down converted)
@@ -24,9 +43,22 @@ char* metis_ip_address(int entry);
 char* metis_mac_address(int entry);
 void metis_receive_stream_control(unsigned char, unsigned int);
 void metis_stop_receive_thread();
+int metis_kernel_timestamps();		// 1 if received frames carry SO_TIMESTAMPNS time stamps
+void metis_set_backend(int);		// METIS_BACKEND_*, before metis_discover()
+int metis_backend();			// backend in use, after any fallback
+void metis_set_busy_poll(int spin_us, int core);	// before metis_discover(): spin budget
+							// (0 = block), receive thread CPU (-1 = any)
+void metis_poll_counts(unsigned long* hits, unsigned long* misses);	// busy poll outcomes
+void metis_set_record_file(const char* path);	// before metis_discover(), "" = do not record
+void metis_record_counts(unsigned long* frames, unsigned long* dropped);	// recorder progress
+void metis_set_replay(const char* path, float speed, float start);	// before metis_discover(), "" = radio;
+							// speed 0 = unthrottled, start in seconds
+int metis_replay_done();		// 1 once a replay has dispatched its last frame
 
 int metis_write(unsigned char ep,unsigned char* buffer,int length);
 void* metis_receive_thread(void* arg);
+void* metis_uring_receive_thread(void* arg);
+void* metis_xdp_receive_thread(void* arg);
 void metis_send_buffer(unsigned char* buffer,int length);
 
 
@@ -0,0 +1,29 @@
+/* -*-  C++  -*-  */
+/* metis_stub.cc */
+
+// Copyright 2026 Tom McDermott, N5EG
+// under GNU General Public License, as metis.cc.
+//
+// A detached metis for the programs that drive the proxies directly
+// (test-hpsdr, bench-hpsdr): discovery always finds one card, nothing
+// touches the network, and Tx frames are only counted.
+//
+// Version:  October 2026
+
+#include "metis.h"
+
+unsigned long metis_stub_bytes;		// bytes "sent", keeps the Tx path honest
+
+void metis_discover(const char*) {}
+int metis_found() { return 1; }
+char* metis_ip_address(int) { return (char*)"0.0.0.0"; }
+char* metis_mac_address(int) { return (char*)"00:00:00:00:00:00"; }
+void metis_receive_stream_control(unsigned char, unsigned int) {}
+void metis_stop_receive_thread() {}
+int metis_kernel_timestamps() { return 0; }
+int metis_backend() { return 0; }
+void metis_poll_counts(unsigned long* hits, unsigned long* misses) { *hits = *misses = 0; }
+void metis_record_counts(unsigned long* frames, unsigned long* dropped) { *frames = *dropped = 0; }
+int metis_replay_done() { return 0; }
+int metis_write(unsigned char, unsigned char* buffer, int length) { metis_stub_bytes += buffer[0] + length; return length; }
+void metis_send_buffer(unsigned char*, int length) { metis_stub_bytes += length; }
@@ -0,0 +1,259 @@
+/* -*-  C++  -*-  */
+/* metis_uring.cc */
+
+// Copyright 2026 Tom McDermott, N5EG
+// under GNU General Public License, as metis.cc.
+//
+// Version:  October 2026
+
+#include <stdio.h>
+#include "metis_uring.h"
+
+#ifdef HAVE_LIBURING
+
+#include <liburing.h>
+#include <sys/socket.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <atomic>
+#include "LatencyHistogram.h"	// MonotonicNs()
+
+#define TAG_RECV	(~(uint64_t)0)	// user_data of the multishot recvmsg, sends use their slot
+
+static struct io_uring ring;
+static struct io_uring_buf_ring* bufring = NULL;
+static unsigned char* bufs = NULL;	// METISURINGBUFS receive buffers
+static struct msghdr recv_template;	// address and cmsg space the kernel reserves in each buffer
+static int ring_sock = -1;
+
+static pthread_t ring_thread;
+static std::atomic<bool> ring_running(false);	// metis_uring_receive() is looping
+static std::atomic<bool> stopping(false);
+
+struct send_slot {			// one Tx frame in flight, receive thread only
+    unsigned char data[1032];
+    struct iovec iov;
+    struct msghdr msg;
+    struct sockaddr_in to;
+};
+static struct send_slot sends[METISURINGSENDS];
+static int free_sends[METISURINGSENDS];
+static int nfree;
+
+
+int metis_uring_init(int sock) {
+    int rc;
+
+    rc=io_uring_queue_init(METISURINGENTRIES, &ring, 0);
+    if(rc < 0) {
+        fprintf(stderr,"io_uring_queue_init failed: %s, using sockets\n", strerror(-rc));
+        return -1;
+    }
+
+    // provided buffers for the multishot receive (Linux 5.19)
+    bufring=io_uring_setup_buf_ring(&ring, METISURINGBUFS, 0, 0, &rc);
+    if(bufring == NULL) {
+        fprintf(stderr,"io_uring_setup_buf_ring failed: %s, using sockets\n", strerror(-rc));
+        io_uring_queue_exit(&ring);
+        return -1;
+    }
+
+    bufs=(unsigned char*)malloc(METISURINGBUFS * METISURINGBUFSIZE);
+    for(int i=0; i<METISURINGBUFS; i++)
+        io_uring_buf_ring_add(bufring, bufs + i * METISURINGBUFSIZE, METISURINGBUFSIZE, i,
+                              io_uring_buf_ring_mask(METISURINGBUFS), i);
+    io_uring_buf_ring_advance(bufring, METISURINGBUFS);
+
+    memset(&recv_template,0,sizeof(recv_template));
+    recv_template.msg_namelen=sizeof(struct sockaddr_in);
+    recv_template.msg_controllen=64;	// room for SCM_TIMESTAMPNS
+
+    for(int i=0; i<METISURINGSENDS; i++)
+        free_sends[i]=i;
+    nfree=METISURINGSENDS;
+
+    ring_sock=sock;
+    stopping=false;
+    return 0;
+}
+
+static struct io_uring_sqe* get_sqe() {	// submit what is queued if the SQ is full
+    struct io_uring_sqe* sqe=io_uring_get_sqe(&ring);
+    if(sqe == NULL) {
+        io_uring_submit(&ring);
+        sqe=io_uring_get_sqe(&ring);
+    }
+    return sqe;
+}
+
+int metis_uring_receive(metis_dispatch_t dispatch) {
+    struct io_uring_sqe* sqe;
+    struct io_uring_cqe* cqe;
+    struct cmsghdr* cmsg;
+    struct timespec wire;
+    unsigned head;
+    bool armed=false;
+    bool received=false;
+    int result=0;
+
+    ring_thread=pthread_self();
+    ring_running=true;
+
+    while(!stopping) {
+        if(!armed) {			// (re)arm the multishot receive
+            sqe=get_sqe();
+            io_uring_prep_recvmsg_multishot(sqe, ring_sock, &recv_template, 0);
+            sqe->flags |= IOSQE_BUFFER_SELECT;
+            sqe->buf_group=0;
+            io_uring_sqe_set_data64(sqe, TAG_RECV);
+            armed=true;
+        }
+
+        // queued sends and the rearm go in with the wait, one system call
+        struct __kernel_timespec ts = { 0, METISURINGWAITMS * 1000000LL };
+        int rc=io_uring_submit_and_wait_timeout(&ring, &cqe, 1, &ts, NULL);
+        if(rc < 0 && rc != -ETIME && rc != -EINTR) {
+            fprintf(stderr,"io_uring wait failed for metis_receive_thread: %s\n", strerror(-rc));
+            exit(1);
+        }
+
+        unsigned count=0;
+        io_uring_for_each_cqe(&ring, head, cqe) {
+            count++;
+            uint64_t tag=io_uring_cqe_get_data64(cqe);
+
+            if(tag != TAG_RECV) {	// a send completed, its slot is free again
+                free_sends[nfree++]=(int)tag;
+                if(cqe->res < 0) {
+                    fprintf(stderr,"io_uring sendmsg failed for metis_send_data: %s\n", strerror(-cqe->res));
+                    exit(1);
+                }
+                continue;
+            }
+
+            if(!(cqe->flags & IORING_CQE_F_MORE))
+                armed=false;
+
+            if(cqe->res < 0) {
+                if(cqe->res == -ENOBUFS)	// all buffers in use, rearm once they are back
+                    continue;
+                if(!received && cqe->res == -EINVAL) {	// no multishot recvmsg (before Linux 6.0)
+                    result=-1;
+                    stopping=true;
+                    continue;
+                }
+                if(stopping)
+                    continue;
+                fprintf(stderr,"io_uring recvmsg failed for metis_receive_thread: %s\n", strerror(-cqe->res));
+                exit(1);
+            }
+
+            if(!(cqe->flags & IORING_CQE_F_BUFFER))
+                continue;
+
+            uint64_t arrival=MonotonicNs();
+            unsigned bid=cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+            unsigned char* buf=bufs + bid * METISURINGBUFSIZE;
+            struct io_uring_recvmsg_out* o=io_uring_recvmsg_validate(buf, cqe->res, &recv_template);
+            received=true;
+
+            if(o != NULL && o->payloadlen > 0) {
+                wire.tv_sec=0;
+#ifdef SO_TIMESTAMPNS
+                for(cmsg=io_uring_recvmsg_cmsg_firsthdr(o, &recv_template); cmsg != NULL;
+                    cmsg=io_uring_recvmsg_cmsg_nexthdr(o, &recv_template, cmsg))
+                    if(cmsg->cmsg_level==SOL_SOCKET && cmsg->cmsg_type==SCM_TIMESTAMPNS)
+                        memcpy(&wire, CMSG_DATA(cmsg), sizeof(wire));
+#endif
+                if(wire.tv_sec == 0)		// no kernel time stamp, use our own
+                    clock_gettime(CLOCK_REALTIME, &wire);
+                uint64_t wire_ns=(uint64_t)wire.tv_sec * 1000000000ull + wire.tv_nsec;
+
+                dispatch((unsigned char*)io_uring_recvmsg_payload(o, &recv_template), o->payloadlen,
+                         (struct sockaddr_in*)io_uring_recvmsg_name(o), arrival, wire_ns);
+            }
+
+            io_uring_buf_ring_add(bufring, buf, METISURINGBUFSIZE, bid,
+                                  io_uring_buf_ring_mask(METISURINGBUFS), 0);
+            io_uring_buf_ring_advance(bufring, 1);
+        }
+        io_uring_cq_advance(&ring, count);
+    }
+
+    io_uring_submit(&ring);		// sends queued by the last frames
+    ring_running=false;
+    return result;
+}
+
+int metis_uring_send(const unsigned char* buffer, int length,
+                     const struct sockaddr_in* to, int tolen) {
+
+    if(!ring_running || !pthread_equal(pthread_self(), ring_thread))
+        return -1;			// not the ring's thread, caller uses sendto()
+
+    if(nfree == 0 || length > (int)sizeof(sends[0].data)) {
+        io_uring_submit(&ring);		// keep the frames in order ahead of the caller's sendto()
+        return -1;
+    }
+
+    struct io_uring_sqe* sqe=get_sqe();
+    if(sqe == NULL)
+        return -1;
+
+    int i=free_sends[--nfree];
+    struct send_slot* s=&sends[i];
+    memcpy(s->data, buffer, length);
+    memcpy(&s->to, to, sizeof(s->to));
+    s->iov.iov_base=s->data;
+    s->iov.iov_len=length;
+    memset(&s->msg,0,sizeof(s->msg));
+    s->msg.msg_name=&s->to;
+    s->msg.msg_namelen=tolen;
+    s->msg.msg_iov=&s->iov;
+    s->msg.msg_iovlen=1;
+
+    io_uring_prep_sendmsg(sqe, ring_sock, &s->msg, 0);
+    io_uring_sqe_set_data64(sqe, (uint64_t)i);
+    return 0;
+}
+
+void metis_uring_stop() {
+    stopping=true;
+}
+
+void metis_uring_exit() {
+    if(bufring == NULL)
+        return;
+    io_uring_free_buf_ring(&ring, bufring, METISURINGBUFS, 0);
+    io_uring_queue_exit(&ring);
+    free(bufs);
+    bufring=NULL;
+    bufs=NULL;
+}
+
+#else	// no liburing
+
+int metis_uring_init(int sock) {
+    fprintf(stderr,"built without liburing, using sockets\n");
+    return -1;
+}
+
+int metis_uring_receive(metis_dispatch_t dispatch) {
+    return -1;
+}
+
+int metis_uring_send(const unsigned char* buffer, int length,
+                     const struct sockaddr_in* to, int tolen) {
+    return -1;
+}
+
+void metis_uring_stop() {
+}
+
+void metis_uring_exit() {
+}
+
+#endif	// HAVE_LIBURING
@@ -0,0 +1,41 @@
+/* -*-  C++  -*-  */
+/* metis_uring.h */
+
+// Copyright 2026 Tom McDermott, N5EG
+// under GNU General Public License, as metis.cc.
+//
+// io_uring backend for the metis socket (METIS_BACKEND_IO_URING).
+//
+// One multishot recvmsg is armed on the socket with a ring of provided
+// receive buffers, so the kernel keeps filling buffers and posting
+// completions without a system call per frame. Frames sent from the
+// receive thread itself (the proxies schedule their Tx frames from
+// ReceiveRxIQ) are queued as sendmsg submissions and go to the kernel
+// together with the next wait for receive completions. Sends from any
+// other thread return -1 and the caller uses sendto() as before.
+//
+// Built only when liburing is found (HAVE_LIBURING); otherwise
+// metis_uring_init() fails and metis.cc keeps the socket path.
+//
+// Version:  October 2026
+
+#ifndef METIS_URING_H
+#define METIS_URING_H
+
+#include "metis.h"
+
+#define METISURINGENTRIES	64	// submission queue entries
+#define METISURINGBUFS		256	// provided receive buffers, integral power of 2
+#define METISURINGBUFSIZE	2048	// bytes per receive buffer, header + address + cmsg + frame
+#define METISURINGSENDS		32	// Tx frames in flight
+#define METISURINGWAITMS	100	// longest wait, so a stop request is seen
+
+int metis_uring_init(int sock);		// 0 if the ring is ready, -1 to use the socket path
+int metis_uring_receive(metis_dispatch_t dispatch);	// receive loop: 0 once stopped,
+							// -1 if the kernel cannot receive this way
+int metis_uring_send(const unsigned char* buffer, int length,
+		     const struct sockaddr_in* to, int tolen);	// 0 if queued, -1 to use sendto()
+void metis_uring_stop();		// ask the receive loop to return
+void metis_uring_exit();		// free the ring, once the receive thread has returned
+
+#endif  // METIS_URING_H
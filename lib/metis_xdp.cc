@@ -0,0 +1,336 @@
+/* -*-  C++  -*-  */
+/* metis_xdp.cc */
+
+// Copyright 2026 Tom McDermott, N5EG
+// under GNU General Public License, as metis.cc.
+//
+// Version:  October 2026
+
+#include <stdio.h>
+#include "metis_xdp.h"
+
+#ifdef HAVE_AF_XDP
+
+#include <linux/if_xdp.h>
+#include <linux/if_ether.h>
+#include <linux/bpf.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <stddef.h>
+#include <time.h>
+#include "LatencyHistogram.h"	// MonotonicNs()
+
+#define HEADERS		42		// Ethernet 14 + IPv4 without options 20 + UDP 8
+
+struct xdp_ring {			// one mmap()ed AF_XDP ring
+    uint32_t* producer;
+    uint32_t* consumer;
+    void* desc;
+    void* map;
+    size_t maplen;
+};
+
+static int xsk = -1;			// the AF_XDP socket
+static int map_fd = -1;			// XSKMAP, queue -> xsk
+static int prog_fd = -1;
+static int link_fd = -1;		// bpf link holding the program on the interface
+static unsigned char* umem = NULL;
+static struct xdp_ring rx, fill;
+
+
+static long sys_bpf(int cmd, union bpf_attr* attr) {
+    return syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+static struct bpf_insn insn(uint8_t code, uint8_t dst, uint8_t src, int16_t off, int32_t imm) {
+    struct bpf_insn i;
+    i.code=code;
+    i.dst_reg=dst;
+    i.src_reg=src;
+    i.off=off;
+    i.imm=imm;
+    return i;
+}
+
+// The XDP program, assembled here so there is no clang or libbpf in the
+// build. In C it would read:
+//
+//	if (eth + 42 > data_end || eth->proto != ETH_P_IP || ip->ihl_version != 0x45
+//	    || (ip->frag_off & 0x3fff) || ip->protocol != IPPROTO_UDP
+//	    || ip->daddr != address || udp->source != 1024 || udp->dest != port)
+//		return XDP_PASS;
+//	return bpf_redirect_map(&xsks, ctx->rx_queue_index, XDP_PASS);
+
+static int load_program(int map, long address, int port) {
+    struct bpf_insn p[40];
+    int pass[10];			// jumps to patch to the XDP_PASS exit
+    int n=0, np=0;
+
+#define LDX(size, dst, src, off)  p[n++]=insn(BPF_LDX|BPF_MEM|size, dst, src, off, 0)
+#define JNE(dst, imm)		  pass[np++]=n, p[n++]=insn(BPF_JMP32|BPF_JNE|BPF_K, dst, 0, 0, imm)
+
+    p[n++]=insn(BPF_ALU64|BPF_MOV|BPF_X, 6, 1, 0, 0);		// r6 = ctx
+    LDX(BPF_W, 2, 6, offsetof(struct xdp_md, data));
+    LDX(BPF_W, 3, 6, offsetof(struct xdp_md, data_end));
+    p[n++]=insn(BPF_ALU64|BPF_MOV|BPF_X, 4, 2, 0, 0);
+    p[n++]=insn(BPF_ALU64|BPF_ADD|BPF_K, 4, 0, 0, HEADERS);
+    pass[np++]=n, p[n++]=insn(BPF_JMP|BPF_JGT|BPF_X, 4, 3, 0, 0);	// too short
+    LDX(BPF_H, 5, 2, 12);
+    JNE(5, htons(ETH_P_IP));
+    LDX(BPF_B, 5, 2, 14);
+    JNE(5, 0x45);
+    LDX(BPF_H, 5, 2, 20);
+    p[n++]=insn(BPF_ALU64|BPF_AND|BPF_K, 5, 0, 0, htons(0x3fff));	// fragments
+    JNE(5, 0);
+    LDX(BPF_B, 5, 2, 23);
+    JNE(5, IPPROTO_UDP);
+    LDX(BPF_W, 5, 2, 30);
+    JNE(5, (int32_t)address);
+    LDX(BPF_H, 5, 2, 34);
+    JNE(5, htons(1024));
+    LDX(BPF_H, 5, 2, 36);
+    JNE(5, htons(port));
+    LDX(BPF_W, 2, 6, offsetof(struct xdp_md, rx_queue_index));
+    p[n++]=insn(BPF_LD|BPF_DW|BPF_IMM, 1, BPF_PSEUDO_MAP_FD, 0, map);
+    p[n++]=insn(0, 0, 0, 0, 0);
+    p[n++]=insn(BPF_ALU64|BPF_MOV|BPF_K, 3, 0, 0, XDP_PASS);	// if no socket on this queue
+    p[n++]=insn(BPF_JMP|BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map);
+    p[n++]=insn(BPF_JMP|BPF_EXIT, 0, 0, 0, 0);
+    for(int i=0; i<np; i++)
+        p[pass[i]].off=n - (pass[i] + 1);
+    p[n++]=insn(BPF_ALU64|BPF_MOV|BPF_K, 0, 0, 0, XDP_PASS);
+    p[n++]=insn(BPF_JMP|BPF_EXIT, 0, 0, 0, 0);
+
+#undef LDX
+#undef JNE
+
+    static char log[4096];
+    union bpf_attr attr;
+    memset(&attr,0,sizeof(attr));
+    attr.prog_type=BPF_PROG_TYPE_XDP;
+    attr.insns=(uint64_t)(unsigned long)p;
+    attr.insn_cnt=n;
+    attr.license=(uint64_t)(unsigned long)"GPL";
+    attr.log_buf=(uint64_t)(unsigned long)log;
+    attr.log_size=sizeof(log);
+    attr.log_level=1;
+    log[0]=0;
+
+    int fd=sys_bpf(BPF_PROG_LOAD, &attr);
+    if(fd < 0)
+        fprintf(stderr,"AF_XDP: cannot load the XDP program: %s\n%s", strerror(errno), log);
+    return fd;
+}
+
+static int map_ring(struct xdp_ring* r, struct xdp_ring_offset* off, size_t descsize, off_t pgoff) {
+    r->maplen=off->desc + METISXDPFRAMES * descsize;
+    r->map=mmap(NULL, r->maplen, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, xsk, pgoff);
+    if(r->map == MAP_FAILED) {
+        r->map=NULL;
+        return -1;
+    }
+    r->producer=(uint32_t*)((char*)r->map + off->producer);
+    r->consumer=(uint32_t*)((char*)r->map + off->consumer);
+    r->desc=(char*)r->map + off->desc;
+    return 0;
+}
+
+int metis_xdp_init(const char* interface, long address, int port) {
+    struct xdp_umem_reg mr;
+    struct xdp_mmap_offsets off;
+    struct sockaddr_xdp sxdp;
+    socklen_t len=sizeof(off);
+    int size=METISXDPFRAMES;
+    int ifindex;
+
+    ifindex=if_nametoindex(interface);
+    if(ifindex == 0) {
+        fprintf(stderr,"AF_XDP: no interface %s, using sockets\n", interface);
+        return -1;
+    }
+
+    struct rlimit unlimited = { RLIM_INFINITY, RLIM_INFINITY };	// UMEM and maps before Linux 5.11
+    setrlimit(RLIMIT_MEMLOCK, &unlimited);
+
+    xsk=socket(AF_XDP, SOCK_RAW, 0);
+    if(xsk < 0) {
+        fprintf(stderr,"AF_XDP: cannot create socket: %s, using sockets\n", strerror(errno));
+        return -1;
+    }
+
+    umem=(unsigned char*)mmap(NULL, METISXDPFRAMES * METISXDPFRAMESIZE, PROT_READ|PROT_WRITE,
+                              MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if(umem == MAP_FAILED) {
+        umem=NULL;
+        fprintf(stderr,"AF_XDP: cannot allocate UMEM, using sockets\n");
+        metis_xdp_exit();
+        return -1;
+    }
+
+    memset(&mr,0,sizeof(mr));
+    mr.addr=(uint64_t)(unsigned long)umem;
+    mr.len=METISXDPFRAMES * METISXDPFRAMESIZE;
+    mr.chunk_size=METISXDPFRAMESIZE;
+    if(setsockopt(xsk, SOL_XDP, XDP_UMEM_REG, &mr, sizeof(mr)) < 0
+       || setsockopt(xsk, SOL_XDP, XDP_UMEM_FILL_RING, &size, sizeof(size)) < 0
+       || setsockopt(xsk, SOL_XDP, XDP_UMEM_COMPLETION_RING, &size, sizeof(size)) < 0
+       || setsockopt(xsk, SOL_XDP, XDP_RX_RING, &size, sizeof(size)) < 0
+       || getsockopt(xsk, SOL_XDP, XDP_MMAP_OFFSETS, &off, &len) < 0
+       || map_ring(&rx, &off.rx, sizeof(struct xdp_desc), XDP_PGOFF_RX_RING) < 0
+       || map_ring(&fill, &off.fr, sizeof(uint64_t), XDP_UMEM_PGOFF_FILL_RING) < 0) {
+        fprintf(stderr,"AF_XDP: cannot set up the rings: %s, using sockets\n", strerror(errno));
+        metis_xdp_exit();
+        return -1;
+    }
+
+    // every UMEM frame starts out on the fill ring; the fill and Rx rings
+    // hold them all, so returning a frame never finds the fill ring full
+    uint64_t* addrs=(uint64_t*)fill.desc;
+    for(int i=0; i<METISXDPFRAMES; i++)
+        addrs[i]=(uint64_t)i * METISXDPFRAMESIZE;
+    __atomic_store_n(fill.producer, METISXDPFRAMES, __ATOMIC_RELEASE);
+
+    memset(&sxdp,0,sizeof(sxdp));
+    sxdp.sxdp_family=AF_XDP;
+    sxdp.sxdp_ifindex=ifindex;
+    sxdp.sxdp_queue_id=METISXDPQUEUE;
+    sxdp.sxdp_flags=XDP_ZEROCOPY;
+    const char* mode="zero-copy";
+    if(bind(xsk, (struct sockaddr*)&sxdp, sizeof(sxdp)) < 0) {
+        sxdp.sxdp_flags=XDP_COPY;	// driver without zero-copy support
+        mode="copy";
+        if(bind(xsk, (struct sockaddr*)&sxdp, sizeof(sxdp)) < 0) {
+            fprintf(stderr,"AF_XDP: cannot bind to %s queue %d: %s, using sockets\n",
+                    interface, METISXDPQUEUE, strerror(errno));
+            metis_xdp_exit();
+            return -1;
+        }
+    }
+
+    union bpf_attr attr;
+    memset(&attr,0,sizeof(attr));
+    attr.map_type=BPF_MAP_TYPE_XSKMAP;
+    attr.key_size=sizeof(uint32_t);
+    attr.value_size=sizeof(uint32_t);
+    attr.max_entries=METISXDPMAXQUEUES;
+    map_fd=sys_bpf(BPF_MAP_CREATE, &attr);
+    if(map_fd < 0) {
+        fprintf(stderr,"AF_XDP: cannot create XSKMAP: %s, using sockets\n", strerror(errno));
+        metis_xdp_exit();
+        return -1;
+    }
+
+    uint32_t key=METISXDPQUEUE, value=xsk;
+    memset(&attr,0,sizeof(attr));
+    attr.map_fd=map_fd;
+    attr.key=(uint64_t)(unsigned long)&key;
+    attr.value=(uint64_t)(unsigned long)&value;
+    if(sys_bpf(BPF_MAP_UPDATE_ELEM, &attr) < 0) {
+        fprintf(stderr,"AF_XDP: cannot add the socket to XSKMAP: %s, using sockets\n", strerror(errno));
+        metis_xdp_exit();
+        return -1;
+    }
+
+    prog_fd=load_program(map_fd, address, port);
+    if(prog_fd < 0) {
+        metis_xdp_exit();
+        return -1;
+    }
+
+    memset(&attr,0,sizeof(attr));
+    attr.link_create.prog_fd=prog_fd;
+    attr.link_create.target_ifindex=ifindex;
+    attr.link_create.attach_type=BPF_XDP;
+    link_fd=sys_bpf(BPF_LINK_CREATE, &attr);
+    if(link_fd < 0) {
+        fprintf(stderr,"AF_XDP: cannot attach to %s: %s, using sockets\n", interface, strerror(errno));
+        metis_xdp_exit();
+        return -1;
+    }
+
+    fprintf(stderr,"AF_XDP on %s queue %d, %s mode\n", interface, METISXDPQUEUE, mode);
+    return 0;
+}
+
+int metis_xdp_fd() {
+    return xsk;
+}
+
+int metis_xdp_receive(metis_dispatch_t dispatch) {
+    struct xdp_desc* descs=(struct xdp_desc*)rx.desc;
+    uint64_t* addrs=(uint64_t*)fill.desc;
+    struct sockaddr_in addr;
+    struct timespec wire;
+
+    uint32_t cons=*rx.consumer;		// ours, the kernel only reads it
+    uint32_t prod=__atomic_load_n(rx.producer, __ATOMIC_ACQUIRE);
+    uint32_t fp=*fill.producer;
+    int count=prod - cons;
+
+    memset(&addr,0,sizeof(addr));
+    addr.sin_family=AF_INET;
+
+    for(; cons != prod; cons++, fp++) {
+        struct xdp_desc* d=&descs[cons & (METISXDPFRAMES - 1)];
+        unsigned char* frame=umem + d->addr;
+        uint64_t arrival=MonotonicNs();
+        clock_gettime(CLOCK_REALTIME, &wire);	// no kernel time stamp on this path
+        uint64_t wire_ns=(uint64_t)wire.tv_sec * 1000000000ull + wire.tv_nsec;
+
+        // the program only redirects IPv4 UDP with a 20 byte header
+        int bytes=((frame[38] << 8) | frame[39]) - 8;
+        if(bytes > (int)d->len - HEADERS)
+            bytes=(int)d->len - HEADERS;
+        memcpy(&addr.sin_addr.s_addr, frame + 26, 4);
+        memcpy(&addr.sin_port, frame + 34, 2);
+
+        if(bytes > 0)
+            dispatch(frame + HEADERS, bytes, &addr, arrival, wire_ns);
+
+        addrs[fp & (METISXDPFRAMES - 1)]=d->addr & ~(uint64_t)(METISXDPFRAMESIZE - 1);
+    }
+
+    __atomic_store_n(rx.consumer, cons, __ATOMIC_RELEASE);
+    __atomic_store_n(fill.producer, fp, __ATOMIC_RELEASE);
+    return count;
+}
+
+void metis_xdp_exit() {
+    if(link_fd >= 0) close(link_fd);	// detaches the program
+    if(prog_fd >= 0) close(prog_fd);
+    if(map_fd >= 0) close(map_fd);
+    if(rx.map != NULL) munmap(rx.map, rx.maplen);
+    if(fill.map != NULL) munmap(fill.map, fill.maplen);
+    if(xsk >= 0) close(xsk);
+    if(umem != NULL) munmap(umem, METISXDPFRAMES * METISXDPFRAMESIZE);
+    link_fd=prog_fd=map_fd=xsk=-1;
+    rx.map=fill.map=NULL;
+    umem=NULL;
+}
+
+#else	// no AF_XDP
+
+int metis_xdp_init(const char* interface, long address, int port) {
+    fprintf(stderr,"built without AF_XDP, using sockets\n");
+    return -1;
+}
+
+int metis_xdp_fd() {
+    return -1;
+}
+
+int metis_xdp_receive(metis_dispatch_t dispatch) {
+    return 0;
+}
+
+void metis_xdp_exit() {
+}
+
+#endif	// HAVE_AF_XDP
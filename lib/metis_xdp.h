@@ -0,0 +1,43 @@
+/* -*-  C++  -*-  */
+/* metis_xdp.h */
+
+// Copyright 2026 Tom McDermott, N5EG
+// under GNU General Public License, as metis.cc.
+//
+// AF_XDP backend for the metis socket (METIS_BACKEND_AF_XDP), for a NIC
+// port dedicated to the radio.
+//
+// A small XDP program on the interface redirects IPv4 UDP frames from
+// port 1024 to our address and port into an AF_XDP socket bound to
+// METISXDPQUEUE; everything else, and radio frames that arrive on another
+// queue, passes to the kernel stack and the ordinary metis socket as
+// before. metis_xdp_receive() hands each frame's UDP payload to metis.cc
+// where it lies in the UMEM, and returns the UMEM frame to the fill ring
+// once the proxy has unpacked it. Transmit stays on the metis socket.
+//
+// Zero-copy mode is used when the driver has it, copy mode otherwise
+// (veth, and most virtual NICs). Needs CAP_NET_ADMIN and CAP_BPF (or
+// root), and Linux 5.9 for the bpf link that attaches the program; the
+// program is detached when the link is closed, or the process exits.
+// Built only where linux/if_xdp.h is found (HAVE_AF_XDP); otherwise
+// metis_xdp_init() fails and metis.cc keeps the socket path.
+//
+// Version:  October 2026
+
+#ifndef METIS_XDP_H
+#define METIS_XDP_H
+
+#include "metis.h"
+
+#define METISXDPFRAMES		2048	// UMEM frames, also the fill and Rx ring size, power of 2
+#define METISXDPFRAMESIZE	2048	// bytes per UMEM frame
+#define METISXDPQUEUE		0	// NIC receive queue the AF_XDP socket binds to
+#define METISXDPMAXQUEUES	64	// XSKMAP entries
+
+int metis_xdp_init(const char* interface, long address, int port);	// 0 if attached,
+								// -1 to use the socket path
+int metis_xdp_fd();			// the AF_XDP socket, to poll()
+int metis_xdp_receive(metis_dispatch_t dispatch);	// frames waiting in the Rx ring, 0 if none
+void metis_xdp_exit();			// detach and free, once the receive thread has returned
+
+#endif  // METIS_XDP_H
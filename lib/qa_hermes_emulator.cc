@@ -0,0 +1,218 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013-2017 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Protocol level tests of HermesEmulator, talking to it over the loopback
+// the way metis.cc does.
+
+#include "qa_hermes_emulator.h"
+#include "HermesEmulator.h"
+
+#include <cppunit/TestAssert.h>
+#include <string.h>
+#include <math.h>
+#include <complex>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+
+namespace gr {
+  namespace hpsdr {
+
+    static int open_host(HermesEmulator& emu, struct sockaddr_in* to)
+    {
+      int s = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+      struct sockaddr_in name;
+      memset(&name, 0, sizeof(name));
+      name.sin_family = AF_INET;
+      name.sin_addr.s_addr = inet_addr("127.0.0.1");
+      bind(s, (struct sockaddr*)&name, sizeof(name));
+
+      struct timeval tv = { 1, 0 };		// never hang the test run
+      setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+      memset(to, 0, sizeof(*to));
+      to->sin_family = AF_INET;
+      to->sin_port = htons(emu.Port());
+      to->sin_addr.s_addr = inet_addr(EMULATOR_ADDRESS);
+      return s;
+    }
+
+    void
+    qa_hermes_emulator::t1_discovery()
+    {
+      HermesEmulator emu(EMULATOR_ADDRESS, 0, "00:1C:C0:A2:22:5E");
+      CPPUNIT_ASSERT(emu.Start());
+
+      struct sockaddr_in to;
+      int s = open_host(emu, &to);
+
+      unsigned char buf[1032];
+      memset(buf, 0, 63);
+      buf[0] = 0xEF; buf[1] = 0xFE; buf[2] = 0x02;
+      sendto(s, buf, 63, 0, (struct sockaddr*)&to, sizeof(to));
+
+      int n = recv(s, buf, sizeof(buf), 0);
+      CPPUNIT_ASSERT_EQUAL(60, n);
+      CPPUNIT_ASSERT(buf[0] == 0xEF && buf[1] == 0xFE && buf[2] == 0x02);
+      CPPUNIT_ASSERT(buf[3] == 0x00 && buf[4] == 0x1C && buf[8] == 0x5E);
+
+      close(s);
+      emu.Stop();
+      CPPUNIT_ASSERT_EQUAL(1UL, emu.Stats.DiscoveryCount);
+    }
+
+    void
+    qa_hermes_emulator::t2_nco_tone()
+    {
+      // Program Rx1 1 kHz below the carrier at 96 ksps, start NB, and
+      // check the EP6 stream: sequence, sync, and a 1 kHz tone on Rx1.
+
+      HermesEmulator emu(EMULATOR_ADDRESS, 0);
+      emu.AddCarrier(7.074e6, -6.0);
+      CPPUNIT_ASSERT(emu.Start());
+
+      struct sockaddr_in to;
+      int s = open_host(emu, &to);
+
+      unsigned char buf[1032];
+      memset(buf, 0, sizeof(buf));
+      buf[0] = 0xEF; buf[1] = 0xFE; buf[2] = 0x01; buf[3] = 0x02;
+      unsigned char* usb = &buf[8];
+      usb[0] = usb[1] = usb[2] = 0x7f;
+      usb[3] = 0x00; usb[4] = 0x01;			// bank 0: 96 ksps, 1 receiver
+      usb = &buf[520];
+      usb[0] = usb[1] = usb[2] = 0x7f;
+      unsigned nco = 7073000;
+      usb[3] = 0x04;					// bank 4: Rx1 NCO
+      usb[4] = nco >> 24; usb[5] = nco >> 16; usb[6] = nco >> 8; usb[7] = nco;
+      sendto(s, buf, 1032, 0, (struct sockaddr*)&to, sizeof(to));
+
+      unsigned char start[64];
+      memset(start, 0, sizeof(start));
+      start[0] = 0xEF; start[1] = 0xFE; start[2] = 0x04; start[3] = 0x01;
+      sendto(s, start, 64, 0, (struct sockaddr*)&to, sizeof(to));
+
+      std::complex<double> prev, acc(0.0, 0.0);
+      bool first = true;
+      for (unsigned frame=0; frame<20; frame++)
+      {
+        CPPUNIT_ASSERT_EQUAL(1032, (int)recv(s, buf, sizeof(buf), 0));
+        CPPUNIT_ASSERT(buf[3] == 0x06);
+        unsigned seq = ((unsigned)buf[4] << 24) | (buf[5] << 16) | (buf[6] << 8) | buf[7];
+        CPPUNIT_ASSERT_EQUAL(frame, seq);
+
+        for (int off=8; off<=520; off+=512)
+        {
+          CPPUNIT_ASSERT(buf[off] == 0x7f && buf[off+1] == 0x7f && buf[off+2] == 0x7f);
+          for (int row=0; row<63; row++)
+          {
+            unsigned char* p = &buf[off + 8 + row*8];
+            int I = (int)(((unsigned)p[0] << 24) | (p[1] << 16) | (p[2] << 8)) >> 8;
+            int Q = (int)(((unsigned)p[3] << 24) | (p[4] << 16) | (p[5] << 8)) >> 8;
+            std::complex<double> x(I, Q);
+            if (!first)
+              acc += x * std::conj(prev);
+            prev = x;
+            first = false;
+          }
+        }
+      }
+
+      double tone = std::arg(acc) * 96000.0 / (2.0 * M_PI);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(1000.0, tone, 1.0);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(pow(10.0, -6.0/20.0) * 8388607.0, std::abs(prev), 100.0);
+
+      start[3] = 0x00;					// stop
+      sendto(s, start, 64, 0, (struct sockaddr*)&to, sizeof(to));
+      close(s);
+      emu.Stop();
+
+      CPPUNIT_ASSERT_EQUAL(96000, emu.SampleRate());
+      CPPUNIT_ASSERT_EQUAL(nco, emu.Frequency(0));
+      CPPUNIT_ASSERT_EQUAL(0UL, emu.Stats.EP2BadSync);
+    }
+
+    // First n EP6 sequence numbers received with the given faults
+    static std::vector<unsigned> faulty_run(const EmulatorFaults& faults, int n)
+    {
+      HermesEmulator emu(EMULATOR_ADDRESS, 0);
+      emu.Faults = faults;
+      CPPUNIT_ASSERT(emu.Start());
+
+      struct sockaddr_in to;
+      int s = open_host(emu, &to);
+
+      unsigned char buf[1032];
+      memset(buf, 0, 64);
+      buf[0] = 0xEF; buf[1] = 0xFE; buf[2] = 0x04; buf[3] = 0x01;
+      sendto(s, buf, 64, 0, (struct sockaddr*)&to, sizeof(to));
+
+      std::vector<unsigned> seqs;
+      for (int i=0; i<n; i++)
+      {
+        CPPUNIT_ASSERT_EQUAL(1032, (int)recv(s, buf, sizeof(buf), 0));
+        seqs.push_back(((unsigned)buf[4] << 24) | (buf[5] << 16) | (buf[6] << 8) | buf[7]);
+      }
+
+      buf[3] = 0x00;
+      sendto(s, buf, 64, 0, (struct sockaddr*)&to, sizeof(to));
+      close(s);
+      emu.Stop();
+      return seqs;
+    }
+
+    void
+    qa_hermes_emulator::t3_fault_repeatable()
+    {
+      // Same seed, same faults on the same frames. Each fault shows up.
+
+      EmulatorFaults faults;
+      memset(&faults, 0, sizeof(faults));
+      faults.LossRate = 0.1;
+      faults.BurstRate = 0.02;
+      faults.BurstLength = 4;
+      faults.ReorderRate = 0.05;
+      faults.ReorderDepth = 2;
+      faults.DuplicateRate = 0.05;
+      faults.Seed = 12345;
+
+      std::vector<unsigned> a = faulty_run(faults, 300);
+      std::vector<unsigned> b = faulty_run(faults, 300);
+      CPPUNIT_ASSERT(a == b);
+
+      int gaps = 0, dups = 0, backwards = 0;
+      for (size_t i=1; i<a.size(); i++)
+      {
+        if (a[i] > a[i-1] + 1) gaps++;
+        if (a[i] == a[i-1]) dups++;
+        if (a[i] < a[i-1]) backwards++;
+      }
+      CPPUNIT_ASSERT(gaps > 0);
+      CPPUNIT_ASSERT(dups > 0);
+      CPPUNIT_ASSERT(backwards > 0);
+
+      faults.Seed = 54321;
+      CPPUNIT_ASSERT(faulty_run(faults, 300) != a);
+    }
+
+  } /* namespace hpsdr */
+} /* namespace gr */
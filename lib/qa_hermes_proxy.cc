@@ -0,0 +1,197 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Narrowband receiver level tests: EP6 frames carrying a tone on a known
+// DC offset are handed straight to HermesProxy::ReceiveRxIQ, the way the
+// metis Rx thread would, and the published levels and the ring samples
+// are checked against the frames' own numbers.
+
+#include "qa_hermes_proxy.h"
+#include "HermesProxy.h"
+
+#include <cppunit/TestAssert.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <algorithm>
+
+namespace gr {
+  namespace hpsdr {
+
+    #define QA_RATE		48000		// receiver sample rate
+    #define QA_TONEPERIOD	9		// samples, divides the 63 rows of a USB frame
+    #define QA_TONE		0.875		// tone amplitude, of full scale
+    #define QA_DCI		0.0625		// I, Q offset, of full scale
+    #define QA_DCQ		-0.03125
+    #define QA_WINDOW	(16 * 63)	// samples per level window, whole USB frames
+
+    static const double FS = 8388607.0;
+
+    // Sample n of the test signal, as the radio's 24 bit integers
+
+    static void sample(unsigned n, int32_t* I, int32_t* Q)
+    {
+      double ph = 2.0 * M_PI * (n % QA_TONEPERIOD) / QA_TONEPERIOD;
+      *I = (int32_t)lrint((QA_TONE * cos(ph) + QA_DCI) * FS);
+      *Q = (int32_t)lrint((QA_TONE * sin(ph) + QA_DCQ) * FS);
+    }
+
+    static void put24(unsigned char* p, int32_t v)
+    {
+      p[0] = (v >> 16) & 0xff;
+      p[1] = (v >> 8) & 0xff;
+      p[2] = v & 0xff;
+    }
+
+    // Build EP6 frame Seq (one receiver, 2 x 63 samples from sample
+    // 126 * Seq on) and hand it to the proxy.
+
+    static void send_frame(HermesProxy* H, unsigned Seq)
+    {
+      unsigned char buf[1032];
+      memset(buf, 0, sizeof(buf));
+      buf[0] = 0xEF; buf[1] = 0xFE; buf[2] = 0x01; buf[3] = 0x06;
+      buf[4] = Seq >> 24; buf[5] = Seq >> 16; buf[6] = Seq >> 8; buf[7] = Seq;
+
+      unsigned n = Seq * 126;
+      for (int usb=8; usb<=520; usb+=512)
+      {
+        buf[usb] = buf[usb+1] = buf[usb+2] = 0x7f;
+        for (int row=0; row<63; row++, n++)
+        {
+          int32_t I, Q;
+          sample(n, &I, &Q);
+          put24(&buf[usb + 8 + row*8], I);
+          put24(&buf[usb + 8 + row*8 + 3], Q);
+        }
+      }
+      H->ReceiveRxIQ(buf, 0);
+    }
+
+    static HermesProxy* make_proxy(bool DCRemove)
+    {
+      HermesProxy* H = new HermesProxy(7073000, 0, 0, 0, 0, 0, 0, 0, 7074000, 0, 0, 0, 0, 0,
+				       QA_RATE, "qa", "0xF8", 0, 0, 0x20, 0x10, 0, 1, "*");
+      H->OutputType = NBOutputFC32;
+      H->LevelPeriod = (QA_WINDOW - 32) / (double)QA_RATE;	// ends at the 16th USB frame
+      H->DCRemove = DCRemove;
+      return H;
+    }
+
+    // Mean I, Q of the ring slots waiting, in full scale units, and
+    // release them.
+
+    static void drain(HermesProxy* H, double* MeanI, double* MeanQ)
+    {
+      double si = 0.0, sq = 0.0;
+      long n = 0;
+      IQBuf_t slot;
+      while ((slot = H->RxReadSlot()) != NULL)
+      {
+        for (int i=0; i<63; i++, n++)
+        {
+          si += slot[2*i];
+          sq += slot[2*i+1];
+        }
+        H->RxRelease();
+      }
+      *MeanI = (n > 0) ? si / n : 0.0;
+      *MeanQ = (n > 0) ? sq / n : 0.0;
+    }
+
+    void
+    qa_hermes_proxy::t1_level()
+    {
+      // One window: power, peak and DC against the same sums of the
+      // integers that went into the frames.
+
+      double sp = 0.0, si = 0.0, sq = 0.0, pk = 0.0;
+      for (unsigned n=0; n<QA_WINDOW; n++)
+      {
+        int32_t I, Q;
+        sample(n, &I, &Q);
+        double p = (double)I * I + (double)Q * Q;
+        sp += p;
+        si += I;
+        sq += Q;
+        pk = std::max(pk, p);
+      }
+
+      HermesProxy* H = make_proxy(false);
+      for (unsigned seq=0; seq<QA_WINDOW/126; seq++)
+        send_frame(H, seq);
+
+      CPPUNIT_ASSERT_EQUAL(1UL, H->LevelWindows());
+      gr::hpsdr::hermes_level l;
+      H->GetLevel(0, l);
+      CPPUNIT_ASSERT_EQUAL(1UL, (unsigned long)l.windows);
+      CPPUNIT_ASSERT_EQUAL((unsigned long)QA_WINDOW, (unsigned long)l.samples);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0 * log10(sp / QA_WINDOW / (FS * FS)), l.power_dbfs, 0.001);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0 * log10(pk / (FS * FS)), l.peak_dbfs, 0.001);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(si / QA_WINDOW / FS, l.dc_i, 1e-6);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(sq / QA_WINDOW / FS, l.dc_q, 1e-6);
+
+      // and the numbers the signal was built from
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0 * log10(QA_TONE * QA_TONE + QA_DCI * QA_DCI + QA_DCQ * QA_DCQ),
+				   l.power_dbfs, 0.001);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(QA_DCI, l.dc_i, 1e-6);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(QA_DCQ, l.dc_q, 1e-6);
+
+      // without DCRemove the samples keep their offset
+      double mi, mq;
+      drain(H, &mi, &mq);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(QA_DCI, mi, 1e-6);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(QA_DCQ, mq, 1e-6);
+      delete H;
+    }
+
+    void
+    qa_hermes_proxy::t2_dc_remove()
+    {
+      // The first window measures the offset; from the second on it is
+      // subtracted from the samples, and the window still reports the
+      // input's DC while its power is the tone's alone.
+
+      HermesProxy* H = make_proxy(true);
+      double mi, mq;
+
+      for (unsigned seq=0; seq<QA_WINDOW/126; seq++)
+        send_frame(H, seq);
+      drain(H, &mi, &mq);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(QA_DCI, mi, 1e-6);	// not removed yet
+
+      for (unsigned seq=QA_WINDOW/126; seq<2*QA_WINDOW/126; seq++)
+        send_frame(H, seq);
+      drain(H, &mi, &mq);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, mi, 1e-6);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, mq, 1e-6);
+
+      CPPUNIT_ASSERT_EQUAL(2UL, H->LevelWindows());
+      gr::hpsdr::hermes_level l;
+      H->GetLevel(0, l);
+      CPPUNIT_ASSERT_EQUAL(2UL, (unsigned long)l.windows);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(QA_DCI, l.dc_i, 1e-6);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(QA_DCQ, l.dc_q, 1e-6);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(20.0 * log10(QA_TONE), l.power_dbfs, 0.001);
+      delete H;
+    }
+
+  } /* namespace hpsdr */
+} /* namespace gr */
@@ -0,0 +1,203 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// Wideband reassembly tests: EP4 frames are handed straight to
+// HermesProxyW::ReceiveRxIQ, the way the metis Rx thread would, and the
+// vectors are read back out of the Rx ring.
+
+#include "qa_hermes_proxyw.h"
+#include "HermesProxyW.h"
+
+#include <cppunit/TestAssert.h>
+#include <string.h>
+#include <stdint.h>
+#include <vector>
+
+namespace gr {
+  namespace hpsdr {
+
+    // Build EP4 frame Seq and hand it to the proxy. Every sample in the
+    // frame holds Seq+1, so a zero-filled frame stands out.
+
+    static void send_frame(HermesProxyW* W, unsigned Seq)
+    {
+      unsigned char buf[1032];
+      buf[0] = 0xEF; buf[1] = 0xFE; buf[2] = 0x01; buf[3] = 0x04;
+      buf[4] = Seq >> 24; buf[5] = Seq >> 16; buf[6] = Seq >> 8; buf[7] = Seq;
+      int16_t v = (int16_t)((Seq + 1) & 0x7fff);
+      for (int i=8; i<1032; i+=2)
+      {
+        buf[i] = v & 0xff;
+        buf[i+1] = (v >> 8) & 0xff;
+      }
+      W->ReceiveRxIQ(buf, 0);
+    }
+
+    // Read the next vector from the ring and check frame k came from
+    // Seqs[k], or is zero when Seqs[k] < 0.
+
+    static bool check_vector(HermesProxyW* W, const std::vector<int>& Seqs)
+    {
+      IQBuf_t slot = W->RxReadSlot();
+      if (slot == NULL)
+        return false;
+
+      bool ok = true;
+      const int16_t* s = (const int16_t*)slot;
+      for (int k=0; k<WBFRAMES; k++)
+      {
+        int16_t want = (Seqs[k] < 0) ? 0 : (int16_t)((Seqs[k] + 1) & 0x7fff);
+        for (int j=0; j<512; j++)
+          if (s[k*512 + j] != want)
+            ok = false;
+      }
+      W->RxRelease();
+      return ok;
+    }
+
+    static std::vector<int> vector_seqs(unsigned Vector)
+    {
+      std::vector<int> seqs(WBFRAMES);
+      for (int k=0; k<WBFRAMES; k++)
+        seqs[k] = Vector * WBFRAMES + k;
+      return seqs;
+    }
+
+    static HermesProxyW* make_proxy(int GapPolicy)
+    {
+      HermesProxyW* W = new HermesProxyW(0, "qa", "0xF8", 0, 0, 0x20, 0x10, "*", GapPolicy);
+      W->OutputType = WBOutputShort;
+      return W;
+    }
+
+    void
+    qa_hermes_proxyw::t1_in_order()
+    {
+      HermesProxyW* W = make_proxy(WBGapZeroFill);
+
+      for (unsigned seq=0; seq<2*WBFRAMES; seq++)
+        send_frame(W, seq);
+
+      CPPUNIT_ASSERT_EQUAL(2, W->RxBufFillCount());
+      CPPUNIT_ASSERT(check_vector(W, vector_seqs(0)));
+      CPPUNIT_ASSERT(check_vector(W, vector_seqs(1)));
+
+      gr::hpsdr::hermes_stats st;
+      W->GetStats(st);
+      CPPUNIT_ASSERT_EQUAL(2UL, (unsigned long)st.wb_vectors_complete);
+      CPPUNIT_ASSERT_EQUAL(0UL, (unsigned long)st.wb_late_frames);
+      delete W;
+    }
+
+    void
+    qa_hermes_proxyw::t2_loss()
+    {
+      // Frame 5 of vector 0 never arrives. Zero-fill emits it with the
+      // hole zeroed, drop throws it away. Vector 1 is whole either way.
+
+      HermesProxyW* W = make_proxy(WBGapZeroFill);
+      for (unsigned seq=0; seq<2*WBFRAMES; seq++)
+        if (seq != 5)
+          send_frame(W, seq);
+
+      CPPUNIT_ASSERT_EQUAL(2, W->RxBufFillCount());
+      CPPUNIT_ASSERT_EQUAL(1U, W->RxReadMissing());
+      std::vector<int> seqs = vector_seqs(0);
+      seqs[5] = -1;
+      CPPUNIT_ASSERT(check_vector(W, seqs));
+      CPPUNIT_ASSERT_EQUAL(0U, W->RxReadMissing());
+      CPPUNIT_ASSERT(check_vector(W, vector_seqs(1)));
+
+      gr::hpsdr::hermes_stats st;
+      W->GetStats(st);
+      CPPUNIT_ASSERT_EQUAL(1UL, (unsigned long)st.wb_vectors_filled);
+      CPPUNIT_ASSERT_EQUAL(1UL, (unsigned long)st.wb_vectors_complete);
+      delete W;
+
+      W = make_proxy(WBGapDrop);
+      for (unsigned seq=0; seq<2*WBFRAMES; seq++)
+        if (seq != 5)
+          send_frame(W, seq);
+
+      CPPUNIT_ASSERT_EQUAL(1, W->RxBufFillCount());
+      CPPUNIT_ASSERT(check_vector(W, vector_seqs(1)));
+
+      W->GetStats(st);
+      CPPUNIT_ASSERT_EQUAL(1UL, (unsigned long)st.wb_vectors_dropped);
+      CPPUNIT_ASSERT_EQUAL(1UL, (unsigned long)st.wb_vectors_complete);
+      delete W;
+    }
+
+    void
+    qa_hermes_proxyw::t3_reorder_duplicate()
+    {
+      // Vector 0 arrives back to front with frame 7 sent twice, then a
+      // straggler from it turns up after vector 1 has started.
+
+      HermesProxyW* W = make_proxy(WBGapZeroFill);
+      for (int seq=WBFRAMES-1; seq>=0; seq--)
+      {
+        send_frame(W, seq);
+        if (seq == 7)
+          send_frame(W, seq);
+      }
+      send_frame(W, WBFRAMES);
+      send_frame(W, 3);				// late, vector 0 is finished
+      for (unsigned seq=WBFRAMES+1; seq<2*WBFRAMES; seq++)
+        send_frame(W, seq);
+
+      CPPUNIT_ASSERT_EQUAL(2, W->RxBufFillCount());
+      CPPUNIT_ASSERT(check_vector(W, vector_seqs(0)));
+      CPPUNIT_ASSERT(check_vector(W, vector_seqs(1)));
+
+      gr::hpsdr::hermes_stats st;
+      W->GetStats(st);
+      CPPUNIT_ASSERT_EQUAL(2UL, (unsigned long)st.wb_vectors_complete);
+      CPPUNIT_ASSERT_EQUAL(1UL, (unsigned long)st.wb_late_frames);
+      delete W;
+    }
+
+    void
+    qa_hermes_proxyw::t4_sequence_reset()
+    {
+      // Four vectors, then the radio restarts its sequence numbers at 0
+      // (stream stopped and started). The four after the restart must be
+      // reassembled too, not counted as late.
+
+      HermesProxyW* W = make_proxy(WBGapZeroFill);
+      for (int pass=0; pass<2; pass++)
+      {
+        for (unsigned seq=0; seq<4*WBFRAMES; seq++)
+          send_frame(W, seq);
+
+        CPPUNIT_ASSERT_EQUAL(4, W->RxBufFillCount());
+        for (unsigned v=0; v<4; v++)
+          CPPUNIT_ASSERT(check_vector(W, vector_seqs(v)));
+      }
+
+      gr::hpsdr::hermes_stats st;
+      W->GetStats(st);
+      CPPUNIT_ASSERT_EQUAL(8UL, (unsigned long)st.wb_vectors_complete);
+      CPPUNIT_ASSERT_EQUAL(0UL, (unsigned long)st.wb_late_frames);
+      delete W;
+    }
+
+  } /* namespace hpsdr */
+} /* namespace gr */
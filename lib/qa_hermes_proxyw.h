@@ -0,0 +1,50 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _QA_HERMES_PROXYW_H_
+#define _QA_HERMES_PROXYW_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestCase.h>
+
+namespace gr {
+  namespace hpsdr {
+
+    class qa_hermes_proxyw : public CppUnit::TestCase
+    {
+    public:
+      CPPUNIT_TEST_SUITE(qa_hermes_proxyw);
+      CPPUNIT_TEST(t1_in_order);
+      CPPUNIT_TEST(t2_loss);
+      CPPUNIT_TEST(t3_reorder_duplicate);
+      CPPUNIT_TEST(t4_sequence_reset);
+      CPPUNIT_TEST_SUITE_END();
+
+    private:
+      void t1_in_order();
+      void t2_loss();
+      void t3_reorder_duplicate();
+      void t4_sequence_reset();
+    };
+
+  } /* namespace hpsdr */
+} /* namespace gr */
+
+#endif /* _QA_HERMES_PROXYW_H_ */
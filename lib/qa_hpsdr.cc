@@ -26,11 +26,19 @@
  */
 
 #include "qa_hpsdr.h"
+#include "qa_hermes_emulator.h"
+#include "qa_hermes_proxy.h"
+#include "qa_hermes_proxyw.h"
+#include "qa_nb_decimator.h"
 
 CppUnit::TestSuite *
 qa_hpsdr::suite()
 {
   CppUnit::TestSuite *s = new CppUnit::TestSuite("hpsdr");
+  s->addTest(gr::hpsdr::qa_hermes_emulator::suite());
+  s->addTest(gr::hpsdr::qa_hermes_proxy::suite());
+  s->addTest(gr::hpsdr::qa_hermes_proxyw::suite());
+  s->addTest(gr::hpsdr::qa_nb_decimator::suite());
 
   return s;
 }
@@ -0,0 +1,137 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2026 Tom McDermott, N5EG
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// NBDecimator tests: the history kept across calls, the response the
+// header promises, and the per receiver factor list.
+
+#include "qa_nb_decimator.h"
+#include "NBDecimator.h"
+
+#include <cppunit/TestAssert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <complex>
+#include <vector>
+
+namespace gr {
+  namespace hpsdr {
+
+    // Gain in dB of a unit complex tone at Freq (fraction of the output
+    // rate) through a Factor decimator, once the filter has filled.
+
+    static double tone_gain_db(int Factor, double Freq)
+    {
+      NBDecimator dec(Factor);
+      int n = Factor * 400;
+      std::vector<gr_complex> in(n), out(n / Factor + 1);
+      for (int i=0; i<n; i++)
+        in[i] = std::polar(1.0f, (float)(2.0 * M_PI * Freq / Factor * i));
+
+      int m = dec.Decimate(&in[0], n, &out[0]);
+      double p = 0.0;
+      for (int i=DECTAPSPERPHASE; i<m; i++)
+        p += std::norm(out[i]);
+      return 10.0 * log10(p / (m - DECTAPSPERPHASE));
+    }
+
+    void
+    qa_nb_decimator::t1_chunking()
+    {
+      // The same input in one call, or in chunks of 1, 63, 80 and 300
+      // (across DECBLOCK and the Factor phase), gives the same outputs.
+
+      const int chunks[] = { 1, 63, 80, 300 };
+      const int factors[] = { 2, 5, 8 };
+
+      int n = 3000;
+      std::vector<gr_complex> in(n);
+      srand(1);
+      for (int i=0; i<n; i++)
+        in[i] = gr_complex(rand() / (float)RAND_MAX - 0.5f, rand() / (float)RAND_MAX - 0.5f);
+
+      for (int f=0; f<3; f++)
+      {
+        int Factor = factors[f];
+        NBDecimator whole(Factor);
+        std::vector<gr_complex> ref(n / Factor + 1);
+        int nref = whole.Decimate(&in[0], n, &ref[0]);
+        CPPUNIT_ASSERT_EQUAL(n / Factor, nref);
+
+        for (int c=0; c<4; c++)
+        {
+          NBDecimator split(Factor);
+          std::vector<gr_complex> out(n / Factor + 1);
+          int produced = 0;
+          for (int i=0; i<n; i+=chunks[c])
+          {
+            int len = (n - i < chunks[c]) ? n - i : chunks[c];
+            produced += split.Decimate(&in[i], len, &out[produced]);
+          }
+
+          CPPUNIT_ASSERT_EQUAL(nref, produced);
+          for (int i=0; i<nref; i++)
+          {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(ref[i].real(), out[i].real(), 1e-6);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(ref[i].imag(), out[i].imag(), 1e-6);
+          }
+        }
+      }
+    }
+
+    void
+    qa_nb_decimator::t2_response()
+    {
+      // Unity gain at DC, flat to 0.28 of the output rate, -6 dB at
+      // DECCUTOFF and at least 72 dB down at 0.6, for small and large factors.
+
+      const int factors[] = { 2, 8, 64 };
+      for (int f=0; f<3; f++)
+      {
+        int Factor = factors[f];
+        NBDecimator dec(Factor);
+        int n = Factor * 100;
+        std::vector<gr_complex> in(n, gr_complex(0.5f, -0.25f)), out(n / Factor + 1);
+        int m = dec.Decimate(&in[0], n, &out[0]);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, out[m-1].real(), 1e-4);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(-0.25, out[m-1].imag(), 1e-4);
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, tone_gain_db(Factor, 0.28), 0.1);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(-6.0, tone_gain_db(Factor, DECCUTOFF), 0.5);
+        CPPUNIT_ASSERT(tone_gain_db(Factor, 0.6) <= -72.0);
+      }
+    }
+
+    void
+    qa_nb_decimator::t3_parse_factor()
+    {
+      CPPUNIT_ASSERT_EQUAL(8, NBDecimator::ParseFactor("8,,4", 0));
+      CPPUNIT_ASSERT_EQUAL(1, NBDecimator::ParseFactor("8,,4", 1));	// empty entry
+      CPPUNIT_ASSERT_EQUAL(4, NBDecimator::ParseFactor("8,,4", 2));
+      CPPUNIT_ASSERT_EQUAL(1, NBDecimator::ParseFactor("8,,4", 3));	// past the end
+      CPPUNIT_ASSERT_EQUAL(1, NBDecimator::ParseFactor(NULL, 0));
+
+      CPPUNIT_ASSERT_EQUAL(DECMAXFACTOR, NBDecimator::ParseFactor("64", 0));
+      CPPUNIT_ASSERT_EQUAL(1, NBDecimator::ParseFactor("65", 0));	// out of range
+      CPPUNIT_ASSERT_EQUAL(1, NBDecimator::ParseFactor("0", 0));
+      CPPUNIT_ASSERT_EQUAL(1, NBDecimator::ParseFactor("2,-3", 1));
+    }
+
+  } /* namespace hpsdr */
+} /* namespace gr */
@@ -8,11 +8,14 @@
 %include "hpsdr_swig_doc.i"
 
 %{
+#include "hpsdr/hermes_stats.h"
 #include "hpsdr/hermesNB.h"
 #include "hpsdr/hermesWB.h"
 %}
 
 
+%include "hpsdr/hermes_stats.h"
+
 %include "hpsdr/hermesNB.h"
 GR_SWIG_BLOCK_MAGIC2(hpsdr, hermesNB);
 